@@ -10,6 +10,7 @@ import multiprocessing
 import queue
 import threading
 import itertools
+import tempfile
 
 from reporting import log, log_progress, cyan, red, green, yellow
 from command import call_interruptable
@@ -44,6 +45,27 @@ TIMEOUT = -15
 categories = []
 configs = [''] # configurations to run the tool in
 
+# Configurations starting with one of these keys solve the formula after converting it to another input format.
+# Compressed AIGER files are not supported, as the AIGER reader rewinds the file; they are solved unconverted.
+INPUT_CONVERSIONS = {
+    'BINARY_INPUT': ('.qcnfb', '{tool} -l 1 --write_binary {target} {source}', True),
+    'GZIP_INPUT': ('.gz', 'gzip -c {source} > {target}', False),
+    'XZ_INPUT': ('.xz', 'xz -c {source} > {target}', False),
+    'BZIP2_INPUT': ('.bz2', 'bzip2 -c {source} > {target}', False),
+}
+AIGER_SUFFIXES = ('.aag', '.aig', '.qaig')
+
+# Configurations starting with one of these keys solve the formula through the qipasir API with qipasir_driver
+# (see src/tests/qipasir_driver.c), under random assumptions; QIPASIR_INCREMENTAL also adds random clauses before
+# the solve calls. Each result is compared to solving the formula with the added clauses and the assumptions as
+# unit clauses, and the failed assumptions must suffice for UNSAT. Only 2QBFs are supported.
+QIPASIR_MODES = {'QIPASIR_ASSUMPTIONS': False, 'QIPASIR_INCREMENTAL': True}
+QIPASIR_SOLVE_CALLS = 8
+
+# Configurations starting with this key set a resource limit that is reached at its first check. They must return
+# UNKNOWN and print the statistics, unless the formula is decided before the first check or is not supported.
+RESOURCE_LIMIT = 'RESULT_UNKNOWN'
+
 TIME_UTIL = '/usr/bin/time -v '
 if sys.platform == 'darwin':
     # must be the GNU version of time (brew install gnu-time)
@@ -299,9 +321,134 @@ def profile_entry(testcase, output, seconds, memory, return_value):
         print('  {} : {}'.format(attribute, value))
 
 
+def convert_input(conversion, file_path):
+    suffix, command, supports_aiger = INPUT_CONVERSIONS[conversion]
+    if file_path.endswith(AIGER_SUFFIXES) and not supports_aiger:
+        return None
+    handle, converted_file = tempfile.mkstemp(suffix=os.path.basename(file_path) + suffix)
+    os.close(handle)
+    call_interruptable(command.format(tool=ARGS.tool, source=file_path, target=converted_file), ARGS.timeout)
+    return converted_file
+
+
+# Returns the universal and existential variables and the clauses, or None if the file is not a 2QBF in QDIMACS
+def read_2QBF(file_path):
+    if file_path.endswith(AIGER_SUFFIXES):
+        return None
+    universals = []
+    existentials = []
+    clauses = []
+    lits = []
+    with open(file_path) as file:
+        for line in file:
+            tokens = line.split()
+            if not tokens or tokens[0] in ['c', 'p']:
+                continue
+            if tokens[0] in ['a', 'e']:
+                if tokens[0] == 'a' and existentials or tokens[0] == 'e' and not universals:
+                    return None
+                block = universals if tokens[0] == 'a' else existentials
+                block += [int(v) for v in tokens[1:-1]]
+                continue
+            for lit in tokens:
+                lits.append(int(lit))
+                if lits[-1] == 0:
+                    clauses.append(lits)
+                    lits = []
+    if not universals or not existentials:
+        return None
+    return universals, existentials, clauses
+
+
+def random_lits(rand, variables, num):
+    return [v * rand.choice([1, -1]) for v in rand.sample(variables, min(num, len(variables)))]
+
+
+# Universal variables that are assumed become existential, so that their unit clause restricts them
+def solve_with_unit_clauses(qbf, added_clauses, assumptions):
+    universals, existentials, clauses = qbf
+    assumed = [abs(l) for l in assumptions]
+    clauses = clauses + [c + [0] for c in added_clauses] + [[l, 0] for l in assumptions]
+    handle, file_name = tempfile.mkstemp(suffix='.qdimacs')
+    with os.fdopen(handle, 'w') as file:
+        file.write('p cnf {} {}\n'.format(max(universals + existentials), len(clauses)))
+        remaining_universals = [v for v in universals if v not in assumed]
+        if remaining_universals:
+            file.write('a {} 0\n'.format(' '.join(map(str, remaining_universals))))
+        file.write('e {} 0\n'.format(' '.join(map(str, existentials + [v for v in universals if v in assumed]))))
+        for clause in clauses:
+            file.write(' '.join(map(str, clause)) + '\n')
+    return_value, _, _ = call_interruptable('{} {}'.format(ARGS.tool, file_name), ARGS.timeout)
+    os.remove(file_name)
+    return return_value
+
+
+def run_qipasir_testcase(testcase, expected, config, mode, parameters):
+    qbf = read_2QBF(os.path.join(BASE_PATH, testcase))
+    if qbf is None:
+        print_result(testcase, config, expected, TEST_UNKNOWN, UNKNOWN, None, None)
+        return testcase, config, expected, TEST_UNKNOWN, UNKNOWN, None, None
+    universals, existentials, _ = qbf
+    rand = random.Random(testcase + config)
+    commands = ''
+    queries = [] # (added clauses, assumptions)
+    added_clauses = []
+    for i in range(QIPASIR_SOLVE_CALLS):
+        if QIPASIR_MODES[mode] and i > 0 and rand.random() < 0.6:
+            for _ in range(rand.randint(1, 2)):
+                clause = random_lits(rand, universals + existentials, rand.randint(2, 3))
+                added_clauses.append(clause)
+                commands += '+ {} 0\n'.format(' '.join(map(str, clause)))
+        assumptions = random_lits(rand, universals + existentials, rand.randint(0, 4))
+        queries.append((list(added_clauses), assumptions))
+        commands += '{} 0\n'.format(' '.join(map(str, assumptions)))
+    handle, commands_file = tempfile.mkstemp(suffix='.commands')
+    with os.fdopen(handle, 'w') as file:
+        file.write(commands)
+    command_string = 'bash -c "exec {} {} {} < {}"'.format(
+                        ARGS.qipasir_driver, ' '.join(parameters), os.path.join(BASE_PATH, testcase), commands_file)
+    return_value, output, error = call_interruptable(command_string, ARGS.timeout)
+    os.remove(commands_file)
+    if ARGS.verbose:
+        print('COMMAND: ' + command_string + '\n' + commands)
+        print('OUTPUT: ' + output.decode())
+        sys.stdout.flush()
+    
+    results = [line.split()[1:] for line in output.decode().split('\n') if line.startswith('result')]
+    log = output + error
+    if return_value == TIMEOUT:
+        result = TEST_TIMEOUT
+    elif return_value != 0 or len(results) != len(queries):
+        result = TEST_FAILED
+    else:
+        result = TEST_SUCCESS
+        for (clauses, assumptions), solve_result in zip(queries, results):
+            return_value = int(solve_result[0])
+            if return_value == 0:
+                continue
+            reference = solve_with_unit_clauses(qbf, clauses, assumptions)
+            failed_assumptions = [int(l) for l in solve_result[2:]]
+            if reference in [SATISFIABLE, UNSATISFIABLE] and return_value != reference:
+                log += 'Result {} differs from {} for assumptions {}\n'.format(return_value, reference, assumptions).encode()
+                result = TEST_FAILED
+            elif return_value == UNSATISFIABLE and solve_with_unit_clauses(qbf, clauses, failed_assumptions) == SATISFIABLE:
+                log += 'Failed assumptions {} of {} are satisfiable\n'.format(failed_assumptions, assumptions).encode()
+                result = TEST_FAILED
+    
+    print_result(testcase, config, expected, result, return_value, None, None)
+    if result == TEST_FAILED:
+        log_fail(testcase, log + b'Commands:\n' + commands.encode())
+    return testcase, config, expected, result, return_value, None, None
+
+
 def run_testcase(testcase_input):
     testcase, expected, config = testcase_input
     parameters = config.split()
+    if parameters and parameters[0] in QIPASIR_MODES:
+        return run_qipasir_testcase(testcase, expected, config, parameters[0], parameters[1:])
+    expect_limit = bool(parameters) and parameters[0] == RESOURCE_LIMIT
+    if expect_limit:
+        parameters = parameters[1:]
     if ARGS.certify:
         # random_string = ''.join(random.choice(string.ascii_uppercase + string.digits) for _ in range(N))
         cert_file = testcase+'.cert1.aig';
@@ -309,6 +456,13 @@ def run_testcase(testcase_input):
     
     file_path = os.path.join(BASE_PATH, testcase)
     
+    converted_file = None
+    if parameters and parameters[0] in INPUT_CONVERSIONS:
+        converted_file = convert_input(parameters[0], file_path)
+        parameters = parameters[1:]
+        if converted_file and os.path.getsize(converted_file) > 0: # no binary formula is written for propositional problems
+            file_path = converted_file
+    
     if ARGS.preprocessor: 
         preprocessing_string = '{} |'.format(ARGS.preprocessor)
     else:
@@ -345,6 +499,8 @@ def run_testcase(testcase_input):
                             file_path)
     
     return_value, output, error = call_interruptable(command_string, ARGS.timeout)
+    if converted_file:
+        os.remove(converted_file)
     
     if ARGS.verbose:
         print('COMMAND: ' + command_string)
@@ -360,6 +516,10 @@ def run_testcase(testcase_input):
         
     if return_value == TIMEOUT:
         result = TEST_TIMEOUT
+    elif return_value == UNKNOWN and expect_limit and b'CADET statistics:' in output:
+        result = TEST_SUCCESS
+    elif return_value == UNKNOWN and expect_limit and b'not supported' not in output:
+        result = TEST_FAILED
     elif return_value == UNKNOWN:
         result = TEST_UNKNOWN
     elif return_value in [SATISFIABLE,UNSATISFIABLE] and (return_value == expected or expected == UNKNOWN):
@@ -526,6 +686,9 @@ if __name__ == "__main__":
     parser.add_argument('--tool', dest='tool', action='store', 
                         default=os.path.join(BASE_PATH, './cadet -v 1'), 
                         help='Define which tool is tested (default "./cadet -v 1").')
+    parser.add_argument('--qipasir_driver', dest='qipasir_driver', action='store',
+                        default=os.path.join(BASE_PATH, 'qipasir_driver'),
+                        help='Driver for the QIPASIR configurations (default "./qipasir_driver").')
     parser.add_argument('--config', metavar='C', type=str, nargs='*', 
                         help='provide a list of command line configurations to run \
                         the tool in; to avoid interpreting them as options for this \
@@ -577,7 +740,31 @@ if __name__ == "__main__":
                    '--rl --rl_mock --sat_by_qbf --debugging --minimize --rl_vsids_rewards',
                    '--rl --rl_mock --sat_by_qbf --random_decisions --rl_vsids_rewards',
                    '--rl --rl_mock --sat_by_qbf --random_decisions --rl_advanced_rewards --rl_vsids_rewards --rl_slim_state',
-                   '--debugging -l 10 --sat_by_qbf --random_decisions --fresh_seed'
+                   '--debugging -l 10 --sat_by_qbf --random_decisions --fresh_seed',
+                   '--portfolio 2',
+                   '--debugging --sat_by_qbf --portfolio 2 -c cert.aag',
+                   '--case_splits --probe_threads 2',
+                   '--debugging --sat_by_qbf --minimize_certificate 2 -c cert.aag',
+                   '--debugging --sat_by_qbf -c cert.aig',
+                   'BINARY_INPUT',
+                   'BINARY_INPUT --debugging --sat_by_qbf -c cert.aag',
+                   'GZIP_INPUT',
+                   'XZ_INPUT',
+                   'BZIP2_INPUT',
+                   '--time_limit 1',
+                   'RESULT_UNKNOWN --mem_limit 1',
+                   'RESULT_UNKNOWN --mem_limit 1 --case_splits',
+                   'RESULT_UNKNOWN --mem_limit 1 --portfolio 2',
+                   '--delete_clauses',
+                   '--reduction_interval 10 --reduction_increment 10',
+                   '--case_splits --reduction_interval 10 --reduction_increment 10',
+                   '--cegar --reduction_interval 10 --reduction_increment 10',
+                   'QIPASIR_ASSUMPTIONS',
+                   'QIPASIR_ASSUMPTIONS --case_splits',
+                   'QIPASIR_ASSUMPTIONS --cegar',
+                   'QIPASIR_INCREMENTAL',
+                   'QIPASIR_INCREMENTAL --case_splits',
+                   'QIPASIR_INCREMENTAL --cegar'
                    ]
     
     if ARGS.config:
@@ -8,8 +8,11 @@
 
 #include "aiger_utils.h"
 #include "log.h"
+#include "util.h"
 
 #include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
 
 int aiger_lit2lit(unsigned aigerlit, int truelit) {
     if (aigerlit == aiger_true) {
@@ -45,25 +48,196 @@ unsigned var2aigerlit(unsigned var_id) {
     return 2 * var_id;
 }
 
-unsigned aigeru_multiAND(aiger* a, unsigned* max_sym, int_vector* input_aigerlits) {
-    unsigned outputlit = inc(max_sym);
-    aigeru_add_multiAND(a, max_sym, outputlit, input_aigerlits);
-    return outputlit;
+#define AIGERU_INITIAL_GATE_SLOTS 1024
+
+aigeru_builder* aigeru_builder_init(aiger* a, unsigned max_sym) {
+    aigeru_builder* b = malloc(sizeof(aigeru_builder));
+    b->a = a;
+    b->max_sym = max_sym;
+    b->size = AIGERU_INITIAL_GATE_SLOTS;
+    b->gates = calloc(b->size, sizeof(aiger_and));
+    b->count = 0;
+    b->reused_gates = 0;
+    b->balanced = true;
+    b->rewrite = false;
+    b->levels = int_vector_init();
+    b->gate_index = int_vector_init();
+    return b;
+}
+
+void aigeru_builder_free(aigeru_builder* b) {
+    free(b->gates);
+    int_vector_free(b->levels);
+    int_vector_free(b->gate_index);
+    free(b);
+}
+
+unsigned aigeru_level(aigeru_builder* b, unsigned aigerlit) {
+    unsigned var = aiger_lit2var(aigerlit);
+    return var < int_vector_count(b->levels) ? (unsigned) int_vector_get(b->levels, var) : 0;
+}
+
+unsigned aigeru_depth(aigeru_builder* b) {
+    unsigned depth = 0;
+    for (unsigned i = 0; i < b->a->num_outputs; i++) {
+        unsigned level = aigeru_level(b, b->a->outputs[i].lit);
+        depth = level > depth ? level : depth;
+    }
+    return depth;
+}
+
+void aigeru_print_statistics(aigeru_builder* b) {
+    V0("Certificate statistics:\n");
+    V0("  AND gates: %u\n", b->a->num_ands);
+    V0("  Depth: %u\n", aigeru_depth(b));
+    V0("  Reused by structural hashing: %zu\n", b->reused_gates);
+}
+
+// Returns whether aigerlit is the output of a gate of b, possibly negated, and gives its inputs
+static bool aigeru_get_AND(aigeru_builder* b, unsigned aigerlit, unsigned* rhs0, unsigned* rhs1) {
+    unsigned var = aiger_lit2var(aigerlit);
+    if (var >= int_vector_count(b->gate_index) || int_vector_get(b->gate_index, var) < 0) {
+        return false;
+    }
+    aiger_and* and = &b->a->ands[int_vector_get(b->gate_index, var)];
+    *rhs0 = and->rhs0;
+    *rhs1 = and->rhs1;
+    return true;
+}
+
+// Returns the slot of the gate with the given inputs, or the free slot where it belongs
+static size_t aigeru_find_slot(aigeru_builder* b, unsigned rhs0, unsigned rhs1) {
+    assert(rhs0 >= rhs1);
+    size_t mask = b->size - 1;
+    size_t i = (size_t) (unsigned) hash32shiftmult((int) (rhs0 * 0x9e3779b1u ^ rhs1)) & mask;
+    while (b->gates[i].lhs != 0 && (b->gates[i].rhs0 != rhs0 || b->gates[i].rhs1 != rhs1)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static void aigeru_resize(aigeru_builder* b) {
+    aiger_and* old_gates = b->gates;
+    size_t old_size = b->size;
+    b->size *= 2;
+    b->gates = calloc(b->size, sizeof(aiger_and));
+    for (size_t i = 0; i < old_size; i++) {
+        if (old_gates[i].lhs != 0) {
+            b->gates[aigeru_find_slot(b, old_gates[i].rhs0, old_gates[i].rhs1)] = old_gates[i];
+        }
+    }
+    free(old_gates);
+}
+
+// Adds the gate to the aiger structure and to the index. For duplicates, the index keeps the earlier gate.
+static void aigeru_define_AND(aigeru_builder* b, unsigned lhs, unsigned rhs0, unsigned rhs1) {
+    aiger_add_and(b->a, lhs, rhs0, rhs1);
+    unsigned level0 = aigeru_level(b, rhs0);
+    unsigned level1 = aigeru_level(b, rhs1);
+    unsigned var = aiger_lit2var(lhs);
+    while (int_vector_count(b->levels) <= var) {
+        int_vector_add(b->levels, 0);
+        int_vector_add(b->gate_index, -1);
+    }
+    int_vector_set(b->levels, var, (int) (level0 > level1 ? level0 : level1) + 1);
+    int_vector_set(b->gate_index, var, (int) b->a->num_ands - 1);
+    if (rhs0 < rhs1) {
+        unsigned tmp = rhs0;
+        rhs0 = rhs1;
+        rhs1 = tmp;
+    }
+    size_t i = aigeru_find_slot(b, rhs0, rhs1);
+    if (b->gates[i].lhs != 0) {
+        return;
+    }
+    b->gates[i].lhs = lhs;
+    b->gates[i].rhs0 = rhs0;
+    b->gates[i].rhs1 = rhs1;
+    b->count += 1;
+    if (2 * b->count > b->size) {
+        aigeru_resize(b);
+    }
+}
+
+// Sorts aiger literals by their level; literals of the same level keep a fixed order
+static int aigeru_compare_levels(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+// Removes the operand of lowest level from the front of the sorted inputs or the front of the gates
+static unsigned aigeru_pop_lowest(aigeru_builder* b, uint64_t* inputs, unsigned n, unsigned* next_input,
+                                  unsigned* gates, unsigned* first_gate, unsigned num_gates) {
+    if (*first_gate == num_gates || (*next_input < n && (inputs[*next_input] >> 32) <= aigeru_level(b, gates[*first_gate]))) {
+        return (unsigned) inputs[(*next_input)++];
+    }
+    return gates[(*first_gate)++];
+}
+
+/* Conjoins all inputs but the last two and returns these in i1 and i2; requires two or more inputs.
+ * Balanced: combines the two inputs of lowest level until two are left, using two queues as for
+ * Huffman codes: the sorted inputs and the new gates, whose levels grow in the order of creation.
+ * Otherwise a chain: the first inputs are conjoined from left to right.
+ */
+static void aigeru_reduce_AND(aigeru_builder* b, int_vector* input_aigerlits, unsigned* i1, unsigned* i2) {
+    unsigned n = int_vector_count(input_aigerlits);
+    assert(n >= 2);
+    if (! b->balanced) {
+        *i1 = aiger_true;
+        for (unsigned i = 0; i < n - 1; i++) {
+            *i1 = aigeru_AND(b, *i1, (unsigned) int_vector_get(input_aigerlits, i));
+        }
+        *i2 = (unsigned) int_vector_get(input_aigerlits, n - 1);
+        return;
+    }
+    uint64_t* inputs = malloc(sizeof(uint64_t) * n); // level in the upper half, literal in the lower half
+    for (unsigned i = 0; i < n; i++) {
+        unsigned lit = (unsigned) int_vector_get(input_aigerlits, i);
+        inputs[i] = ((uint64_t) aigeru_level(b, lit) << 32) | lit;
+    }
+    qsort(inputs, n, sizeof(uint64_t), aigeru_compare_levels);
+    unsigned* gates = malloc(sizeof(unsigned) * n);
+    unsigned next_input = 0;
+    unsigned first_gate = 0;
+    unsigned num_gates = 0;
+    for (unsigned k = 0; k + 2 < n; k++) {
+        unsigned operand1 = aigeru_pop_lowest(b, inputs, n, &next_input, gates, &first_gate, num_gates);
+        unsigned operand2 = aigeru_pop_lowest(b, inputs, n, &next_input, gates, &first_gate, num_gates);
+        gates[num_gates++] = aigeru_AND(b, operand1, operand2);
+    }
+    // the last two operands are left to the caller
+    *i1 = aigeru_pop_lowest(b, inputs, n, &next_input, gates, &first_gate, num_gates);
+    *i2 = aigeru_pop_lowest(b, inputs, n, &next_input, gates, &first_gate, num_gates);
+    free(inputs);
+    free(gates);
+}
+
+unsigned aigeru_multiAND(aigeru_builder* b, int_vector* input_aigerlits) {
+    if (int_vector_count(input_aigerlits) == 0) {
+        return aiger_true; // empty AND is true
+    }
+    if (int_vector_count(input_aigerlits) == 1) {
+        return (unsigned) int_vector_get(input_aigerlits, 0);
+    }
+    unsigned i1, i2;
+    aigeru_reduce_AND(b, input_aigerlits, &i1, &i2);
+    return aigeru_AND(b, i1, i2);
 }
 
-void aigeru_add_multiAND(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits) {
+void aigeru_add_multiAND(aigeru_builder* b, unsigned output_aigerlit, int_vector* input_aigerlits) {
     assert(!is_negated(output_aigerlit));
     if (int_vector_count(input_aigerlits) == 0) {
-        aiger_add_and(a, output_aigerlit, aiger_true, aiger_true); // empty AND is true
+        aigeru_define_AND(b, output_aigerlit, aiger_true, aiger_true); // empty AND is true
         return;
     }
-    unsigned cur_output = aiger_true;
-    for (unsigned i = 0; i < int_vector_count(input_aigerlits) - 1; i++) {
-        unsigned input_aigerlit = (unsigned) int_vector_get(input_aigerlits, i);
-        cur_output = aigeru_AND(a, max_sym, cur_output, input_aigerlit);
+    if (int_vector_count(input_aigerlits) == 1) {
+        aigeru_define_AND(b, output_aigerlit, aiger_true, (unsigned) int_vector_get(input_aigerlits, 0));
+        return;
     }
-    unsigned last_lit = (unsigned) int_vector_get(input_aigerlits, int_vector_count(input_aigerlits) - 1);
-    aiger_add_and(a, output_aigerlit, cur_output, last_lit);
+    unsigned i1, i2;
+    aigeru_reduce_AND(b, input_aigerlits, &i1, &i2);
+    aigeru_define_AND(b, output_aigerlit, i1, i2);
 }
 
 //void aigeru_add_multiAND(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits) {
@@ -90,22 +264,56 @@ void aigeru_add_multiAND(aiger* a, unsigned* max_sym, unsigned output_aigerlit,
 //    aiger_add_and(a, cur_outputlit, last_lit, second_to_last_lit);
 //}
 
-void aigeru_add_OR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, unsigned i1, unsigned i2) {
-    unsigned negated_outputlit = 0;
-    if (is_negated(output_aigerlit)) {
-        negated_outputlit = negate(output_aigerlit);
-    } else {
-        negated_outputlit = inc(max_sym);
-        aiger_add_and(a, output_aigerlit, negate(negated_outputlit), negate(negated_outputlit));
+void aigeru_add_OR(aigeru_builder* b, unsigned output_aigerlit, unsigned i1, unsigned i2) {
+    unsigned negated_outputlit = is_negated(output_aigerlit) ? negate(output_aigerlit) : inc(&b->max_sym);
+    aigeru_define_AND(b, negated_outputlit, negate(i1), negate(i2));
+    if (! is_negated(output_aigerlit)) {
+        aigeru_define_AND(b, output_aigerlit, negate(negated_outputlit), negate(negated_outputlit));
     }
-    aiger_add_and(a, negated_outputlit, negate(i1), negate(i2));
 }
 
-unsigned aigeru_OR(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2) {
-    return negate(aigeru_AND(a, max_sym, negate(i1), negate(i2)));
+unsigned aigeru_OR(aigeru_builder* b, unsigned i1, unsigned i2) {
+    return negate(aigeru_AND(b, negate(i1), negate(i2)));
+}
+
+/* The two-level rules of Brummayer and Biere, "Local Two-Level And-Inverter Graph Minimization without
+ * Blowup" (2006), for i1 & i2 where i1 is a gate (x0 & x1) or its negation. Returns AIGERLIT_NO_RULE if no
+ * rule applies.
+ */
+#define AIGERLIT_NO_RULE UINT32_MAX
+static unsigned aigeru_rewrite_AND(aigeru_builder* b, unsigned i1, unsigned i2) {
+    unsigned x0, x1;
+    if (! aigeru_get_AND(b, i1, &x0, &x1)) {
+        return AIGERLIT_NO_RULE;
+    }
+    if (! is_negated(i1)) {
+        if (i2 == negate(x0) || i2 == negate(x1)) {
+            return aiger_false; // contradiction
+        }
+        if (i2 == x0 || i2 == x1) {
+            return i1; // idempotence
+        }
+        unsigned y0, y1;
+        if (! is_negated(i2) && aigeru_get_AND(b, i2, &y0, &y1)
+            && (x0 == negate(y0) || x0 == negate(y1) || x1 == negate(y0) || x1 == negate(y1))) {
+            return aiger_false; // contradiction over two levels
+        }
+    } else {
+        if (i2 == negate(x0) || i2 == negate(x1)) {
+            return i2; // subsumption
+        }
+        if (i2 == x0) {
+            return aigeru_AND(b, i2, negate(x1)); // substitution
+        }
+        if (i2 == x1) {
+            return aigeru_AND(b, i2, negate(x0));
+        }
+    }
+    return AIGERLIT_NO_RULE;
 }
 
-unsigned aigeru_AND(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2) {
+// Returns the existing gate if an AND over the same inputs was created before
+unsigned aigeru_AND(aigeru_builder* b, unsigned i1, unsigned i2) {
     if (i1 == aiger_true) {
         return i2;
     }
@@ -121,68 +329,412 @@ unsigned aigeru_AND(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2) {
     if (i1 == negate(i2)) {
         return aiger_false;
     }
-    unsigned out = inc(max_sym);
-    aiger_add_and(a, out, i1, i2);
+    if (b->rewrite) {
+        unsigned res = aigeru_rewrite_AND(b, i1, i2);
+        if (res == AIGERLIT_NO_RULE) {
+            res = aigeru_rewrite_AND(b, i2, i1);
+        }
+        if (res != AIGERLIT_NO_RULE) {
+            return res;
+        }
+    }
+    unsigned rhs0 = i1 > i2 ? i1 : i2;
+    unsigned rhs1 = i1 > i2 ? i2 : i1;
+    size_t i = aigeru_find_slot(b, rhs0, rhs1);
+    if (b->gates[i].lhs != 0) {
+        b->reused_gates += 1;
+        return b->gates[i].lhs;
+    }
+    unsigned out = inc(&b->max_sym);
+    aigeru_define_AND(b, out, rhs0, rhs1);
     return out;
 }
 
-unsigned aigeru_multiOR(aiger* a, unsigned* max_sym, int_vector* input_aigerlits) {
-    unsigned outputlit = aiger_false;
-    for (unsigned i = 0; i < int_vector_count(input_aigerlits); i++) {
-        outputlit = aigeru_OR(a, max_sym, outputlit, (unsigned) int_vector_get(input_aigerlits, i));
+static int_vector* aigeru_negate_all(int_vector* aigerlits) {
+    int_vector* negated = int_vector_init();
+    for (unsigned i = 0; i < int_vector_count(aigerlits); i++) {
+        int_vector_add(negated, (int) negate((unsigned) int_vector_get(aigerlits, i)));
     }
+    return negated;
+}
+
+unsigned aigeru_multiOR(aigeru_builder* b, int_vector* input_aigerlits) {
+    int_vector* negated_inputlits = aigeru_negate_all(input_aigerlits);
+    unsigned outputlit = negate(aigeru_multiAND(b, negated_inputlits));
+    int_vector_free(negated_inputlits);
     return outputlit;
 }
 
-void aigeru_add_multiOR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits) {
-    unsigned negated_outputlit = 0;
-    if (is_negated(output_aigerlit)) {
-        negated_outputlit = negate(output_aigerlit);
-    } else {
-        negated_outputlit = inc(max_sym);
-        aiger_add_and(a, output_aigerlit, negate(negated_outputlit), negate(negated_outputlit));
-    }
-    int_vector* negated_inputlits = int_vector_init();
-    for (unsigned i = 0; i < int_vector_count(input_aigerlits); i++) {
-        int_vector_add(negated_inputlits, (int) negate((unsigned) int_vector_get(input_aigerlits, i)));
-    }
-    aigeru_add_multiAND(a, max_sym, negated_outputlit, negated_inputlits);
+void aigeru_add_multiOR(aigeru_builder* b, unsigned output_aigerlit, int_vector* input_aigerlits) {
+    unsigned negated_outputlit = is_negated(output_aigerlit) ? negate(output_aigerlit) : inc(&b->max_sym);
+    int_vector* negated_inputlits = aigeru_negate_all(input_aigerlits);
+    aigeru_add_multiAND(b, negated_outputlit, negated_inputlits);
     int_vector_free(negated_inputlits);
+    if (! is_negated(output_aigerlit)) {
+        aigeru_define_AND(b, output_aigerlit, negate(negated_outputlit), negate(negated_outputlit));
+    }
 }
 
 
-void aigeru_add_multiplexer(aiger* a, unsigned* max_sym, unsigned output,
+void aigeru_add_multiplexer(aigeru_builder* b, unsigned output,
                                unsigned selector, unsigned if_signal, unsigned else_signal) {
     LOG_WARNING("Not sure if this component is correct.");
-    unsigned if_component = inc(max_sym);
-    aiger_add_and(a, if_component, selector, if_signal);
-    unsigned else_component = inc(max_sym);
-    aiger_add_and(a, else_component, negate(selector), else_signal);
-    unsigned negation_of_output = inc(max_sym); // need extra symbol as we cannot define left side of the final and as negated signal.
-    aiger_add_and(a, negation_of_output, negate(if_component), negate(else_component));
-    aiger_add_and(a, output, negate(negation_of_output), negate(negation_of_output));
+    unsigned if_component = inc(&b->max_sym);
+    aigeru_define_AND(b, if_component, selector, if_signal);
+    unsigned else_component = inc(&b->max_sym);
+    aigeru_define_AND(b, else_component, negate(selector), else_signal);
+    unsigned negation_of_output = inc(&b->max_sym); // need extra symbol as we cannot define left side of the final and as negated signal.
+    aigeru_define_AND(b, negation_of_output, negate(if_component), negate(else_component));
+    aigeru_define_AND(b, output, negate(negation_of_output), negate(negation_of_output));
 }
 
-unsigned aigeru_MUX(aiger* a, unsigned* max_sym, unsigned selector, unsigned i1, unsigned i2) {
-    unsigned i1_out = aigeru_AND(a, max_sym, selector, i1);
-    unsigned i2_out = aigeru_AND(a, max_sym, negate(selector), i2);
-    return aigeru_OR(a, max_sym, i1_out, i2_out);
+unsigned aigeru_MUX(aigeru_builder* b, unsigned selector, unsigned i1, unsigned i2) {
+    unsigned i1_out = aigeru_AND(b, selector, i1);
+    unsigned i2_out = aigeru_AND(b, negate(selector), i2);
+    return aigeru_OR(b, i1_out, i2_out);
 }
 
 
-unsigned aigeru_multiMUX(aiger* a, unsigned* max_sym, int_vector* selectors, int_vector* inputs) {
+/* The first selector that is true selects its input; the selected values are combined by aigeru_multiOR.
+ * Adjacent selectors with the same input are merged: the run applies if no earlier selector is true, but
+ * one of the selectors up to the end of the run.
+ */
+unsigned aigeru_multiMUX(aigeru_builder* b, int_vector* selectors, int_vector* inputs) {
     assert(int_vector_count(selectors) == int_vector_count(inputs));
-    unsigned out = aiger_false;
+    int_vector* selected_values = int_vector_init();
     unsigned previous_case_applies = aiger_false;
-    for (unsigned i = 0; i < int_vector_count(selectors); i++) {
-        unsigned selector = (unsigned) int_vector_get(selectors, i);
+    unsigned i = 0;
+    while (i < int_vector_count(selectors)) {
         unsigned value = (unsigned) int_vector_get(inputs, i);
-        unsigned this_case_applies = aigeru_AND(a, max_sym, negate(previous_case_applies), selector);
-        unsigned selected_value = aigeru_AND(a, max_sym, this_case_applies, value);
-        out = aigeru_OR(a, max_sym, out, selected_value);
-        if (i + 1 < int_vector_count(selectors)) {
-            previous_case_applies = aigeru_OR(a, max_sym, previous_case_applies, selector);
+        unsigned run_start = i;
+        unsigned before_run = previous_case_applies;
+        for (; i < int_vector_count(selectors) && (unsigned) int_vector_get(inputs, i) == value; i++) {
+            if (i > run_start || i + 1 < int_vector_count(selectors)) {
+                previous_case_applies = aigeru_OR(b, previous_case_applies, (unsigned) int_vector_get(selectors, i));
+            }
         }
+        unsigned run_applies = i == run_start + 1
+            ? (unsigned) int_vector_get(selectors, run_start)
+            : previous_case_applies;
+        unsigned this_case_applies = aigeru_AND(b, negate(before_run), run_applies);
+        int_vector_add(selected_values, (int) aigeru_AND(b, this_case_applies, value));
     }
+    unsigned out = aigeru_multiOR(b, selected_values);
+    int_vector_free(selected_values);
     return out;
 }
+
+#define AIGERU_MAX_MINIMIZATION_ROUNDS 8
+#define AIGERLIT_UNMAPPED UINT32_MAX
+
+/* Collects the inputs of the AND tree at the gate of var. With balance, the tree extends through
+ * non-negated inputs that are gates with a single reference; otherwise it is the gate itself.
+ */
+static void aigeru_collect_conjuncts(aiger* a, int* gate_of, unsigned* references, bool balance,
+                                     unsigned var, int_vector* conjuncts, int_vector* stack) {
+    int_vector_reset(conjuncts);
+    int_vector_reset(stack);
+    int_vector_add(stack, (int) var2aigerlit(var));
+    while (int_vector_count(stack) > 0) {
+        unsigned lit = (unsigned) int_vector_pop(stack);
+        unsigned v = aiger_lit2var(lit);
+        if (v == var || (balance && ! is_negated(lit) && gate_of[v] >= 0 && references[v] == 1)) {
+            aiger_and* and = &a->ands[gate_of[v]];
+            int_vector_add(stack, (int) and->rhs1);
+            int_vector_add(stack, (int) and->rhs0);
+        } else {
+            int_vector_add(conjuncts, (int) lit);
+        }
+    }
+}
+
+// Copies the inputs, the outputs, and the gates the outputs depend on into a new aiger structure
+static aigeru_builder* aigeru_copy(aiger* a, bool rewrite, bool balance) {
+    aiger* m = aiger_init();
+    unsigned max_input_var = 0;
+    for (unsigned i = 0; i < a->num_inputs; i++) {
+        aiger_add_input(m, a->inputs[i].lit, a->inputs[i].name);
+        unsigned var = aiger_lit2var(a->inputs[i].lit);
+        max_input_var = var > max_input_var ? var : max_input_var;
+    }
+    aigeru_builder* b = aigeru_builder_init(m, var2aigerlit(max_input_var));
+    b->rewrite = rewrite;
+    
+    int* gate_of = malloc(sizeof(int) * (a->maxvar + 1));
+    unsigned* references = calloc(a->maxvar + 1, sizeof(unsigned));
+    unsigned* copies = malloc(sizeof(unsigned) * (a->maxvar + 1)); // maps variables of a to literals of the copy
+    for (unsigned var = 0; var <= a->maxvar; var++) {
+        gate_of[var] = -1;
+        copies[var] = AIGERLIT_UNMAPPED;
+    }
+    for (unsigned i = 0; i < a->num_ands; i++) {
+        gate_of[aiger_lit2var(a->ands[i].lhs)] = (int) i;
+    }
+    copies[0] = aiger_false;
+    for (unsigned i = 0; i < a->num_inputs; i++) {
+        copies[aiger_lit2var(a->inputs[i].lit)] = a->inputs[i].lit;
+    }
+    
+    // Count the references among the gates the outputs depend on; the tree of a gate referenced twice is not extended
+    int_vector* stack = int_vector_init();
+    for (unsigned i = 0; i < a->num_outputs; i++) {
+        unsigned var = aiger_lit2var(a->outputs[i].lit);
+        references[var] += 1;
+        if (references[var] == 1) {
+            int_vector_add(stack, (int) var);
+        }
+    }
+    while (int_vector_count(stack) > 0) { // every variable is pushed once, at its first reference
+        unsigned var = (unsigned) int_vector_pop(stack);
+        if (gate_of[var] < 0) {
+            continue;
+        }
+        aiger_and* and = &a->ands[gate_of[var]];
+        unsigned inputs[2] = {and->rhs0, and->rhs1};
+        for (unsigned j = 0; j < 2; j++) {
+            unsigned v = aiger_lit2var(inputs[j]);
+            references[v] += 1;
+            if (references[v] == 1) {
+                int_vector_add(stack, (int) v);
+            }
+        }
+    }
+    
+    // Depth-first: a gate is copied once the inputs of its AND tree are copied
+    int_vector* conjuncts = int_vector_init();
+    int_vector* tree_stack = int_vector_init();
+    for (unsigned i = 0; i < a->num_outputs; i++) {
+        int_vector_add(stack, (int) aiger_lit2var(a->outputs[i].lit));
+    }
+    while (int_vector_count(stack) > 0) {
+        unsigned var = (unsigned) int_vector_get(stack, int_vector_count(stack) - 1);
+        if (copies[var] != AIGERLIT_UNMAPPED) {
+            int_vector_pop(stack);
+            continue;
+        }
+        aigeru_collect_conjuncts(a, gate_of, references, balance, var, conjuncts, tree_stack);
+        bool ready = true;
+        for (unsigned j = 0; j < int_vector_count(conjuncts); j++) {
+            unsigned v = aiger_lit2var((unsigned) int_vector_get(conjuncts, j));
+            if (copies[v] == AIGERLIT_UNMAPPED) {
+                int_vector_add(stack, (int) v);
+                ready = false;
+            }
+        }
+        if (ready) {
+            int_vector_pop(stack);
+            for (unsigned j = 0; j < int_vector_count(conjuncts); j++) {
+                unsigned lit = (unsigned) int_vector_get(conjuncts, j);
+                int_vector_set(conjuncts, j, (int) (copies[aiger_lit2var(lit)] ^ aiger_sign(lit)));
+            }
+            copies[var] = aigeru_multiAND(b, conjuncts);
+        }
+    }
+    for (unsigned i = 0; i < a->num_outputs; i++) {
+        unsigned lit = a->outputs[i].lit;
+        aiger_add_output(m, copies[aiger_lit2var(lit)] ^ aiger_sign(lit), a->outputs[i].name);
+    }
+    
+    int_vector_free(stack);
+    int_vector_free(conjuncts);
+    int_vector_free(tree_stack);
+    free(gate_of);
+    free(references);
+    free(copies);
+    return b;
+}
+
+static void aigeru_free_copy(aigeru_builder* b) {
+    aiger_reset(b->a);
+    aigeru_builder_free(b);
+}
+
+aigeru_builder* aigeru_minimize(aiger* a, unsigned effort) {
+    assert(effort > 0);
+    bool rewrite = effort >= 2;
+    aigeru_builder* b = aigeru_copy(a, rewrite, false);
+    if (effort >= 3) {
+        aigeru_builder* balanced = aigeru_copy(b->a, rewrite, true);
+        if (balanced->a->num_ands <= b->a->num_ands && aigeru_depth(balanced) <= aigeru_depth(b)) {
+            aigeru_free_copy(b);
+            b = balanced;
+        } else {
+            aigeru_free_copy(balanced);
+        }
+    }
+    // Gates that became unused in a round are dropped in the next; rewriting may also find new matches
+    for (unsigned round = 1; round < AIGERU_MAX_MINIMIZATION_ROUNDS; round++) {
+        aigeru_builder* next = aigeru_copy(b->a, rewrite, false);
+        if (next->a->num_ands >= b->a->num_ands) {
+            aigeru_free_copy(next);
+            break;
+        }
+        aigeru_free_copy(b);
+        b = next;
+    }
+    return b;
+}
+
+// The gates are numbered consecutively, starting after the largest variable that is not a gate
+static unsigned aigeru_first_gate_var(aiger* a) {
+    return a->num_ands > 0 ? aiger_lit2var(a->ands[0].lhs) : a->maxvar + 1;
+}
+
+// Whether lit is a constant, an input, or one of the first num_gates gates
+static bool aigeru_is_defined_before(aiger* a, unsigned lit, unsigned num_gates) {
+    unsigned var = aiger_lit2var(lit);
+    unsigned first_gate_var = aigeru_first_gate_var(a);
+    if (var == 0) {
+        return true;
+    } else if (var < first_gate_var) {
+        return aiger_is_input(a, aiger_strip(lit)) != NULL;
+    } else {
+        return var < first_gate_var + num_gates;
+    }
+}
+
+bool aigeru_has_builder_numbering(aiger* a) {
+    if (a->num_latches || a->num_bad || a->num_constraints || a->num_justice || a->num_fairness) {
+        return false;
+    }
+    unsigned first_gate_var = aigeru_first_gate_var(a);
+    for (unsigned i = 0; i < a->num_inputs; i++) {
+        if (aiger_lit2var(a->inputs[i].lit) >= first_gate_var) {
+            return false;
+        }
+    }
+    for (unsigned i = 0; i < a->num_ands; i++) {
+        aiger_and* and = &a->ands[i];
+        if (and->lhs != var2aigerlit(first_gate_var + i)
+            || ! aigeru_is_defined_before(a, and->rhs0, i)
+            || ! aigeru_is_defined_before(a, and->rhs1, i)) {
+            return false;
+        }
+    }
+    for (unsigned i = 0; i < a->num_outputs; i++) {
+        if (! aigeru_is_defined_before(a, a->outputs[i].lit, a->num_ands)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Inputs get the variables 1 to num_inputs in their order in a->inputs, the live gates the following ones
+static unsigned aigeru_binary_lit(aiger* a, unsigned first_gate_var, unsigned* gate_numbers, unsigned lit) {
+    unsigned var = aiger_lit2var(lit);
+    if (var == 0) {
+        return lit;
+    } else if (var < first_gate_var) {
+        aiger_symbol* input = aiger_is_input(a, aiger_strip(lit));
+        return var2aigerlit((unsigned) (input - a->inputs) + 1) + aiger_sign(lit);
+    } else {
+        assert(gate_numbers[var - first_gate_var] != 0);
+        return var2aigerlit(a->num_inputs + gate_numbers[var - first_gate_var]) + aiger_sign(lit);
+    }
+}
+
+static void aigeru_mark_live(unsigned first_gate_var, unsigned* gate_numbers, unsigned lit) {
+    unsigned var = aiger_lit2var(lit);
+    if (var >= first_gate_var) {
+        gate_numbers[var - first_gate_var] = 1;
+    }
+}
+
+/* Numbers the gates that the outputs depend on consecutively, starting from 1, and the others 0.
+ * As the gates are in topological order, a single backwards pass finds the live ones. Returns their number.
+ */
+static unsigned aigeru_number_live_gates(aiger* a, unsigned first_gate_var, unsigned* gate_numbers) {
+    for (unsigned i = 0; i < a->num_outputs; i++) {
+        aigeru_mark_live(first_gate_var, gate_numbers, a->outputs[i].lit);
+    }
+    for (unsigned i = a->num_ands; i > 0; i--) {
+        if (gate_numbers[i - 1]) {
+            aigeru_mark_live(first_gate_var, gate_numbers, a->ands[i - 1].rhs0);
+            aigeru_mark_live(first_gate_var, gate_numbers, a->ands[i - 1].rhs1);
+        }
+    }
+    unsigned num_live = 0;
+    for (unsigned i = 0; i < a->num_ands; i++) {
+        if (gate_numbers[i]) {
+            gate_numbers[i] = ++num_live;
+        }
+    }
+    return num_live;
+}
+
+// Seven bits per byte, least significant first; the high bit marks that more bytes follow
+static bool aigeru_write_delta(FILE* file, unsigned delta) {
+    while (delta & ~0x7fu) {
+        if (fputc((int) ((delta & 0x7f) | 0x80), file) == EOF) {
+            return false;
+        }
+        delta >>= 7;
+    }
+    return fputc((int) delta, file) != EOF;
+}
+
+static bool aigeru_write_symbols(FILE* file, const char* type, aiger_symbol* symbols, unsigned num) {
+    for (unsigned i = 0; i < num; i++) {
+        if (symbols[i].name && fprintf(file, "%s%u %s\n", type, i, symbols[i].name) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool aigeru_write_gates(aiger* a, FILE* file, unsigned* gate_numbers) {
+    unsigned first_gate_var = aigeru_first_gate_var(a);
+    unsigned num_live = aigeru_number_live_gates(a, first_gate_var, gate_numbers);
+    if (fprintf(file, "aig %u %u 0 %u %u\n", a->num_inputs + num_live, a->num_inputs, a->num_outputs, num_live) < 0) {
+        return false;
+    }
+    for (unsigned i = 0; i < a->num_outputs; i++) {
+        if (fprintf(file, "%u\n", aigeru_binary_lit(a, first_gate_var, gate_numbers, a->outputs[i].lit)) < 0) {
+            return false;
+        }
+    }
+    for (unsigned i = 0; i < a->num_ands; i++) {
+        if (gate_numbers[i] == 0) {
+            continue;
+        }
+        unsigned lhs = var2aigerlit(a->num_inputs + gate_numbers[i]);
+        unsigned rhs0 = aigeru_binary_lit(a, first_gate_var, gate_numbers, a->ands[i].rhs0);
+        unsigned rhs1 = aigeru_binary_lit(a, first_gate_var, gate_numbers, a->ands[i].rhs1);
+        if (rhs0 < rhs1) {
+            unsigned tmp = rhs0;
+            rhs0 = rhs1;
+            rhs1 = tmp;
+        }
+        assert(lhs > rhs0);
+        if (! aigeru_write_delta(file, lhs - rhs0) || ! aigeru_write_delta(file, rhs0 - rhs1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool aigeru_write_binary(aiger* a, FILE* file) {
+    assert(aigeru_has_builder_numbering(a));
+    unsigned* gate_numbers = calloc(a->num_ands > 0 ? a->num_ands : 1, sizeof(unsigned));
+    if (gate_numbers == NULL) {
+        return false;
+    }
+    bool success = aigeru_write_gates(a, file, gate_numbers);
+    free(gate_numbers);
+    if (! success
+        || ! aigeru_write_symbols(file, "i", a->inputs, a->num_inputs)
+        || ! aigeru_write_symbols(file, "o", a->outputs, a->num_outputs)) {
+        return false;
+    }
+    if (a->comments[0]) {
+        if (fputs("c\n", file) == EOF) {
+            return false;
+        }
+        for (char** comment = a->comments; *comment; comment++) {
+            if (fprintf(file, "%s\n", *comment) < 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -13,6 +13,7 @@
 #include "int_vector.h"
 
 #include <stdbool.h>
+#include <stdio.h>
 
 int aiger_lit2lit(unsigned aigerlit, int truelit); // truelit indicates a literal that represents true
 unsigned inc(unsigned* sym);
@@ -21,18 +22,58 @@ unsigned negate(unsigned signal);
 unsigned var2aigerlit(unsigned var_id);
 
 
-void aigeru_add_multiAND(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits);
-void aigeru_add_OR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, unsigned i1, unsigned i2);
-void aigeru_add_multiOR(aiger* a, unsigned* max_sym, unsigned output_aigerlit, int_vector* input_aigerlits);
-void aigeru_add_multiplexer(aiger* a, unsigned* max_sym,
-                            unsigned output, unsigned selector, unsigned if_signal, unsigned else_signal);
-unsigned aigeru_MUX(aiger* a, unsigned* max_sym, unsigned selector, unsigned i1, unsigned i2);
-unsigned aigeru_multiMUX(aiger* a, unsigned* max_sym, int_vector* selectors, int_vector* inputs);
+/* Creates AND gates in the aiger structure a and hands out fresh aiger literals starting after max_sym.
+ * Structural hashing: the gates are indexed by their inputs, so that an AND over the same pair of
+ * inputs is only created once (see aigeru_AND). Multi-input gates are built as balanced trees that
+ * combine the inputs of lowest level first, or as chains if balanced is false. With rewrite, aigeru_AND
+ * also applies two-level rewriting rules (see aigeru_minimize).
+ */
+typedef struct {
+    aiger* a;
+    unsigned max_sym; // the last aiger literal handed out
+    aiger_and* gates; // open addressing with linear probing; rhs0 >= rhs1, lhs == 0 marks a free slot
+    size_t size; // number of slots; power of two
+    size_t count;
+    size_t reused_gates; // requested AND gates that existed already
+    bool balanced;
+    bool rewrite;
+    int_vector* levels; // maps aiger variables to the length of the longest path to an input; 0 for inputs
+    int_vector* gate_index; // maps aiger variables to the position of their gate in a->ands; -1 for inputs
+} aigeru_builder;
 
-unsigned aigeru_OR(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2);
-unsigned aigeru_AND(aiger* a, unsigned* max_sym, unsigned i1, unsigned i2);
-unsigned aigeru_multiOR(aiger* a, unsigned* max_sym, int_vector* input_aigerlits);
-unsigned aigeru_multiAND(aiger* a, unsigned* max_sym, int_vector* input_aigerlits);
+aigeru_builder* aigeru_builder_init(aiger* a, unsigned max_sym);
+void aigeru_builder_free(aigeru_builder*);
+unsigned aigeru_level(aigeru_builder*, unsigned aigerlit);
+unsigned aigeru_depth(aigeru_builder*); // the maximal level of the outputs
+void aigeru_print_statistics(aigeru_builder*); // gates, depth, and reused gates
+
+/* Returns a builder for a minimized copy of a with the same inputs and outputs; a is not modified.
+ * Effort 1 copies the gates the outputs depend on through aigeru_AND, which propagates constants
+ * and merges equal gates. Effort 2 adds two-level rewriting, effort 3 rebalances trees of AND gates.
+ * The copy is rebuilt until it stops shrinking. Free the result with aiger_reset(b->a) and aigeru_builder_free.
+ */
+aigeru_builder* aigeru_minimize(aiger* a, unsigned effort);
+
+/* Writes a in the binary AIGER format. Like aiger_write_to_file, it drops the gates that no output depends
+ * on, which are left over when the certificate is not minimized. Unlike aiger_write_to_file, which renumbers
+ * the whole circuit in place (see aiger_reencode), it does not modify a and only needs one number per gate.
+ * The whole circuit is still built in memory before. Requires the form in which aigeru_builder creates
+ * circuits: the gates follow the inputs, numbered consecutively in topological order.
+ */
+bool aigeru_has_builder_numbering(aiger* a);
+bool aigeru_write_binary(aiger* a, FILE* file); // false if writing fails
+
+void aigeru_add_multiAND(aigeru_builder* b, unsigned output_aigerlit, int_vector* input_aigerlits);
+void aigeru_add_OR(aigeru_builder* b, unsigned output_aigerlit, unsigned i1, unsigned i2);
+void aigeru_add_multiOR(aigeru_builder* b, unsigned output_aigerlit, int_vector* input_aigerlits);
+void aigeru_add_multiplexer(aigeru_builder* b, unsigned output, unsigned selector, unsigned if_signal, unsigned else_signal);
+unsigned aigeru_MUX(aigeru_builder* b, unsigned selector, unsigned i1, unsigned i2);
+unsigned aigeru_multiMUX(aigeru_builder* b, int_vector* selectors, int_vector* inputs);
+
+unsigned aigeru_OR(aigeru_builder* b, unsigned i1, unsigned i2);
+unsigned aigeru_AND(aigeru_builder* b, unsigned i1, unsigned i2);
+unsigned aigeru_multiOR(aigeru_builder* b, int_vector* input_aigerlits);
+unsigned aigeru_multiAND(aigeru_builder* b, int_vector* input_aigerlits);
 
 
 #endif /* aiger_utils_h */
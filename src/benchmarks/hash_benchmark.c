@@ -0,0 +1,281 @@
+//
+//  hash_benchmark.c
+//  cadet
+//
+//  Microbenchmark for set and map. Compares the open-addressing implementations in set.c and map.c
+//  with the chained hash tables they replaced, on the access patterns of their main users:
+//  the worklist in conflict analysis, the uniqueness check of the pqueues in the Skolem domain,
+//  the resolution graph, and variable mappings. Build and run with 'make benchmark'.
+//
+
+#include "set.h"
+#include "map.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+
+// The chained hash set and map that set.c and map.c used before; kept here as the baseline
+
+typedef struct chained_entry chained_entry;
+struct chained_entry {
+    int64_t        key;
+    void*          data;
+    chained_entry* next;
+};
+
+typedef struct {
+    chained_entry** data;
+    size_t          size;
+    size_t          count;
+    bool            int_keys; // hash keys like map.c (hash32shiftmult) or like set.c (hash6432shift)
+} chained;
+
+static chained* chained_init(bool int_keys) {
+    chained* c = malloc(sizeof(chained));
+    c->size = int_keys ? 10 : 8;
+    c->data = calloc(sizeof(chained_entry*), c->size);
+    c->count = 0;
+    c->int_keys = int_keys;
+    return c;
+}
+
+static int chained_hash(chained* c, int64_t key, size_t size) {
+    if (c->int_keys) {
+        return hash32shiftmult((int) key) % (int) size;
+    }
+    return abs(hash6432shift((void*) key)) % (int) size;
+}
+
+static chained_entry* chained_get_entry(chained* c, int64_t key) {
+    chained_entry* e = c->data[chained_hash(c, key, c->size)];
+    while (e != NULL && e->key != key) {
+        e = e->next;
+    }
+    return e;
+}
+
+static void chained_add(chained* c, int64_t key, void* data) {
+    int hash = chained_hash(c, key, c->size);
+    chained_entry* e = malloc(sizeof(chained_entry));
+    e->key = key;
+    e->data = data;
+    e->next = c->data[hash];
+    c->data[hash] = e;
+    c->count++;
+    if (c->count > c->size + c->size / 2) {
+        size_t old_size = c->size;
+        chained_entry** old_data = c->data;
+        c->size = 2 * old_size;
+        c->data = calloc(sizeof(chained_entry*), c->size);
+        for (size_t i = 0; i < old_size; i++) {
+            chained_entry* next;
+            for (chained_entry* x = old_data[i]; x != NULL; x = next) {
+                next = x->next;
+                int h = chained_hash(c, x->key, c->size);
+                x->next = c->data[h];
+                c->data[h] = x;
+            }
+        }
+        free(old_data);
+    }
+}
+
+static void chained_remove(chained* c, int64_t key) {
+    int hash = chained_hash(c, key, c->size);
+    chained_entry* e = c->data[hash];
+    chained_entry* prev = NULL;
+    while (e != NULL && e->key != key) {
+        prev = e;
+        e = e->next;
+    }
+    if (e == NULL) {
+        return;
+    }
+    c->count--;
+    if (prev == NULL) {
+        c->data[hash] = e->next;
+    } else {
+        prev->next = e->next;
+    }
+    free(e);
+}
+
+static void chained_reset(chained* c) {
+    if (c->count == 0) {
+        return;
+    }
+    for (size_t i = 0; i < c->size; i++) {
+        chained_entry* next;
+        for (chained_entry* e = c->data[i]; e != NULL; e = next) {
+            next = e->next;
+            free(e);
+        }
+        c->data[i] = NULL;
+    }
+    c->count = 0;
+}
+
+static void chained_free(chained* c) {
+    chained_reset(c);
+    free(c->data);
+    free(c);
+}
+
+// Deterministic pseudo random numbers, so that both implementations see the same sequence
+static uint64_t rng_state;
+static unsigned rng_next(unsigned bound) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned) (rng_state >> 33) % bound;
+}
+
+#define VARS 20000
+#define ROUNDS 20000
+
+// Conflict analysis: a few dozen literals are queued per conflict, membership checks are frequent, the set is reset after each conflict
+static size_t worklist_chained() {
+    size_t hits = 0;
+    chained* c = chained_init(false);
+    rng_state = 1;
+    for (unsigned r = 0; r < ROUNDS; r++) {
+        unsigned n = 10 + rng_next(60);
+        for (unsigned i = 0; i < 3 * n; i++) {
+            int64_t lit = (int64_t) (1 + rng_next(VARS)) * (rng_next(2) ? 1 : -1);
+            if (chained_get_entry(c, lit)) {
+                hits++;
+            } else {
+                chained_add(c, lit, NULL);
+            }
+        }
+        chained_reset(c);
+    }
+    chained_free(c);
+    return hits;
+}
+
+static size_t worklist_open() {
+    size_t hits = 0;
+    set* s = set_init();
+    rng_state = 1;
+    for (unsigned r = 0; r < ROUNDS; r++) {
+        unsigned n = 10 + rng_next(60);
+        for (unsigned i = 0; i < 3 * n; i++) {
+            int64_t lit = (int64_t) (1 + rng_next(VARS)) * (rng_next(2) ? 1 : -1);
+            if (set_contains(s, (void*) lit)) {
+                hits++;
+            } else {
+                set_add(s, (void*) lit);
+            }
+        }
+        set_reset(s);
+    }
+    set_free(s);
+    return hits;
+}
+
+// Determinicity and pure variable queues: var_ids are pushed if not yet queued, and removed from the set when popped
+static size_t pqueue_chained() {
+    size_t hits = 0;
+    chained* c = chained_init(false);
+    int64_t* queue = malloc(sizeof(int64_t) * VARS);
+    unsigned queued = 0;
+    rng_state = 2;
+    for (unsigned r = 0; r < 50 * ROUNDS; r++) {
+        if (queued < VARS && rng_next(3) != 0) {
+            int64_t var_id = 1 + rng_next(VARS);
+            if (chained_get_entry(c, var_id)) {
+                hits++;
+            } else {
+                chained_add(c, var_id, NULL);
+                queue[queued++] = var_id;
+            }
+        } else if (queued > 0) {
+            chained_remove(c, queue[--queued]);
+        }
+    }
+    free(queue);
+    chained_free(c);
+    return hits;
+}
+
+static size_t pqueue_open() {
+    size_t hits = 0;
+    set* s = set_init();
+    int64_t* queue = malloc(sizeof(int64_t) * VARS);
+    unsigned queued = 0;
+    rng_state = 2;
+    for (unsigned r = 0; r < 50 * ROUNDS; r++) {
+        if (queued < VARS && rng_next(3) != 0) {
+            int64_t var_id = 1 + rng_next(VARS);
+            if (set_contains(s, (void*) var_id)) {
+                hits++;
+            } else {
+                set_add(s, (void*) var_id);
+                queue[queued++] = var_id;
+            }
+        } else if (queued > 0) {
+            set_remove(s, (void*) queue[--queued]);
+        }
+    }
+    free(queue);
+    set_free(s);
+    return hits;
+}
+
+// Resolution graph: learnt clause_idxs are added in increasing order and looked up when certificates are computed;
+// variable mappings: a fixed set of dense ids is looked up over and over
+static size_t clause_map_chained() {
+    size_t sum = 0;
+    chained* c = chained_init(true);
+    rng_state = 3;
+    for (unsigned i = 0; i < 10 * ROUNDS; i++) {
+        chained_add(c, (int) (5 * i + rng_next(5)), (void*) (size_t) i);
+    }
+    for (unsigned i = 0; i < 100 * ROUNDS; i++) {
+        chained_entry* e = chained_get_entry(c, (int) rng_next(50 * ROUNDS));
+        if (e) {
+            sum += (size_t) e->data;
+        }
+    }
+    chained_free(c);
+    return sum;
+}
+
+static size_t clause_map_open() {
+    size_t sum = 0;
+    map* m = map_init();
+    rng_state = 3;
+    for (unsigned i = 0; i < 10 * ROUNDS; i++) {
+        map_add(m, (int) (5 * i + rng_next(5)), (void*) (size_t) i);
+    }
+    for (unsigned i = 0; i < 100 * ROUNDS; i++) {
+        int key = (int) rng_next(50 * ROUNDS);
+        if (map_contains(m, key)) {
+            sum += (size_t) map_get(m, key);
+        }
+    }
+    map_free(m);
+    return sum;
+}
+
+static void compare(const char* name, size_t (*chained_version)(), size_t (*open_version)()) {
+    double start = get_seconds();
+    size_t chained_result = chained_version();
+    double chained_time = get_seconds() - start;
+    start = get_seconds();
+    size_t open_result = open_version();
+    double open_time = get_seconds() - start;
+    if (chained_result != open_result) {
+        printf("%s: results differ (%zu vs %zu)\n", name, chained_result, open_result);
+        exit(1);
+    }
+    printf("%-24s chained %7.3fs   open addressing %7.3fs   speedup %.2fx\n", name, chained_time, open_time, chained_time / open_time);
+}
+
+int main() {
+    compare("worklist (literals)", worklist_chained, worklist_open);
+    compare("pqueue (var_ids)", pqueue_chained, pqueue_open);
+    compare("map (clause_idxs)", clause_map_chained, clause_map_open);
+    return 0;
+}
@@ -39,6 +39,12 @@ struct bit_vector {
     int num_words;
     int iteration;
     word* data;
+    
+    // Only for growable bit vectors
+    bool growable;
+    int* touched_words; // may contain duplicates
+    int touched_count; // once it reaches num_words, reset clears all words and no more words are recorded
+    int touched_capacity;
 };
 
 bit_vector* bit_vector_init(int num_variables, int num_clauses) {
@@ -47,20 +53,74 @@ bit_vector* bit_vector_init(int num_variables, int num_clauses) {
     ca->max = num_clauses;
     ca->num_words = num_clauses / WORD_BITSIZE + 1;
     ca->data = malloc((size_t) (WORD_BITSIZE * ca->num_words));
+    ca->growable = false;
+    ca->touched_words = NULL;
+    ca->touched_count = 0;
+    ca->touched_capacity = 0;
     bit_vector_reset(ca);
     return ca;
 }
 
+bit_vector* bit_vector_init_growable() {
+    bit_vector* ca = bit_vector_init(-1, WORD_BITSIZE);
+    ca->growable = true;
+    ca->max = ca->num_words * WORD_BITSIZE;
+    ca->touched_capacity = 16;
+    ca->touched_words = malloc(sizeof(int) * (size_t) ca->touched_capacity);
+    return ca;
+}
+
+void bit_vector_free(bit_vector* ca) {
+    free(ca->data);
+    free(ca->touched_words);
+    free(ca);
+}
+
 void bit_vector_reset(bit_vector* ca) {
-    for (int i = 0; i < ca->num_words; i++) {
+    if (ca->growable && ca->touched_count < ca->num_words) {
+        for (int i = 0; i < ca->touched_count; i++) {
+            ca->data[ca->touched_words[i]] = 0;
+        }
+    } else {
+        for (int i = 0; i < ca->num_words; i++) {
+            ca->data[i] = 0;
+        }
+    }
+    ca->touched_count = 0;
+}
+
+static void bit_vector_grow(bit_vector* ca, int word_num) {
+    int num_words = ca->num_words;
+    while (num_words <= word_num) {
+        num_words *= 2;
+    }
+    ca->data = realloc(ca->data, sizeof(word) * (size_t) num_words);
+    for (int i = ca->num_words; i < num_words; i++) {
         ca->data[i] = 0;
     }
+    if (ca->touched_count >= ca->num_words) {
+        ca->touched_count = num_words; // words were skipped; keep clearing all of them on reset
+    }
+    ca->num_words = num_words;
+    ca->max = num_words * WORD_BITSIZE;
 }
 
 void bit_vector_add(bit_vector* ca, int t_lit) {
     int clause_id = t_lit - ca->offset;
     int word_num = clause_id / WORD_BITSIZE;
     int position = clause_id % WORD_BITSIZE;
+    if (ca->growable) {
+        if (word_num >= ca->num_words) {
+            bit_vector_grow(ca, word_num);
+        }
+        if (ca->data[word_num] == 0 && ca->touched_count < ca->num_words) {
+            if (ca->touched_count == ca->touched_capacity) {
+                ca->touched_capacity *= 2;
+                ca->touched_words = realloc(ca->touched_words, sizeof(int) * (size_t) ca->touched_capacity);
+            }
+            ca->touched_words[ca->touched_count++] = word_num;
+        }
+    }
     ca->data[word_num] |= ((word)1 << position);
 }
 
@@ -68,6 +128,10 @@ void bit_vector_remove(bit_vector* ca, int t_lit) {
     int clause_id = t_lit - ca->offset;
     int word_num = clause_id / WORD_BITSIZE;
     int position = clause_id % WORD_BITSIZE;
+    if (word_num >= ca->num_words) {
+        assert(ca->growable);
+        return;
+    }
     ca->data[word_num] &= ~((word)1 << position);
 }
 
@@ -75,9 +139,24 @@ bool bit_vector_contains(bit_vector* ca, int t_lit) {
     int clause_id = t_lit - ca->offset;
     int word_num = clause_id / WORD_BITSIZE;
     int position = clause_id % WORD_BITSIZE;
+    if (word_num >= ca->num_words) {
+        assert(ca->growable);
+        return false;
+    }
     return ca->data[word_num] & ((word)1 << position);
 }
 
+int bit_vector_index_of_var(void* var_id) {
+    assert((int64_t) var_id >= 0);
+    return (int) (int64_t) var_id;
+}
+
+int bit_vector_index_of_lit(void* lit) {
+    int64_t l = (int64_t) lit;
+    assert(l != 0);
+    return l > 0 ? (int) (2 * l) : (int) (- 2 * l + 1);
+}
+
 int clausal_abtraction_init_iteration(bit_vector* ca) {
     ca->iteration = 0;
     return bit_vector_next(ca);
@@ -33,11 +33,18 @@
 typedef struct bit_vector bit_vector;
 
 bit_vector* bit_vector_init(int num_variables, int num_clauses);
+bit_vector* bit_vector_init_growable(void); // indices start at 0 and the vector grows on demand; reset only clears the words touched since the last reset
+void bit_vector_free(bit_vector*);
 void bit_vector_reset(bit_vector*);
 void bit_vector_add(bit_vector*, int t_lit);
 void bit_vector_remove(bit_vector*, int t_lit);
 bool bit_vector_contains(bit_vector*, int t_lit);
 
+// Dense indices for membership structures (see worklist_init_dense and pqueue_init_dense)
+typedef int (*dense_index_function)(void*);
+int bit_vector_index_of_var(void* var_id);
+int bit_vector_index_of_lit(void* lit);
+
 // Iteration
 int bit_vector_init_iteration(bit_vector*);
 bool bit_vector_iterate(bit_vector*);
@@ -0,0 +1,235 @@
+//
+//  c2_assumptions.c
+//  cadet
+//
+//  Assumptions for incremental solving. Universal assumptions restrict the domain of the Skolem functions
+//  and are made on decision level 0 (see skolem_make_universal_assumption), because conflicts on decision
+//  level 0 refer to the whole domain. Changing them requires a fresh Skolem domain. Existential assumptions
+//  fix variables to constants on decision level 1, which then serves as the restart base. Learnt clauses
+//  contain the negations of the assumptions they depend on, so they stay valid when the assumptions change.
+//  Case splits are switched off while existential assumptions are active, and pure literals are switched off
+//  for calls with existential assumptions.
+//
+
+#include "cadet_internal.h"
+#include "log.h"
+
+#include <assert.h>
+
+/* Replaces the Skolem domain by a fresh one for the current universal assumptions. Learnt clauses and variable
+ * activities are kept, and so are the closed cases that still close in the new domain if keep_closed_cases is set.
+ * Called with the decision levels of the last call to c2_sat, which are dropped with the domain.
+ */
+static void c2_rebuild_skolem_domain(C2* c2, bool keep_closed_cases) {
+    assert(! c2_has_active_assumptions(c2));
+    c2->state = C2_READY;
+    c2_backtrack_to_decision_lvl(c2, 0);
+    c2->restart_base_decision_lvl = 0;
+    if (c2->skolem_outdated) {
+        // The examples lack the clauses added since the last call to c2_sat
+        examples_free(c2->examples);
+        c2->examples = examples_init(c2->qcnf, c2->options->examples_max_num);
+        c2->skolem_outdated = false;
+    }
+    c2_replenish_skolem_satsolver(c2, keep_closed_cases, c2->universal_assumptions);
+}
+
+void c2_assume(C2* c2, Lit lit) {
+    abortif(lit == 0 || ! qcnf_var_exists(c2->qcnf, lit_to_var(lit)), "Variable %u not known. Variables must be introduced through c2_new_var before they can be assumed.", lit_to_var(lit));
+    abortif(c2->options->functional_synthesis || c2->options->cegar_only, "Assumptions are not supported in functional synthesis and in CEGAR-only mode.");
+    if (c2->options->pure_literals && qcnf_is_existential(c2->qcnf, lit_to_var(lit))) {
+        // Pure literals are fixed on decision level 0, where they may contradict existential assumptions
+        V1("Existential assumptions switch off pure literal detection for this call.\n");
+        c2->pure_literals_suspended = true;
+        c2->enhanced_pure_literals_suspended = c2->options->enhanced_pure_literals;
+        c2->options->pure_literals = false;
+        c2->options->enhanced_pure_literals = false;
+        c2_retract_assumptions(c2);
+        c2_rebuild_skolem_domain(c2, false);
+    }
+    int_vector_add(c2->assumptions, lit);
+}
+
+bool c2_is_core(C2* c2, Lit lit) {
+    return int_vector_contains(c2->core, lit);
+}
+
+bool c2_has_active_assumptions(C2* c2) {
+    return int_vector_count(c2->active_assumptions) != 0;
+}
+
+// Called before the formula changes and before the next call to c2_sat. Results under existential assumptions do not carry over.
+void c2_retract_assumptions(C2* c2) {
+    if (! c2_has_active_assumptions(c2)) {
+        return;
+    }
+    V1("Retracting %u assumptions\n", int_vector_count(c2->active_assumptions));
+    c2->state = C2_READY;
+    c2_backtrack_to_decision_lvl(c2, c2->restart_base_decision_lvl);
+    int_vector_reset(c2->active_assumptions);
+    c2_backtrack_casesplit(c2); // back to decision level 0; may find that the formula is UNSAT
+}
+
+// Returns whether all elements of the sorted vector a occur in the sorted vector b
+static bool c2_is_subset(int_vector* a, int_vector* b) {
+    for (unsigned i = 0; i < int_vector_count(a); i++) {
+        if (! int_vector_contains_sorted(b, int_vector_get(a, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Sets up the universal assumptions of the next call on decision level 0. A result carries over if it
+ * holds under the new assumptions: UNSAT results for fewer universal assumptions, SAT results for more
+ * universal assumptions and no existential assumptions. Otherwise, and if closed cases (including CEGAR
+ * cubes) may violate existential assumptions, the Skolem domain is rebuilt. Clauses added since the last
+ * call (see c2_add_lit) preserve UNSAT results and otherwise also require a new Skolem domain.
+ */
+void c2_prepare_assumptions(C2* c2) {
+    assert(! c2_has_active_assumptions(c2));
+    assert(c2->skolem->decision_lvl == 0 || c2->state == C2_UNSAT || c2->skolem_outdated);
+    int_vector_reset(c2->core);
+
+    int_vector* universals = int_vector_init();
+    bool existentials = false;
+    bool contradicting = false;
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (qcnf_is_existential(c2->qcnf, lit_to_var(lit))) {
+            existentials = true;
+        } else if (! int_vector_contains(universals, lit)) {
+            contradicting = contradicting || int_vector_contains(universals, - lit);
+            int_vector_add(universals, lit);
+        }
+    }
+    int_vector_sort(universals, compare_integers_natural_order);
+
+    bool same_universals = int_vector_count(universals) == int_vector_count(c2->universal_assumptions)
+        && c2_is_subset(universals, c2->universal_assumptions);
+    bool keep = false;
+    if (c2->state == C2_UNSAT) {
+        keep = c2_is_subset(universals, c2->universal_assumptions);
+    } else if (c2->state == C2_SAT) {
+        keep = ! existentials && c2_is_subset(c2->universal_assumptions, universals);
+    } else {
+        keep = same_universals && (! existentials || vector_count(c2->cs->closed_cases) == 0);
+    }
+    if (keep && (c2->state == C2_UNSAT || ! c2->skolem_outdated)) {
+        int_vector_free(universals);
+        return;
+    }
+
+    // Closed cases are replayed in the new domain, which checks them against the clauses added since (see casesplits_replay_cases)
+    bool keep_closed_cases = same_universals && ! existentials;
+    V1("Rebuilding the Skolem domain for %u universal assumptions; %s %u closed cases.\n", int_vector_count(universals), keep_closed_cases ? "replaying" : "dropping", vector_count(c2->cs->closed_cases));
+    int_vector_free(c2->universal_assumptions);
+    c2->universal_assumptions = universals;
+    c2_rebuild_skolem_domain(c2, keep_closed_cases);
+    if (contradicting && c2->state == C2_READY) {
+        c2->state = C2_SAT; // no assignment to the universals satisfies the assumptions
+    }
+}
+
+// Makes the existential assumptions on decision level 1. May bring c2 into state C2_SKOLEM_CONFLICT or C2_UNSAT.
+void c2_push_assumptions(C2* c2) {
+    assert(c2->state == C2_READY);
+    assert(c2->skolem->decision_lvl == 0);
+    assert(c2->restart_base_decision_lvl == 0);
+    for (unsigned i = 0; i < int_vector_count(c2->assumptions); i++) {
+        Lit lit = int_vector_get(c2->assumptions, i);
+        if (qcnf_is_existential(c2->qcnf, lit_to_var(lit))) {
+            int_vector_add(c2->active_assumptions, lit);
+        }
+    }
+    if (! c2_has_active_assumptions(c2)) {
+        return;
+    }
+
+    V1("Assuming %u existential literals\n", int_vector_count(c2->active_assumptions));
+    skolem_push(c2->skolem);
+    examples_push(c2->examples);
+    skolem_increase_decision_lvl(c2->skolem);
+    c2->restart_base_decision_lvl = 1;
+
+    for (unsigned i = 0; i < int_vector_count(c2->active_assumptions); i++) {
+        Lit lit = int_vector_get(c2->active_assumptions, i);
+        int val = skolem_get_constant_value(c2->skolem, lit);
+        if (val == -1) {
+            V1("Existential assumption %d contradicts a constant.\n", lit);
+            if (skolem_get_dlvl_for_constant(c2->skolem, lit_to_var(lit)) == 0) {
+                int_vector_add(c2->core, lit);
+            } // otherwise the constant follows from other assumptions; see c2_conclude_assumptions
+            c2->state = C2_UNSAT;
+            return;
+        }
+        if (val == 0 && skolem_is_deterministic(c2->skolem, lit_to_var(lit))) {
+            // The Skolem function of the variable is fixed already; it must not be reassigned as a constant
+            if (skolem_can_take_value(c2->skolem, - lit)) {
+                V1("Existential assumption %d contradicts a Skolem function.\n", lit);
+                if (skolem_get_decision_lvl(c2->skolem, lit_to_var(lit)) == 0) {
+                    int_vector_add(c2->core, lit);
+                } // otherwise the function depends on other assumptions; see c2_conclude_assumptions
+                c2->state = C2_UNSAT;
+                return;
+            }
+            continue;
+        }
+        if (val == 0) {
+            skolem_assign_constant_value(c2->skolem, lit, skolem_create_fresh_empty_dep(c2->skolem), NULL);
+        }
+        if (! skolem_is_conflicted(c2->skolem)) {
+            skolem_propagate(c2->skolem);
+        }
+        if (skolem_is_conflicted(c2->skolem)) {
+            c2->state = C2_SKOLEM_CONFLICT; // conflict analysis derives a clause over the negated assumptions
+            return;
+        }
+    }
+}
+
+/* Called for conflicts that involve no decisions. If the conflicting assignment (see analyze_conflict) consists
+ * of assumptions and of values from decision level 0, the existential assumptions in it form the core.
+ * Otherwise it contains consequences of the assumptions and the core is left to c2_conclude_assumptions.
+ */
+void c2_assumptions_refuted(C2* c2, int_vector* conflicting_assignment) {
+    assert(c2_has_active_assumptions(c2));
+    int_vector_reset(c2->core);
+    for (unsigned i = 0; i < int_vector_count(conflicting_assignment); i++) {
+        Lit lit = int_vector_get(conflicting_assignment, i);
+        unsigned var_id = lit_to_var(lit);
+        if (qcnf_is_existential(c2->qcnf, var_id)
+            && ! int_vector_contains(c2->active_assumptions, lit)
+            && (! skolem_is_deterministic(c2->skolem, var_id) || skolem_get_decision_lvl_for_conflict_analysis(c2->skolem, var_id) != 0)) {
+            return;
+        }
+    }
+    for (unsigned i = 0; i < int_vector_count(c2->active_assumptions); i++) {
+        Lit lit = int_vector_get(c2->active_assumptions, i);
+        if (int_vector_contains(conflicting_assignment, lit) && ! int_vector_contains(c2->core, lit)) {
+            int_vector_add(c2->core, lit);
+        }
+    }
+    if (int_vector_count(c2->core) == 0) {
+        int_vector_add(c2->core, 0); // the assumptions were not needed; marks the core as determined
+    }
+}
+
+/* Determines the core of the result: the universal assumptions for SAT results, and for UNSAT results
+ * the existential assumptions in the conflict that refuted them (see c2_assumptions_refuted). Where the
+ * solver cannot tell which existential assumptions were needed, all of them go into the core.
+ */
+void c2_conclude_assumptions(C2* c2) {
+    int_vector_reset(c2->assumptions);
+    if (c2->pure_literals_suspended) {
+        // The Skolem domain keeps its decision level 0; c2_assume rebuilds it before pure literals could contradict existential assumptions
+        c2->options->pure_literals = true;
+        c2->options->enhanced_pure_literals = c2->enhanced_pure_literals_suspended;
+        c2->pure_literals_suspended = false;
+    }
+    if (c2->state == C2_SAT) {
+        int_vector_add_all(c2->core, c2->universal_assumptions);
+    } else if (c2->state == C2_UNSAT && int_vector_count(c2->core) == 0) {
+        int_vector_add_all(c2->core, c2->active_assumptions);
+    }
+}
@@ -12,6 +12,11 @@
 #include "mersenne_twister.h"
 
 #include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Parallel probing only pays off for the cost of the snapshots if each thread probes enough candidates
+#define C2_PARALLEL_PROBING_MIN_CANDIDATES_PER_THREAD 16
 
 // Returns if last assumption was vacuous
 void c2_backtrack_casesplit(C2* c2) {
@@ -19,9 +24,10 @@ void c2_backtrack_casesplit(C2* c2) {
     
     assert(c2->skolem->decision_lvl == c2->restart_base_decision_lvl);
     
-    c2_backtrack_to_decision_lvl(c2, 0);
-    c2->restart_base_decision_lvl = 0;
-    assert(c2->skolem->decision_lvl == 0);
+    unsigned base_lvl = c2_has_active_assumptions(c2) ? 1 : 0; // the assumptions stay on decision level 1
+    c2_backtrack_to_decision_lvl(c2, base_lvl);
+    c2->restart_base_decision_lvl = base_lvl;
+    assert(c2->skolem->decision_lvl == base_lvl);
 //    assert(int_vector_count(c2->skolem->universals_assumptions) == 0); // not true in case of AIGer style unremovable assumptions.
     
     // Check learnt clauses for unique consequences ... the last backtracking may have removed the unique consequences
@@ -46,49 +52,234 @@ void c2_backtrack_casesplit(C2* c2) {
     c2->restarts_since_last_major = 0;
 }
 
-// Returns the number of propagations for this assumption
-unsigned c2_case_split_probe(C2* c2, Lit lit) {
-    assert(!skolem_can_propagate(c2->skolem));
-    statistics_start_timer(c2->statistics.failed_literals_stats);
-
-    debug_verbosity -= 1;
+// Returns UINT_MAX if the assumption leads to a conflict, and otherwise the number of variables it makes deterministic
+static unsigned casesplits_probe_on(Skolem* s, Lit lit) {
+    assert(!skolem_can_propagate(s));
     
-//    size_t case_split_decision_metric = c2->skolem->statistics.propagations;
-    size_t case_split_decision_metric = int_vector_count(c2->skolem->determinization_order);
-    skolem_push(c2->skolem);
-    skolem_make_universal_assumption(c2->skolem, lit);
+//    size_t case_split_decision_metric = s->statistics.propagations;
+    size_t case_split_decision_metric = int_vector_count(s->determinization_order);
+    skolem_push(s);
+    skolem_make_universal_assumption(s, lit);
     
-//    if (satsolver_sat(c2->skolem->skolem) == SATSOLVER_RESULT_UNSAT) {
-//        V1("Skolem conflict with assumed constant %d: %d\n", lit, c2->skolem->conflict_var_id);
+//    if (satsolver_sat(s->skolem) == SATSOLVER_RESULT_UNSAT) {
+//        V1("Skolem conflict with assumed constant %d: %d\n", lit, s->conflict_var_id);
 //        case_split_decision_metric = UINT_MAX;
 //    } else {
-        assert(!c2->skolem->ignore_universal_conflicts);
-        c2->skolem->ignore_universal_conflicts = true;
-        skolem_propagate(c2->skolem);
-        c2->skolem->ignore_universal_conflicts = false;
+        assert(!s->ignore_universal_conflicts);
+        s->ignore_universal_conflicts = true;
+        skolem_propagate(s);
+        s->ignore_universal_conflicts = false;
         
-        if (skolem_is_conflicted(c2->skolem)) {
-            V2("Skolem conflict with assumed constant %d: %d\n", lit, c2->skolem->conflict_var_id);
-            c2->statistics.failed_literals_conflicts++;
+        if (skolem_is_conflicted(s)) {
+            V2("Skolem conflict with assumed constant %d: %d\n", lit, s->conflict_var_id);
             case_split_decision_metric = UINT_MAX; //ensure the variable is chosen
         } else {
-            V2("Number of propagations when assigning %d: %zu\n", lit, c2->skolem->statistics.propagations - case_split_decision_metric);
-            case_split_decision_metric = int_vector_count(c2->skolem->determinization_order) - case_split_decision_metric;
+            V2("Number of propagations when assigning %d: %zu\n", lit, s->statistics.propagations - case_split_decision_metric);
+            case_split_decision_metric = int_vector_count(s->determinization_order) - case_split_decision_metric;
         }
 //    }
 
-    skolem_pop(c2->skolem);
-    statistics_stop_and_record_timer(c2->statistics.failed_literals_stats);
+    skolem_pop(s);
+    return (unsigned) case_split_decision_metric;
+}
 
+// Returns the number of propagations for this assumption
+unsigned c2_case_split_probe(C2* c2, Lit lit) {
+    statistics_start_timer(c2->statistics.failed_literals_stats);
+    debug_verbosity -= 1;
+    
+    unsigned case_split_decision_metric = casesplits_probe_on(c2->skolem, lit);
+    if (case_split_decision_metric == UINT_MAX) {
+        c2->statistics.failed_literals_conflicts++;
+    }
+    
+    statistics_stop_and_record_timer(c2->statistics.failed_literals_stats);
     debug_verbosity += 1;
     
-    return (unsigned) case_split_decision_metric;
+    return case_split_decision_metric;
+}
+
+// Parallel probing: each thread probes a contiguous block of the candidates on its own snapshot of the Skolem domain
+struct c2_probe_snapshot {
+    QCNF* qcnf; // copy of c2->qcnf, extended by the clauses added to c2->qcnf since
+    Skolem* skolem; // NULL until the first pick of the thread
+    Casesplits* cs; // holds the satlits for the closed cases of c2->cs encoded in skolem
+    unsigned clauses; // clauses of c2->qcnf copied into qcnf; clause indices of c2->qcnf never change
+    unsigned cases; // closed cases of c2->cs encoded in skolem
+};
+
+typedef struct {
+    C2* c2; // only read while the probe threads run
+    struct c2_probe_snapshot* snapshot; // owned by the thread while it runs
+    int_vector* candidates;
+    unsigned begin;
+    unsigned end;
+    unsigned* propagations_pos; // indexed like candidates; each thread writes only to its own block
+    unsigned* propagations_neg;
+    atomic_uint* first_failed; // smallest index of a candidate with a failed literal found so far
+    bool snapshot_conflicted;
+    size_t failed_literals;
+} c2_probe_worker;
+
+static void c2_probe_snapshot_clear(struct c2_probe_snapshot* snap) {
+    if (snap->skolem) {
+        casesplits_free(snap->cs);
+        skolem_free(snap->skolem);
+        snap->skolem = NULL;
+    }
+    if (snap->qcnf) {
+        qcnf_free(snap->qcnf);
+        snap->qcnf = NULL;
+    }
+}
+
+void c2_free_probe_snapshots(C2* c2) {
+    if (c2->probe_snapshots == NULL) {
+        return;
+    }
+    for (unsigned t = 0; t < c2->options->casesplits_probe_threads; t++) {
+        c2_probe_snapshot_clear(&c2->probe_snapshots[t]);
+    }
+    free(c2->probe_snapshots);
+    c2->probe_snapshots = NULL;
+}
+
+/* Brings the snapshot up to date with c2 at the base decision level of the current case split. The snapshot
+ * backtracks to dlvl 0, where it adds the clauses and encodes the closed cases (see casesplits_encode_case_copy)
+ * that c2 gained since the last pick. Then the universal assumptions of the case splits are assumed as in
+ * c2->skolem. Only the first pick after the snapshot was copied from the formula recomputes dlvl 0.
+ */
+static Skolem* c2_probe_snapshot_update(C2* c2, struct c2_probe_snapshot* snap) {
+    Skolem* s = snap->skolem;
+    if (s == NULL) {
+        s = skolem_init_with_universal_assumptions(snap->qcnf, c2->options, c2->universal_assumptions);
+        snap->skolem = s;
+        snap->cs = casesplits_init(snap->qcnf);
+        snap->cs->skolem = s;
+    }
+    while (s->decision_lvl > 0) {
+        skolem_pop(s);
+    }
+    for (unsigned i = snap->clauses; i < vector_count(c2->qcnf->all_clauses) && ! skolem_is_conflicted(s); i++) {
+        Clause* c = vector_get(c2->qcnf->all_clauses, i);
+        if (c == NULL || ! c->active) {
+            continue;
+        }
+        for (unsigned j = 0; j < c->size; j++) {
+            qcnf_add_lit(snap->qcnf, c->occs[j]);
+        }
+        Clause* new = qcnf_close_clause(snap->qcnf);
+        if (new) {
+            new->original = c->original;
+            new->consistent_with_originals = c->consistent_with_originals;
+            new->is_cube = c->is_cube;
+            skolem_new_clause(s, new);
+        }
+    }
+    snap->clauses = vector_count(c2->qcnf->all_clauses);
+    skolem_propagate(s);
+    for (unsigned i = snap->cases; i < vector_count(c2->cs->closed_cases) && ! skolem_is_conflicted(s); i++) {
+        casesplits_encode_case_copy(snap->cs, (Case*) vector_get(c2->cs->closed_cases, i)); // skipped cases only weaken the metrics
+    }
+    snap->cases = vector_count(c2->cs->closed_cases);
+    // The universal assumptions on decision level 0 are part of the snapshot since its initialization
+    for (unsigned i = int_vector_count(c2->universal_assumptions); i < int_vector_count(c2->skolem->universals_assumptions) && ! skolem_is_conflicted(s); i++) {
+        skolem_push(s);
+        skolem_increase_decision_lvl(s);
+        skolem_make_universal_assumption(s, int_vector_get(c2->skolem->universals_assumptions, i));
+        skolem_propagate(s);
+    }
+    return s;
+}
+
+static void* c2_probe_run_worker(void* arg) {
+    c2_probe_worker* w = (c2_probe_worker*) arg;
+    log_silent = true;
+    Skolem* s = c2_probe_snapshot_update(w->c2, w->snapshot);
+    w->snapshot_conflicted = skolem_is_conflicted(s);
+    for (unsigned i = w->begin; i < w->end && ! w->snapshot_conflicted; i++) {
+        if (i > atomic_load_explicit(w->first_failed, memory_order_relaxed)) {
+            break; // a candidate that comes earlier has a failed literal already
+        }
+        Lit lit = int_vector_get(w->candidates, i);
+        w->propagations_pos[i] = casesplits_probe_on(s,   lit);
+        w->propagations_neg[i] = casesplits_probe_on(s, - lit);
+        if (w->propagations_pos[i] == UINT_MAX || w->propagations_neg[i] == UINT_MAX) {
+            w->failed_literals += 1;
+            unsigned current = atomic_load(w->first_failed);
+            while (i < current && ! atomic_compare_exchange_weak(w->first_failed, &current, i)) {}
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* Probes both polarities of all candidates on threads. Returns false if a snapshot is conflicted;
+ * the caller then probes sequentially. The results are the same as probing sequentially in the order
+ * of the candidates and stopping at the first failed literal: all candidates up to the first failed
+ * literal are probed, and later candidates are ignored by c2_case_split_pick_literal.
+ */
+static bool c2_case_split_probe_parallel(C2* c2, int_vector* candidates, unsigned* propagations_pos, unsigned* propagations_neg) {
+    unsigned threads = c2->options->casesplits_probe_threads;
+    unsigned count = int_vector_count(candidates);
+    assert(threads > 1 && count >= threads);
+    statistics_start_timer(c2->statistics.failed_literals_stats);
+    
+    if (c2->probe_snapshots == NULL) {
+        c2->probe_snapshots = calloc(threads, sizeof(struct c2_probe_snapshot));
+    }
+    atomic_uint first_failed;
+    atomic_init(&first_failed, UINT_MAX);
+    c2_probe_worker* workers = malloc(sizeof(c2_probe_worker) * threads);
+    for (unsigned t = 0; t < threads; t++) {
+        struct c2_probe_snapshot* snap = &c2->probe_snapshots[t];
+        if (snap->qcnf && var_vector_count(snap->qcnf->vars) != var_vector_count(c2->qcnf->vars)) {
+            c2_probe_snapshot_clear(snap); // variables were introduced since the last pick
+        }
+        if (snap->qcnf == NULL) {
+            // Copies are made before the threads start, as clause iterators may reorganize the original formula
+            snap->qcnf = qcnf_copy(c2->qcnf);
+            snap->clauses = vector_count(c2->qcnf->all_clauses);
+            snap->cases = 0;
+        }
+        c2_probe_worker* w = &workers[t];
+        w->c2 = c2;
+        w->snapshot = snap;
+        w->candidates = candidates;
+        w->begin = (unsigned) ((size_t) count * t / threads);
+        w->end = (unsigned) ((size_t) count * (t + 1) / threads);
+        w->propagations_pos = propagations_pos;
+        w->propagations_neg = propagations_neg;
+        w->first_failed = &first_failed;
+        w->snapshot_conflicted = false;
+        w->failed_literals = 0;
+    }
+    pthread_t* thread_ids = malloc(sizeof(pthread_t) * threads);
+    for (unsigned t = 0; t < threads; t++) {
+        abortif(pthread_create(&thread_ids[t], NULL, c2_probe_run_worker, &workers[t]) != 0,
+                "Could not create thread for parallel probing.");
+    }
+    bool snapshot_conflicted = false;
+    for (unsigned t = 0; t < threads; t++) {
+        pthread_join(thread_ids[t], NULL);
+        snapshot_conflicted = snapshot_conflicted || workers[t].snapshot_conflicted;
+        c2->statistics.failed_literals_conflicts += workers[t].failed_literals;
+        if (workers[t].snapshot_conflicted && c2->probe_snapshots[t].skolem->decision_lvl == 0) {
+            c2_probe_snapshot_clear(&c2->probe_snapshots[t]); // backtracking does not resolve the conflict
+        }
+    }
+    free(thread_ids);
+    free(workers);
+    
+    statistics_stop_and_record_timer(c2->statistics.failed_literals_stats);
+    if (snapshot_conflicted) {
+        V1("Snapshot for parallel probing is conflicted; probing sequentially.\n");
+    }
+    return ! snapshot_conflicted;
 }
 
 Lit c2_case_split_pick_literal(C2* c2) {
-    float max_total = 0.0;
-    float cost_factor_of_max = 0.0;
-    Lit lit = 0;
+    int_vector* candidates = int_vector_init();
     for (unsigned i = 1; i < int_vector_count(c2->cs->interface_vars); i++) {
         unsigned var_id = (unsigned) int_vector_get(c2->cs->interface_vars, i);
         assert(int_vector_get(c2->cs->interface_vars, i) > 0);
@@ -99,33 +290,55 @@ Lit c2_case_split_pick_literal(C2* c2) {
         if (var_id != 0
             && skolem_is_deterministic(c2->skolem, var_id)
             && skolem_get_constant_value(c2->skolem, (Lit) v->var_id) == 0) {
-            
-            unsigned propagations_pos = c2_case_split_probe(c2,   (Lit) v->var_id);
-            unsigned propagations_neg = c2_case_split_probe(c2, - (Lit) v->var_id);
-            
-            if (propagations_pos == UINT_MAX || propagations_neg == UINT_MAX) {
-                // we found a failed literal
-                max_total = 0;
-                lit = (propagations_pos > propagations_neg ? 1 : - 1) * (Lit) v->var_id;
-                break;
-            }
-            
-            assert(propagations_pos < 1000000 && propagations_neg < 1000000); // avoid overflows
-            
-            float cost_factor = (float) 1 + (float) 2.0 * /*sqrtf*/(casesplits_get_interface_activity(c2->cs, v->var_id));
-            
-            float combined_factor =
-                ((float) 1.0
-                    + (float) c2_get_activity(c2, v->var_id))
-                * cost_factor;
-            float combined_quality = combined_factor * (float) (propagations_pos * propagations_neg + propagations_pos + propagations_neg + 1);
-            if (combined_quality > max_total) {
-                lit = (propagations_pos > propagations_neg ? 1 : - 1) * (Lit) v->var_id;
-                max_total = combined_quality;
-                cost_factor_of_max = cost_factor;
-            }
+            int_vector_add(candidates, (int) var_id);
+        }
+    }
+    
+    unsigned count = int_vector_count(candidates);
+    unsigned* propagations_pos = malloc(sizeof(unsigned) * (count + 1));
+    unsigned* propagations_neg = malloc(sizeof(unsigned) * (count + 1));
+    bool probed = c2->options->casesplits_probe_threads > 1
+        && count >= C2_PARALLEL_PROBING_MIN_CANDIDATES_PER_THREAD * c2->options->casesplits_probe_threads
+        && c2_case_split_probe_parallel(c2, candidates, propagations_pos, propagations_neg);
+    
+    float max_total = 0.0;
+    float cost_factor_of_max = 0.0;
+    Lit lit = 0;
+    for (unsigned i = 0; i < count; i++) {
+        unsigned var_id = (unsigned) int_vector_get(candidates, i);
+        if (! probed) {
+            propagations_pos[i] = c2_case_split_probe(c2,   (Lit) var_id);
+            propagations_neg[i] = c2_case_split_probe(c2, - (Lit) var_id);
+        }
+        unsigned pos = propagations_pos[i];
+        unsigned neg = propagations_neg[i];
+        
+        if (pos == UINT_MAX || neg == UINT_MAX) {
+            // we found a failed literal
+            max_total = 0;
+            lit = (pos > neg ? 1 : - 1) * (Lit) var_id;
+            break;
+        }
+        
+        assert(pos < 1000000 && neg < 1000000); // avoid overflows
+        
+        float cost_factor = (float) 1 + (float) 2.0 * /*sqrtf*/(casesplits_get_interface_activity(c2->cs, var_id));
+        
+        float combined_factor =
+            ((float) 1.0
+                + (float) c2_get_activity(c2, var_id))
+            * cost_factor;
+        float combined_quality = combined_factor * (float) (pos * neg + pos + neg + 1);
+        if (combined_quality > max_total) {
+            lit = (pos > neg ? 1 : - 1) * (Lit) var_id;
+            max_total = combined_quality;
+            cost_factor_of_max = cost_factor;
         }
     }
+    free(propagations_pos);
+    free(propagations_neg);
+    int_vector_free(candidates);
+    
     if (lit != 0 && debug_verbosity >= VERBOSITY_MEDIUM) {
         V1("Case split literal ");
         c2_print_colored_literal_name(c2, c2_literal_color(c2, NULL, lit), lit);
@@ -190,6 +403,7 @@ bool c2_make_universal_assumption_unless_vacuous(C2* c2, Lit lit) {
 
 bool c2_casesplits_assume_single_lit(C2* c2) {
     if (! c2->options->casesplits
+        || c2_has_active_assumptions(c2)
         || c2->restarts < c2->magic.num_restarts_before_case_splits
         || c2->conflicts_between_case_splits_countdown > 0
         || c2->skolem->decision_lvl != c2->restart_base_decision_lvl) {
@@ -311,7 +525,11 @@ void c2_close_case(C2* c2) {
     int_vector* universal_assumptions = NULL;
     if (completed_casesplit) {
         determinization_order = case_splits_determinization_order_with_polarities(c2->skolem);
-        universal_assumptions = int_vector_copy(c2->skolem->universals_assumptions);
+        universal_assumptions = int_vector_init();
+        // The universal assumptions on decision level 0 restrict the domain for good (see c2_prepare_assumptions)
+        for (unsigned i = int_vector_count(c2->universal_assumptions); i < int_vector_count(c2->skolem->universals_assumptions); i++) {
+            int_vector_add(universal_assumptions, int_vector_get(c2->skolem->universals_assumptions, i));
+        }
     }
     c2_backtrack_to_decision_lvl(c2, c2->restart_base_decision_lvl);
     assert(c2->skolem->decision_lvl == c2->restart_base_decision_lvl);
@@ -320,7 +538,8 @@ void c2_close_case(C2* c2) {
         return;
     }
     if (completed_casesplit) {
-        casesplits_encode_closed_case(c2->cs, determinization_order, universal_assumptions);
+        bool replayed = casesplits_encode_closed_case(c2->cs, determinization_order, universal_assumptions);
+        abortif(! replayed, "Replay of the closed case failed.");
         
 //        // now turn last case split into a clause .. DEACTIVATED due to mysterious drop in performance
 //        Case* last_case = vector_get(c2->cs->closed_cases, vector_count(c2->cs->closed_cases) - 1);
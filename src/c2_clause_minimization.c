@@ -93,6 +93,10 @@ Clause* c2_minimize_clause(C2* c2, Clause* c) {
         if (new_clause) {
             new_clause->original = 0;
             new_clause->minimized = 1;
+            unsigned lbd = conflict_analysis_get_lbd(c2->ca, c);
+            if (lbd != 0) { // minimized learnt clauses remain deletable
+                conflict_analysis_set_lbd(c2->ca, new_clause, lbd < new_clause->size ? lbd : new_clause->size);
+            }
             c2_rl_new_clause(new_clause);
             assert(c->size - int_vector_count(to_remove) == new_clause->size);
             V2("Conflict clause minimization removed %u of %u literals.\n", int_vector_count(to_remove), initial_size);
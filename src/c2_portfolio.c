@@ -0,0 +1,245 @@
+//
+//  c2_portfolio.c
+//  cadet
+//
+//  Each worker owns a copy of the formula, its own options, and its own C2 instance. The logging
+//  globals, the random number generator, and the reinforcement learning traces are thread-local,
+//  so the workers share no mutable state except the index of the winner and the clause exchange.
+//
+
+#include "c2_portfolio.h"
+#include "log.h"
+#include "util.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <assert.h>
+
+#define C2_CLAUSE_EXCHANGE_SLOTS 4096
+
+/* Slot of the clause exchange, protected by a sequence number: the sequence number is odd while a
+ * thread writes to the slot, and 2 * (position + 1) once the clause at that position is published.
+ * Readers copy the slot and discard the copy if the sequence number changed in the meantime.
+ */
+typedef struct {
+    atomic_size_t sequence;
+    atomic_uint size;
+    atomic_uint lbd;
+    atomic_uint source; // index of the exporting worker
+    atomic_int lits[C2_PORTFOLIO_MAX_SHARED_CLAUSE_SIZE];
+} c2_clause_exchange_slot;
+
+// Lock-free ring buffer of learnt clauses; older clauses are overwritten when the buffer wraps around
+typedef struct {
+    atomic_size_t head; // position of the next clause to be exported
+    c2_clause_exchange_slot slots[C2_CLAUSE_EXCHANGE_SLOTS];
+} c2_clause_exchange;
+
+typedef struct {
+    atomic_int winner; // index of the first worker that reached a result; -1 while solving
+    c2_clause_exchange exchange;
+} c2_portfolio;
+
+struct c2_portfolio_worker {
+    unsigned index;
+    QCNF* qcnf; // copy of the formula; ownership passes to the worker's C2
+    Options* options;
+    C2* c2;
+    cadet_res result;
+    c2_portfolio* portfolio;
+    size_t import_position; // position in the clause exchange up to which clauses were imported
+};
+typedef struct c2_portfolio_worker c2_portfolio_worker;
+
+static void c2_portfolio_diversify(Options* o, unsigned index) {
+    if (index == 0) {
+        return; // the configuration chosen by the user
+    }
+    o->seed += index;
+    bool engine_variants = ! o->functional_synthesis && ! o->cegar_only; // case splits are not supported in functional synthesis
+    switch ((index - 1) % 6) {
+        case 0:
+            if (engine_variants) {o->cegar = ! o->cegar;}
+            break;
+        case 1:
+            if (engine_variants) {o->casesplits = ! o->casesplits;}
+            break;
+        case 2:
+            o->minimize_learnt_clauses = ! o->minimize_learnt_clauses;
+            break;
+        case 3:
+            o->pure_literals = ! o->pure_literals;
+            o->enhanced_pure_literals = o->enhanced_pure_literals && o->pure_literals;
+            break;
+        case 4:
+            o->random_decisions = true;
+            break;
+        case 5:
+            if (engine_variants) {o->cegar = ! o->cegar;}
+            o->minimize_learnt_clauses = ! o->minimize_learnt_clauses;
+            break;
+    }
+}
+
+static int c2_portfolio_terminate(void* state) {
+    c2_portfolio* p = (c2_portfolio*) state;
+    return atomic_load(&p->winner) >= 0;
+}
+
+static void* c2_portfolio_run_worker(void* arg) {
+    c2_portfolio_worker* w = (c2_portfolio_worker*) arg;
+    log_silent = true; // only the winner's result is printed, by the calling thread
+    w->c2 = c2_init_qcnf(w->qcnf, w->options);
+    w->c2->portfolio_worker = w;
+    c2_set_terminate(w->c2, w->portfolio, c2_portfolio_terminate);
+    w->result = c2_sat(w->c2);
+    if (w->result != CADET_RESULT_UNKNOWN) {
+        int none = -1;
+        atomic_compare_exchange_strong(&w->portfolio->winner, &none, (int) w->index);
+    }
+    return NULL;
+}
+
+C2* c2_portfolio_solve(C2* c2, unsigned threads) {
+    assert(threads > 0);
+    V1("Portfolio of %u configurations\n", threads);
+    c2_portfolio* p = malloc(sizeof(c2_portfolio)); // too large for the stack
+    atomic_init(&p->winner, -1);
+    atomic_init(&p->exchange.head, 0);
+    for (unsigned i = 0; i < C2_CLAUSE_EXCHANGE_SLOTS; i++) {
+        atomic_init(&p->exchange.slots[i].sequence, 0);
+    }
+
+    // Copies are made before the threads start, as clause iterators may reorganize the original formula
+    c2_portfolio_worker* workers = malloc(sizeof(c2_portfolio_worker) * threads);
+    for (unsigned i = 0; i < threads; i++) {
+        c2_portfolio_worker* w = &workers[i];
+        w->index = i;
+        w->qcnf = qcnf_copy(c2->qcnf);
+        w->options = malloc(sizeof(Options));
+        *w->options = *c2->options;
+        c2_portfolio_diversify(w->options, i);
+        w->c2 = NULL;
+        w->result = CADET_RESULT_UNKNOWN;
+        w->portfolio = p;
+        w->import_position = 0;
+    }
+
+    pthread_t* thread_ids = malloc(sizeof(pthread_t) * threads);
+    for (unsigned i = 0; i < threads; i++) {
+        abortif(pthread_create(&thread_ids[i], NULL, c2_portfolio_run_worker, &workers[i]) != 0,
+                "Could not create thread for portfolio configuration %u.", i);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        pthread_join(thread_ids[i], NULL);
+    }
+    free(thread_ids);
+
+    int winner = atomic_load(&p->winner);
+    unsigned result_idx = winner >= 0 ? (unsigned) winner : 0;
+    if (winner >= 0) {
+        V1("Portfolio configuration %u finished first (seed %lu, cegar %d, case splits %d, minimize %d, pure literals %d, random decisions %d)\n",
+           result_idx,
+           workers[result_idx].options->seed,
+           workers[result_idx].options->cegar,
+           workers[result_idx].options->casesplits,
+           workers[result_idx].options->minimize_learnt_clauses,
+           workers[result_idx].options->pure_literals,
+           workers[result_idx].options->random_decisions);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers[i].c2->portfolio_worker = NULL;
+        if (i != result_idx) {
+            c2_portfolio_free(workers[i].c2);
+        }
+    }
+    C2* result = workers[result_idx].c2;
+    free(workers);
+    free(p);
+    return result;
+}
+
+void c2_portfolio_export_clause(C2* c2, Clause* c) {
+    c2_portfolio_worker* w = c2->portfolio_worker;
+    if (w == NULL || c->size > C2_PORTFOLIO_MAX_SHARED_CLAUSE_SIZE || ! qcnf_is_learnt_clause(c)) {
+        return;
+    }
+    for (unsigned i = 0; i < c->size; i++) {
+        if (! qcnf_is_original(c2->qcnf, lit_to_var(c->occs[i]))) {
+            return; // the other workers may not know the variable
+        }
+    }
+    c2_clause_exchange* e = &w->portfolio->exchange;
+    size_t position = atomic_fetch_add(&e->head, 1);
+    c2_clause_exchange_slot* slot = &e->slots[position % C2_CLAUSE_EXCHANGE_SLOTS];
+    size_t sequence = atomic_load(&slot->sequence);
+    if (sequence % 2 == 1 || ! atomic_compare_exchange_strong(&slot->sequence, &sequence, sequence + 1)) {
+        return; // another thread writes to this slot; sharing is best effort, so the clause is dropped
+    }
+    unsigned lbd = conflict_analysis_get_lbd(c2->ca, c);
+    atomic_store_explicit(&slot->size, c->size, memory_order_relaxed);
+    atomic_store_explicit(&slot->lbd, lbd != 0 ? lbd : c->size, memory_order_relaxed);
+    atomic_store_explicit(&slot->source, w->index, memory_order_relaxed);
+    for (unsigned i = 0; i < c->size; i++) {
+        atomic_store_explicit(&slot->lits[i], c->occs[i], memory_order_relaxed);
+    }
+    atomic_store_explicit(&slot->sequence, 2 * (position + 1), memory_order_release);
+    c2->statistics.exported_clauses += 1;
+}
+
+void c2_portfolio_import_clauses(C2* c2) {
+    c2_portfolio_worker* w = c2->portfolio_worker;
+    if (w == NULL || c2->skolem->decision_lvl != 0) {
+        return;
+    }
+    if (c2->statistics.cases_closed > 0 || int_vector_count(c2->skolem->universals_assumptions) > int_vector_count(c2->universal_assumptions)) {
+        return; // closed cases are replayed on the clauses known when they were opened (see c2_close_case)
+    }
+    c2_clause_exchange* e = &w->portfolio->exchange;
+    size_t head = atomic_load(&e->head);
+    if (head - w->import_position > C2_CLAUSE_EXCHANGE_SLOTS) {
+        w->import_position = head - C2_CLAUSE_EXCHANGE_SLOTS; // older clauses were overwritten already
+    }
+    Lit lits[C2_PORTFOLIO_MAX_SHARED_CLAUSE_SIZE];
+    for (; w->import_position < head; w->import_position++) {
+        if (c2->state != C2_READY || examples_is_conflicted(c2->examples)) {
+            return;
+        }
+        size_t position = w->import_position;
+        c2_clause_exchange_slot* slot = &e->slots[position % C2_CLAUSE_EXCHANGE_SLOTS];
+        size_t sequence = 2 * (position + 1);
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != sequence) {
+            continue; // not yet published, overwritten, or dropped
+        }
+        unsigned size = atomic_load_explicit(&slot->size, memory_order_relaxed);
+        unsigned lbd = atomic_load_explicit(&slot->lbd, memory_order_relaxed);
+        unsigned source = atomic_load_explicit(&slot->source, memory_order_relaxed);
+        size = size < C2_PORTFOLIO_MAX_SHARED_CLAUSE_SIZE ? size : C2_PORTFOLIO_MAX_SHARED_CLAUSE_SIZE;
+        for (unsigned i = 0; i < size; i++) {
+            lits[i] = atomic_load_explicit(&slot->lits[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) != sequence || source == w->index) {
+            continue;
+        }
+        
+        for (unsigned i = 0; i < size; i++) {
+            qcnf_add_lit(c2->qcnf, lits[i]);
+        }
+        Clause* c = qcnf_close_clause(c2->qcnf);
+        if (c == NULL) {
+            continue; // duplicate
+        }
+        c->original = 0;
+        conflict_analysis_set_lbd(c2->ca, c, lbd);
+        c2_new_clause(c2, c); // registers unique consequences; can bring c2->state in C2_UNSAT
+        c2->statistics.added_clauses += 1;
+        c2->statistics.imported_clauses += 1;
+    }
+}
+
+void c2_portfolio_free(C2* c2) {
+    Options* o = c2->options;
+    c2_free(c2);
+    options_free(o);
+}
@@ -0,0 +1,37 @@
+//
+//  c2_portfolio.h
+//  cadet
+//
+//  Portfolio mode: solves copies of a formula with diversified configurations in parallel threads.
+//  The first configuration that reaches a result wins; the others are terminated via c2_set_terminate.
+//  Workers share short learnt clauses with each other.
+//
+
+#ifndef c2_portfolio_h
+#define c2_portfolio_h
+
+#include "cadet_internal.h"
+
+/* Copies the formula of c2 (see qcnf_copy) once per thread and solves the copies in parallel.
+ * Configuration 0 uses c2->options as given, the others vary the seed, CEGAR, case splits,
+ * clause minimization, pure literals, and random decisions.
+ * Returns the solver of the configuration that finished first, or configuration 0 if none reached
+ * a result. The returned solver owns its options; free it with c2_portfolio_free.
+ */
+C2* c2_portfolio_solve(C2* c2, unsigned threads);
+void c2_portfolio_free(C2*);
+
+// Learnt clauses up to this size that contain only original variables are shared between workers
+#define C2_PORTFOLIO_MAX_SHARED_CLAUSE_SIZE 8
+
+/* Clause sharing; both functions do nothing unless c2 is a portfolio worker.
+ * Export publishes a learnt clause (from conflict analysis or clause minimization) to the other workers.
+ * Import adds the clauses published by the other workers since the last import through c2_new_clause;
+ * it is called at restarts and only imports on decision level 0, where a conflict refutes the formula.
+ * Workers stop importing when they open their first case split: clauses added from outside the search
+ * can make the replay of a closed case fail (see casesplits_record_conflicts).
+ */
+void c2_portfolio_export_clause(C2* c2, Clause* c);
+void c2_portfolio_import_clauses(C2* c2);
+
+#endif /* c2_portfolio_h */
@@ -24,7 +24,7 @@ typedef struct {
     bool mute;
 } RL;
 
-RL* rl = NULL;
+_Thread_local RL* rl = NULL; // thread-local, so that solvers in other threads do not trace
 char* mock_file = NULL;
 
 void rl_init() {
@@ -375,7 +375,7 @@ int_vector* c2_rl_necessary_learnt_clauses(C2* solver) {
     Skolem* replay = skolem_init(qcnf_copy, solver->options);
 
     Case* last_case = vector_get(solver->cs->closed_cases, vector_count(solver->cs->closed_cases) - 1);
-    casesplits_record_conflicts(replay, last_case->determinization_order);
+    abortif(! casesplits_record_conflicts(replay, last_case->determinization_order), "Replay of the last case ran into a conflict.");
     skolem_encode_global_conflict_check(replay);
     int_vector* necessary_assumptions = c2_rl_test_assumptions(replay, universal_assumptions);
     abortif(!necessary_assumptions, "Formula was not solved correctly in RL mode. Generation of early rewards failed."); // can now fail because we change the determinization order of the case for storage TODO
@@ -7,9 +7,22 @@
 //
 
 #include "cadet_internal.h"
+#include "c2_portfolio.h"
 #include "log.h"
 #include "mersenne_twister.h"
 
+#include <stdlib.h>
+
+static void c2_delete_learnt_clause(C2* c2, Clause* c) {
+    assert(!c->original);
+    if (skolem_has_unique_consequence(c2->skolem, c)) {
+        assert(c2->skolem->stack->push_count == 0); // to make sure the unique consequence reset below does not end up on the stack
+        skolem_set_unique_consequence(c2->skolem, c, 0);
+    }
+    qcnf_unregister_clause(c2->qcnf, c);
+    assert(!c->active);
+}
+
 void c2_delete_learnt_clauses_greater_than(C2* c2, unsigned max_size) {
     unsigned kept = 0;
     unsigned deleted = 0;
@@ -20,13 +33,7 @@ void c2_delete_learnt_clauses_greater_than(C2* c2, unsigned max_size) {
         }
         Lit uc = skolem_get_unique_consequence(c2->skolem, c);
         if (c->size > max_size && (uc == 0 || ! skolem_is_deterministic(c2->skolem, lit_to_var(uc))) && c->original == 0) {
-            
-            if (uc != 0) {
-                assert(c2->skolem->stack->push_count == 0); // to make sure the unique consequence reset below does not end up on the stack
-                skolem_set_unique_consequence(c2->skolem, c, 0);
-            }
-            qcnf_unregister_clause(c2->qcnf, c);
-            assert(!c->active);
+            c2_delete_learnt_clause(c2, c);
             deleted += 1;
         } else {
             kept += 1;
@@ -35,6 +42,110 @@ void c2_delete_learnt_clauses_greater_than(C2* c2, unsigned max_size) {
     V1("  Kept %u; deleted %u clauses\n", kept, deleted);
 }
 
+typedef struct {
+    unsigned lbd;
+    unsigned uses;
+    Clause* c;
+} c2_reduction_candidate;
+
+// Worst clauses first: high LBD, rarely used, long, old
+static int c2_compare_reduction_candidates(const void* a, const void* b) {
+    const c2_reduction_candidate* x = (const c2_reduction_candidate*) a;
+    const c2_reduction_candidate* y = (const c2_reduction_candidate*) b;
+    if (x->lbd != y->lbd) {
+        return x->lbd > y->lbd ? -1 : 1;
+    }
+    if (x->uses != y->uses) {
+        return x->uses < y->uses ? -1 : 1;
+    }
+    if (x->c->size != y->c->size) {
+        return x->c->size > y->c->size ? -1 : 1;
+    }
+    return x->c->clause_idx < y->c->clause_idx ? -1 : (x->c->clause_idx > y->c->clause_idx ? 1 : 0);
+}
+
+static bool c2_is_reason_in_partial_assignment(PartialAssignment* pa, Clause* c) {
+    for (unsigned i = 0; i < c->size; i++) {
+        if (partial_assignment_is_relevant_clause(pa, c, c->occs[i])) {
+            return true;
+        }
+    }
+    return pa->conflicted_clause == c;
+}
+
+// Clauses that the Skolem domain or the partial assignments currently rely on must stay
+static bool c2_is_locked_clause(C2* c2, Clause* c) {
+    Lit uc = skolem_get_unique_consequence(c2->skolem, c);
+    if (uc != 0 && (c2->skolem->stack->push_count != 0 || skolem_is_deterministic(c2->skolem, lit_to_var(uc)))) {
+        return true;
+    }
+    for (unsigned i = 0; i < c->size; i++) {
+        unsigned var_id = lit_to_var(c->occs[i]);
+        if (skolem_get_reason_for_constant(c2->skolem, var_id) == c->clause_idx) {
+            return true;
+        }
+    }
+    if (c2_is_reason_in_partial_assignment(c2->minimization_pa, c)) {
+        return true;
+    }
+    for (unsigned i = 0; i < vector_count(c2->examples->ex); i++) {
+        if (c2_is_reason_in_partial_assignment(vector_get(c2->examples->ex, i), c)) {
+            return true;
+        }
+    }
+    return c2->skolem->conflicted_clause == c;
+}
+
+// Returns the memory of inactive learnt clauses (deleted, or replaced by their minimized version) to the
+// clause arena, unless a domain still refers to them. Original clauses are kept for the certificates.
+static void c2_release_inactive_learnt_clauses(C2* c2) {
+    Clause_Iterator ci = qcnf_get_clause_iterator(c2->qcnf); // drops inactive clauses from the active clause vector
+    while (qcnf_next_clause(&ci) != NULL) {}
+    for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
+        Clause* c = vector_get(c2->qcnf->all_clauses, i);
+        if (c == NULL || c->active || ! qcnf_is_learnt_clause(c) || c->is_cube || c2_is_locked_clause(c2, c)) {
+            continue;
+        }
+        skolem_forget_clause(c2->skolem, c);
+        conflict_analysis_forget_clause(c2->ca, c);
+        qcnf_delete_clause(c2->qcnf, c);
+    }
+}
+
+void c2_reduce_learnt_clauses(C2* c2) {
+    c2_reduction_candidate* candidates = malloc(sizeof(c2_reduction_candidate) * (vector_count(c2->qcnf->active_clauses) + 1));
+    unsigned candidate_num = 0;
+    unsigned kept = 0;
+    Clause_Iterator ci = qcnf_get_clause_iterator(c2->qcnf); Clause* c = NULL;
+    while ((c = qcnf_next_clause(&ci)) != NULL) {
+        if (c->original) {
+            continue;
+        }
+        unsigned lbd = conflict_analysis_get_lbd(c2->ca, c);
+        if (lbd <= c2->magic.glue_clause_lbd || c->is_cube || c2_is_locked_clause(c2, c)) {
+            kept += 1;
+            continue;
+        }
+        candidates[candidate_num].lbd = lbd;
+        candidates[candidate_num].uses = conflict_analysis_get_uses(c2->ca, c);
+        candidates[candidate_num].c = c;
+        candidate_num += 1;
+    }
+    qsort(candidates, candidate_num, sizeof(c2_reduction_candidate), c2_compare_reduction_candidates);
+    
+    unsigned deleted = candidate_num / 2;
+    for (unsigned i = 0; i < deleted; i++) {
+        c2_delete_learnt_clause(c2, candidates[i].c);
+    }
+    free(candidates);
+    conflict_analysis_reset_uses(c2->ca);
+    c2_release_inactive_learnt_clauses(c2);
+    
+    c2->statistics.learnt_clause_reductions += 1;
+    c2->statistics.deleted_learnt_clauses += deleted;
+    V1("Reduced learnt clauses: kept %u, deleted %u\n", kept + candidate_num - deleted, deleted);
+}
+
 void c2_simplify(C2* c2) {
     assert(c2->restart_base_decision_lvl == c2->skolem->decision_lvl); // because conflicts we may find are treated as UNSAT
     bool simplify_originals = c2->restarts % 15 ? false : true;
@@ -51,6 +162,7 @@ void c2_simplify(C2* c2) {
         Clause* minimized = c2_minimize_clause(c2, c);
         if (minimized) {
             c2_new_clause(c2, minimized);
+            c2_portfolio_export_clause(c2, minimized);
             if (skolem_is_conflicted(c2->skolem)) {
                 c2->state = C2_UNSAT;
                 break;
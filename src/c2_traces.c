@@ -173,11 +173,18 @@ void c2_print_statistics(C2* c2) {
     V0("  Cases explored:  %zu\n", c2->statistics.cases_closed);
     V0("  Literals eliminated:  %zu / %zu\n", c2->statistics.successful_conflict_clause_minimizations, c2->statistics.learnt_clauses_total_length);
     V0("  Time spent minimizing: %f\n", c2->statistics.minimization_stats->accumulated_value)
+    V0("  Learnt clause reductions:  %zu (deleted %zu clauses)\n", c2->statistics.learnt_clause_reductions, c2->statistics.deleted_learnt_clauses);
+    if (c2->options->portfolio_threads > 1) {
+        V0("  Shared clauses:  exported %zu, imported %zu\n", c2->statistics.exported_clauses, c2->statistics.imported_clauses);
+    }
+    if (c2->statistics.sat_calls > 1) {
+        V0("  Incremental calls:  %zu (reused %zu learnt clauses, dropped %zu closed cases)\n", c2->statistics.sat_calls, c2->statistics.reused_learnt_clauses, c2->statistics.dropped_closed_cases);
+    }
     V0("  Failed Literals Conflicts:  %zu\n", c2->statistics.failed_literals_conflicts);
     statistics_print(c2->statistics.failed_literals_stats);
 }
 
-bool c2_printed_color_legend = false;
+_Thread_local bool c2_printed_color_legend = false;
 
 void c2_print_learnt_clause_color_legend() {
     if (log_colors && !c2_printed_color_legend) {
@@ -213,8 +220,8 @@ void c2_trace_for_profiling_initialize(Options* o, SATSolver* s) {
     satsolver_measure_all_calls(s);
 }
 
-double last_time_stamp = 0.0;
-double last_satsolver_seconds = 0.0;
+_Thread_local double last_time_stamp = 0.0;
+_Thread_local double last_satsolver_seconds = 0.0;
 
 void c2_trace_for_profiling(C2* c2) {
     if (!c2->options->trace_for_profiling) {
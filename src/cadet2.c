@@ -9,6 +9,7 @@
 
 #include "cadet_internal.h"
 #include "qcnf.h"
+#include "qcnf_binary.h"
 #include "log.h"
 #include "util.h"
 #include "conflict_analysis.h"
@@ -22,6 +23,7 @@
 #include "c2_traces.h"
 #include "c2_rl.h"
 #include "mersenne_twister.h"
+#include "c2_portfolio.h"
 
 #include <math.h>
 #include <stdint.h>
@@ -29,6 +31,10 @@
 
 
 C2* c2_init(Options* options) {
+    return c2_init_qcnf(qcnf_init(), options);
+}
+
+C2* c2_init_qcnf(QCNF* qcnf, Options* options) {
     if (!options) {options = default_options();}
     if (options->fresh_random_seed) {
         init_genrand((unsigned long)time(NULL));
@@ -37,8 +43,20 @@ C2* c2_init(Options* options) {
     }
     
     C2* c2 = malloc(sizeof(C2));
-    c2->qcnf = qcnf_init();
+    c2->qcnf = qcnf;
     c2->options = options;
+    c2->terminate = NULL;
+    c2->terminate_state = NULL;
+    c2->limit_reached = false;
+    c2->portfolio_worker = NULL;
+    c2->assumptions = int_vector_init();
+    c2->universal_assumptions = int_vector_init();
+    c2->active_assumptions = int_vector_init();
+    c2->core = int_vector_init();
+    c2->skolem_outdated = false;
+    c2->pure_literals_suspended = false;
+    c2->enhanced_pure_literals_suspended = false;
+    c2->clauses_before_last_call = 0;
     
     c2->state = C2_READY;
     c2->restarts = 0;
@@ -49,10 +67,21 @@ C2* c2_init(Options* options) {
     c2->activity_factor = 1.0f;
     c2->activity_factor_inverse = 1.0f / c2->activity_factor;
     c2->variable_activities = float_vector_init();
+    while (float_vector_count(c2->variable_activities) < var_vector_count(c2->qcnf->vars)) {
+        float_vector_add(c2->variable_activities, 0.0);
+    }
+    c2->decision_heap = var_heap_init(c2->variable_activities);
     
     // DOMAINS
     c2->cs = casesplits_init(c2->qcnf);
     c2->skolem = skolem_init(c2->qcnf, c2->options);
+    c2->skolem->decision_heap = c2->decision_heap;
+    for (unsigned i = 1; i < var_vector_count(c2->qcnf->vars); i++) {
+        if (qcnf_var_exists(c2->qcnf, i) && qcnf_is_existential(c2->qcnf, i) && ! skolem_is_deterministic(c2->skolem, i)) {
+            var_heap_insert(c2->decision_heap, i);
+        }
+    }
+    c2_set_sat_interrupts(c2);
     if (skolem_is_conflicted(c2->skolem)) {
         c2->state = C2_UNSAT;
     }
@@ -78,6 +107,13 @@ C2* c2_init(Options* options) {
 
     c2->statistics.failed_literals_stats = statistics_init(10000);
     c2->statistics.failed_literals_conflicts = 0;
+    c2->statistics.learnt_clause_reductions = 0;
+    c2->statistics.deleted_learnt_clauses = 0;
+    c2->statistics.exported_clauses = 0;
+    c2->statistics.imported_clauses = 0;
+    c2->statistics.sat_calls = 0;
+    c2->statistics.reused_learnt_clauses = 0;
+    c2->statistics.dropped_closed_cases = 0;
 
     // Magic constants
     c2->magic.initial_restart = 6; // [1..100] // depends also on restart factor
@@ -92,6 +128,10 @@ C2* c2_init(Options* options) {
     c2->magic.num_restarts_before_Jeroslow_Wang = options->easy_debugging ? 1000 : 3;
     c2->magic.num_restarts_before_case_splits = options->easy_debugging ? 0 : 3;
     c2->magic.keeping_clauses_threshold = 3;
+    c2->magic.glue_clause_lbd = 2;
+    c2->magic.learnt_clause_reduction_interval = options->clause_reduction_interval;
+    c2->magic.learnt_clause_reduction_increment = options->clause_reduction_increment;
+    c2->next_learnt_clause_reduction = c2->magic.learnt_clause_reduction_interval;
 
     // Magic constants for case splits
     c2->magic.skolem_success_horizon = (float) 0.9; // >0.0 && <1.0
@@ -100,6 +140,7 @@ C2* c2_init(Options* options) {
     c2->skolem_success_recent_average = c2->magic.skolem_success_recent_average_initialization;
     c2->case_split_depth_penalty = C2_CASE_SPLIT_DEPTH_PENALTY_LINEAR; // C2_CASE_SPLIT_DEPTH_PENALTY_QUADRATIC
     c2->conflicts_between_case_splits_countdown = 1;
+    c2->probe_snapshots = NULL;
     c2->magic.case_split_linear_depth_penalty_factor = options->easy_debugging ? 1 : 5;
     
     return c2;
@@ -107,6 +148,7 @@ C2* c2_init(Options* options) {
 
 void c2_free(C2* c2) {
     statistics_free(c2->statistics.failed_literals_stats);
+    c2_free_probe_snapshots(c2);
     skolem_free(c2->skolem);
     if (c2->cs) {casesplits_free(c2->cs); c2->cs = NULL;}
     examples_free(c2->examples);
@@ -114,7 +156,12 @@ void c2_free(C2* c2) {
     qcnf_free(c2->qcnf);
     partial_assignment_free(c2->minimization_pa);
     statistics_free(c2->statistics.minimization_stats);
+    var_heap_free(c2->decision_heap);
     float_vector_free(c2->variable_activities);
+    int_vector_free(c2->assumptions);
+    int_vector_free(c2->universal_assumptions);
+    int_vector_free(c2->active_assumptions);
+    int_vector_free(c2->core);
     free(c2);
 }
 
@@ -122,6 +169,7 @@ void c2_free(C2* c2) {
 void c2_set_activity(C2* c2, unsigned var_id, float val) {
     assert(val > -0.0001);
     float_vector_set(c2->variable_activities, var_id, val * c2->activity_factor);
+    var_heap_update(c2->decision_heap, var_id);
 }
 
 float c2_get_activity(C2* c2, unsigned var_id) {
@@ -137,6 +185,7 @@ void c2_increase_activity(C2* c2, unsigned var_id, float val) {
     assert(c2->activity_factor >= 1.0);
     assert(c2->activity_factor_inverse <= 1.0);
     float_vector_set(c2->variable_activities, var_id, activity + val * c2->activity_factor);
+    var_heap_update(c2->decision_heap, var_id);
 }
 
 void c2_scale_activity(C2* c2, unsigned var_id, float factor) {
@@ -146,6 +195,7 @@ void c2_scale_activity(C2* c2, unsigned var_id, float factor) {
     assert(c2->activity_factor >= 1.0);
     assert(c2->activity_factor_inverse <= 1.0);
     float_vector_set(c2->variable_activities, var_id, activity * factor);
+    var_heap_update(c2->decision_heap, var_id);
 }
 
 void c2_rescale_activity_values(C2* c2) {
@@ -160,7 +210,8 @@ void c2_rescale_activity_values(C2* c2) {
     }
 }
 
-Var* c2_pick_max_activity_variable(C2* c2) {
+// Linear scan over all variables; used in RL mode, which reports the activities of all candidates
+Var* c2_scan_max_activity_variable(C2* c2) {
     Var* var = NULL;
     float decision_var_activity = -1.0;
     for (unsigned i = 1; i < var_vector_count(c2->qcnf->vars); i++) {
@@ -183,6 +234,20 @@ Var* c2_pick_max_activity_variable(C2* c2) {
     return var;
 }
 
+Var* c2_pick_max_activity_variable(C2* c2) {
+    if (c2->options->reinforcement_learning) {
+        return c2_scan_max_activity_variable(c2);
+    }
+    unsigned var_id = var_heap_peek(c2->decision_heap);
+    if (var_id == 0) {
+        return NULL;
+    }
+    assert(!skolem_is_deterministic(c2->skolem, var_id));
+    assert(qcnf_is_existential(c2->qcnf, var_id));
+    V3("Maximal activity is %f for var %u\n", c2_get_activity(c2, var_id), var_id);
+    return var_vector_get(c2->qcnf->vars, var_id);
+}
+
 // Returns NULL, if all variables are decided
 Var* c2_pick_nondeterministic_variable(C2* c2) {
     if (!c2->options->random_decisions) {  // Pick variable with highest activity
@@ -243,7 +308,9 @@ unsigned c2_are_decisions_involved(C2* c2, Clause* conflict) {
     for (unsigned i = 0; i < conflict->size; i++) {
         Lit lit = conflict->occs[i];
         unsigned dlvl;
-        if (c2->state == C2_SKOLEM_CONFLICT) {
+        if (c2->state == C2_SKOLEM_CONFLICT && ! skolem_is_deterministic(c2->skolem, lit_to_var(lit))) {
+            dlvl = skolem_get_dlvl_for_constant(c2->skolem, lit_to_var(lit)); // existential assumptions are constants before they propagate
+        } else if (c2->state == C2_SKOLEM_CONFLICT) {
             dlvl = skolem_get_decision_lvl(c2->skolem,lit_to_var(lit));
         } else {
             assert(c2->state == C2_EXAMPLES_CONFLICT);
@@ -350,6 +417,47 @@ void c2_propagate(C2* c2) {
     }
 }
 
+void c2_set_terminate(C2* c2, void* state, int (*terminate)(void* state)) {
+    c2->terminate = terminate;
+    c2->terminate_state = state;
+}
+
+/* Checks the limits given by --time_limit and --mem_limit. Once a limit is reached, SAT calls are interrupted
+ * (see c2_set_sat_interrupts) and their results cannot be trusted anymore, so c2_sat returns
+ * CADET_RESULT_UNKNOWN from then on. The memory is the peak RSS of the whole process, so with --portfolio all
+ * workers reach the memory limit at once.
+ */
+bool c2_reached_resource_limit(C2* c2) {
+    if (c2->limit_reached) {
+        return true;
+    }
+    if (c2->options->time_limit != 0 && get_seconds() - c2->statistics.start_time >= c2->options->time_limit) {
+        V0("Time limit of %.1f seconds reached.\n", c2->options->time_limit);
+        c2->limit_reached = true;
+    } else if (c2->options->mem_limit != 0 && get_peak_memory_mb() >= c2->options->mem_limit) {
+        V0("Memory limit of %u MB reached.\n", c2->options->mem_limit);
+        c2->limit_reached = true;
+    }
+    return c2->limit_reached;
+}
+
+static int c2_sat_interrupt(void* c2) {
+    return c2_reached_resource_limit((C2*) c2);
+}
+
+// Lets long SAT calls of the Skolem domain and of CEGAR stop at resource limits; needed whenever the SAT solvers are replaced
+void c2_set_sat_interrupts(C2* c2) {
+    if (c2->options->time_limit == 0 && c2->options->mem_limit == 0) {
+        return;
+    }
+    satsolver_set_interrupt(c2->skolem->skolem, c2, c2_sat_interrupt);
+    satsolver_set_interrupt(c2->cs->exists_solver, c2, c2_sat_interrupt);
+}
+
+bool c2_is_terminated(C2* c2) {
+    return (c2->terminate && c2->terminate(c2->terminate_state)) || c2_reached_resource_limit(c2);
+}
+
 // MAIN LOOPS
 void c2_run(C2* c2, unsigned remaining_conflicts) {
     
@@ -387,6 +495,11 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
                                                  skolem_get_decision_lvl_for_conflict_analysis);
             }
             
+            if (learnt_clause == NULL && c2_has_active_assumptions(c2) && c2->skolem->decision_lvl == c2->restart_base_decision_lvl) {
+                c2_assumptions_refuted(c2, c2->ca->conflicting_assignment); // an existing clause contradicts the assumptions
+                c2->state = C2_UNSAT;
+                return;
+            }
             if (learnt_clause == NULL) {
                 abortif(satsolver_sat(c2->skolem->skolem) == SATSOLVER_SAT, "Conflict clause could not be created. Conflict counter: %zu", c2->statistics.conflicts);
                 c2->state = C2_CLOSE_CASE;
@@ -413,6 +526,12 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
             c2->decisions_since_last_conflict = 0;
 
             bool decisions_involved = c2_are_decisions_involved(c2, learnt_clause);
+            if (! decisions_involved && c2_has_active_assumptions(c2)) {
+                // The Skolem domain learns the clause when the assumptions are retracted (see c2_backtrack_casesplit)
+                c2_assumptions_refuted(c2, c2->ca->conflicting_assignment);
+                c2->state = C2_UNSAT;
+                return;
+            }
             if (decisions_involved) { // any decisions involved?
                 // Update Examples database
                 if (c2->skolem->state == SKOLEM_STATE_SKOLEM_CONFLICT) {
@@ -456,8 +575,17 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
             c2_backtrack_to_decision_lvl(c2, backtracking_lvl);
             c2->statistics.lvls_backtracked += old_dlvl - c2->skolem->decision_lvl;
             
-            c2_new_clause(c2, learnt_clause); // can bring c2->state in c2_unsat
+            if (skolem_is_conflicted(c2->skolem)) {
+                // Still conflicted on the restart base of a case split, which is UNSAT. A second conflict on the same decision
+                // level could not be undone; the Skolem domain learns the clause when the domain is rebuilt (see c2_prepare_assumptions).
+                assert(c2->skolem->decision_lvl == c2->restart_base_decision_lvl);
+                examples_new_clause(c2->examples, learnt_clause);
+                c2->state = C2_UNSAT;
+            } else {
+                c2_new_clause(c2, learnt_clause); // can bring c2->state in c2_unsat
+            }
             c2->statistics.added_clauses += 1;
+            c2_portfolio_export_clause(c2, learnt_clause);
             
             c2_decay_activity(c2);
             c2_log_clause(c2, learnt_clause);
@@ -465,6 +593,9 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
 #ifdef DEBUG
             c2_validate_unique_consequences(c2);
 #endif
+            if (c2->state == C2_UNSAT && c2_has_active_assumptions(c2)) {
+                c2_assumptions_refuted(c2, c2->ca->conflicting_assignment); // the learnt clause itself is refuted
+            }
             
             assert(!skolem_is_conflicted(c2->skolem) || c2->state == C2_UNSAT);
             assert(decisions_involved || c2->options->functional_synthesis || c2->state == C2_UNSAT);
@@ -491,6 +622,10 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
                 continue; // can happen when a potentially conflicted variable is not actually conflicted
             }
 
+            if (c2_is_terminated(c2)) {
+                return;
+            }
+            
             // try case splits
             bool progress_through_case_split = c2_casesplits_assume_single_lit(c2);
             if (c2->state == C2_SKOLEM_CONFLICT) {
@@ -580,14 +715,15 @@ void c2_run(C2* c2, unsigned remaining_conflicts) {
 cadet_res c2_result(C2* c2) {
     switch (c2->state) {
         case C2_SAT:
-            assert(c2->options->functional_synthesis || skolem_has_empty_domain(c2->skolem));
+            assert(c2->options->functional_synthesis || skolem_has_empty_domain(c2->skolem) || c2_has_active_assumptions(c2) || int_vector_count(c2->universal_assumptions) > 0);
             return CADET_RESULT_SAT;
         case C2_UNSAT:
-            assert(satsolver_state(c2->skolem->skolem) == SATSOLVER_SAT || c2->skolem->state == SKOLEM_STATE_CONSTANTS_CONLICT);
+            assert(satsolver_state(c2->skolem->skolem) == SATSOLVER_SAT || c2->skolem->state == SKOLEM_STATE_CONSTANTS_CONLICT || c2_has_active_assumptions(c2));
             assert(! skolem_has_empty_domain(c2->skolem));
             return CADET_RESULT_UNSAT;
         case C2_READY:
         case C2_ABORT_RL:
+        case C2_ABORT_LIMIT:
             return CADET_RESULT_UNKNOWN;
         default:
             LOG_ERROR("CALLED c2_result in state %d", c2->state);
@@ -622,7 +758,7 @@ cadet_res c2_check_propositional(QCNF* qcnf, Options* o) {
 }
 
 
-void c2_replenish_skolem_satsolver(C2* c2) {
+void c2_replenish_skolem_satsolver(C2* c2, bool keep_closed_cases, int_vector* universal_assumptions) {
     V1("Replenishing satsolver\n");
     
     // To be sure we did mess up we remember the skolem data structure's decision level and stack height
@@ -630,21 +766,34 @@ void c2_replenish_skolem_satsolver(C2* c2) {
     assert(c2->restart_base_decision_lvl == 0);
     assert(c2->skolem->decision_lvl == 0);
     
+    c2_free_probe_snapshots(c2); // they encode the closed cases of the old domain
     Skolem* old_skolem = c2->skolem;
-    c2->skolem = skolem_init(c2->qcnf, c2->options);
+    c2->skolem = skolem_init_with_universal_assumptions(c2->qcnf, c2->options, universal_assumptions);
+    var_heap_reset(c2->decision_heap);
+    c2->skolem->decision_heap = c2->decision_heap;
+    for (unsigned i = 1; i < var_vector_count(c2->qcnf->vars); i++) {
+        if (qcnf_var_exists(c2->qcnf, i) && qcnf_is_existential(c2->qcnf, i) && ! skolem_is_deterministic(c2->skolem, i)) {
+            var_heap_insert(c2->decision_heap, i);
+        }
+    }
     
     Casesplits* old_cs = c2->cs;
     c2->cs = casesplits_init(c2->qcnf);
     
     c2_propagate(c2);
-    abortif(c2->state != C2_READY, "Conflicted after replenishing.");
+    if (c2_is_in_conflcit(c2)) {
+        c2->state = C2_UNSAT; // conflict on decision level 0
+    }
     
     casesplits_update_interface(c2->cs, c2->skolem);
+    c2_set_sat_interrupts(c2);
     
-    assert(vector_count(old_cs->closed_cases) == 0 || c2->options->cegar || c2->options->casesplits);
+    // Calls to c2_sat that returned SAT close the whole domain as one case, also without case splits
+    assert(vector_count(old_cs->closed_cases) == 0 || c2->options->cegar || c2->options->casesplits || c2->statistics.sat_calls > 0);
     
-    // Copy the cubes that we have solved already.
-    casesplits_steal_cases(c2->cs, old_cs);
+    if (keep_closed_cases) {
+        c2->statistics.dropped_closed_cases += casesplits_replay_cases(c2->cs, old_cs);
+    }
     
     // Replace the new interace activities by the old ones
     float_vector_free(c2->cs->interface_activities);
@@ -658,10 +807,13 @@ void c2_replenish_skolem_satsolver(C2* c2) {
     c2->cs->cegar_stats.successful_minimizations_by_additional_assignments = old_cs->cegar_stats.successful_minimizations;
     c2->cs->cegar_stats.recent_average_cube_size = old_cs->cegar_stats.recent_average_cube_size;
     
+    if (! keep_closed_cases) {
+        c2->statistics.dropped_closed_cases += vector_count(old_cs->closed_cases);
+    }
     skolem_free(old_skolem);
     casesplits_free(old_cs);
     
-    abortif(c2_is_in_conflcit(c2) || c2->state != C2_READY, "Illegal state afte replenishing");
+    abortif(c2->state != C2_READY && c2->state != C2_UNSAT, "Illegal state afte replenishing");
 }
 
 
@@ -687,13 +839,32 @@ void c2_restart_heuristics(C2* c2) {
         c2->next_major_restart = (size_t) (c2->next_major_restart * c2->magic.restart_factor);
     }
     
+    if (c2->options->delete_clauses_on_restarts && c2->statistics.added_clauses >= c2->next_learnt_clause_reduction) {
+        c2_reduce_learnt_clauses(c2);
+        c2->magic.learnt_clause_reduction_interval += c2->magic.learnt_clause_reduction_increment;
+        c2->next_learnt_clause_reduction = c2->statistics.added_clauses + c2->magic.learnt_clause_reduction_interval;
+    }
+    
     if (c2->restarts % c2->magic.replenish_frequency == c2->magic.replenish_frequency - 1) {
         V1("Stepping out of case split.\n"); // Needed to simplify replenishing
         c2_backtrack_casesplit(c2);
 //#if (USE_SOLVER == SOLVER_PICOSAT_ASSUMPTIONS)
-//        c2_replenish_skolem_satsolver(c2);
+//        c2_replenish_skolem_satsolver(c2, true, c2->universal_assumptions);
 //#endif
     }
+    
+    c2_portfolio_import_clauses(c2);
+}
+
+static unsigned c2_count_learnt_clauses(C2* c2, unsigned from_clause_idx) {
+    unsigned count = 0;
+    Clause_Iterator ci = qcnf_get_clause_iterator(c2->qcnf); Clause* c = NULL;
+    while ((c = qcnf_next_clause(&ci)) != NULL) {
+        if (c->clause_idx >= from_clause_idx && qcnf_is_learnt_clause(c)) {
+            count++;
+        }
+    }
+    return count;
 }
 
 cadet_res c2_sat(C2* c2) {
@@ -705,12 +876,21 @@ cadet_res c2_sat(C2* c2) {
     }
     //////
     
+    if (c2->limit_reached) {
+        return CADET_RESULT_UNKNOWN; // the limits hold for the lifetime of the solver
+    }
     assert(c2->state == C2_UNSAT || c2->state == C2_SAT || c2->state == C2_READY);
+    c2_backtrack_after_solving(c2);
+    if (c2->statistics.sat_calls > 0) { // counts each learnt clause once, in the call after the one that learnt it
+        c2->statistics.reused_learnt_clauses += c2_count_learnt_clauses(c2, c2->clauses_before_last_call);
+    }
+    c2->clauses_before_last_call = vector_count(c2->qcnf->all_clauses);
+    c2_prepare_assumptions(c2);
     if (c2->state == C2_UNSAT || c2->state == C2_SAT) {
         goto return_result;
     }
-    abortif(int_vector_count(c2->skolem->universals_assumptions) != 0, "There are universal assumptions before solving started.");
-    assert(c2->options->functional_synthesis || int_vector_count(c2->qcnf->universal_clauses) == 0); // they must have been detected through c2_new_clause
+    abortif(int_vector_count(c2->skolem->universals_assumptions) != int_vector_count(c2->universal_assumptions), "There are universal assumptions before solving started.");
+    assert(c2->options->functional_synthesis || int_vector_count(c2->qcnf->universal_clauses) == 0 || int_vector_count(c2->universal_assumptions) > 0); // they must have been detected through c2_new_clause, unless the assumptions satisfy them
     
     if (c2->options->functional_synthesis) {
         int_vector* tmp_vars = int_vector_init();
@@ -719,6 +899,9 @@ cadet_res c2_sat(C2* c2) {
         }
         for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
             Clause* c = vector_get(c2->qcnf->all_clauses, i);
+            if (c == NULL) {
+                continue;
+            }
             V3("Satsolver clause:");
             for (unsigned j = 0; j < c->size; j++) {
                 Lit l = c->occs[j];
@@ -759,13 +942,15 @@ cadet_res c2_sat(C2* c2) {
     if (debug_verbosity >= VERBOSITY_HIGH) {skolem_print_deterministic_vars(c2->skolem);}
     if (c2->options->miniscoping) {c2_analysis_determine_number_of_partitions(c2);}
     casesplits_update_interface(c2->cs, c2->skolem);
+    c2_set_sat_interrupts(c2);
+    c2_push_assumptions(c2);
     if (c2->options->cegar_only) {
         cegar_solve_2QBF_by_cegar(c2, -1);
-        assert(c2->state == C2_SAT || c2_is_in_conflcit(c2));
+        assert(c2->state == C2_SAT || c2_is_in_conflcit(c2) || c2_is_terminated(c2));
         goto return_result;
     }
 
-    while (c2->state == C2_READY) { // This loop controls the restarts
+    while (c2->state == C2_READY || c2->state == C2_SKOLEM_CONFLICT) { // This loop controls the restarts; conflicts occur here only when assumptions are refuted right away
         
         unsigned next_restart = c2->next_restart;
         if (c2->options->reinforcement_learning || c2->options->random_decisions) {
@@ -773,6 +958,11 @@ cadet_res c2_sat(C2* c2) {
         }
         c2_run(c2, next_restart);
         assert(!c2_is_in_conflcit(c2) || c2->state == C2_UNSAT);
+        if (c2->state == C2_CLOSE_CASE && c2_has_active_assumptions(c2)) {
+            // The Skolem functions work for all assignments to the universals that satisfy the assumptions
+            c2_backtrack_to_decision_lvl(c2, c2->restart_base_decision_lvl);
+            c2->state = C2_SAT;
+        }
         if (c2->state == C2_CLOSE_CASE) { //} skolem_is_complete(c2->skolem) && (c2->options->casesplits || c2->options->certify_SAT)) {
             bool must_be_SAT = int_vector_count(c2->skolem->universals_assumptions) == 0; // just for safety
             c2_close_case(c2);
@@ -783,6 +973,10 @@ cadet_res c2_sat(C2* c2) {
         }
         if (c2->state == C2_READY) {
             c2_backtrack_to_decision_lvl(c2, c2->restart_base_decision_lvl);
+            if (c2_is_terminated(c2)) {
+                V1("Terminated by request.\n");
+                goto return_result;
+            }
             V1("Restart %zu\n", c2->restarts);
             c2->restarts += 1;
             c2_restart_heuristics(c2);
@@ -790,7 +984,11 @@ cadet_res c2_sat(C2* c2) {
         }
     }
 return_result:
-    assert(true);
+    if (c2->limit_reached) {
+        c2->state = C2_ABORT_LIMIT; // the result may rely on interrupted SAT calls
+    }
+    c2_conclude_assumptions(c2);
+    c2->statistics.sat_calls += 1;
     cadet_res result = c2_result(c2);
     assert(! c2->options->functional_synthesis || result != CADET_RESULT_UNSAT);
     return result;
@@ -823,16 +1021,20 @@ int_vector* c2_refuting_assignment(C2* c2) {
  */
 cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
     if (!options) {options = default_options();}
-    FILE* file = NULL;
+    unsigned preprocessing = 0; // preprocessing steps already applied to the formula, see qcnf_binary.h
+    C2* c2 = NULL;
     if (file_name == NULL) {
         V0("Reading from stdin\n");
-        file = stdin;
+        c2 = c2_from_file(stdin, options);
+    } else if (qcnf_is_binary_file(file_name)) {
+        V0("Processing binary file \"%s\".\n", file_name);
+        c2 = c2_from_binary_file(file_name, options, &preprocessing);
     } else {
         V0("Processing file \"%s\".\n", file_name);
-        file = open_possibly_zipped_file(file_name);
+        FILE* file = open_possibly_zipped_file(file_name);
+        c2 = c2_from_file(file, options);
+        close_possibly_zipped_file(file_name, file);
     }
-    C2* c2 = c2_from_file(file, options);
-    close_possibly_zipped_file(file_name, file);
     
     V1("Maximal variable index: %u\n", var_vector_count(c2->qcnf->vars));
     V1("Number of clauses: %u\n", vector_count(c2->qcnf->all_clauses));
@@ -840,6 +1042,9 @@ cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
 
     if (qcnf_is_propositional(c2->qcnf) && ! options->use_qbf_engine_also_for_propositional_problems) {
         LOG_WARNING("Propositional problem; using SAT solver.\n");
+        if (options->binary_file_name) {
+            LOG_WARNING("Binary formula is not written for propositional problems.\n");
+        }
         cadet_res res = c2_check_propositional(c2->qcnf, options);
         if (! options->functional_synthesis || res == CADET_RESULT_SAT) {
             return res;
@@ -849,16 +1054,28 @@ cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
         }
     }
     
-    if (options->plaisted_greenbaum_completion) {
+    if (options->plaisted_greenbaum_completion && ! (preprocessing & QCNF_BINARY_PLAISTED_GREENBAUM)) {
         qcnf_plaisted_greenbaum_completion(c2->qcnf);
+        preprocessing |= QCNF_BINARY_PLAISTED_GREENBAUM;
     }
-    if (options->qbce) {
+    if (options->qbce && ! (preprocessing & QCNF_BINARY_QBCE)) {
         qcnf_blocked_clause_detection(c2->qcnf);
+        preprocessing |= QCNF_BINARY_QBCE;
+    }
+    if (options->binary_file_name) {
+        qcnf_write_binary(c2->qcnf, preprocessing, options->binary_file_name);
     }
 
-    cadet_res res = c2_sat(c2);
-    if (debug_verbosity >= VERBOSITY_LOW) {
-        c2_print_statistics(c2);
+    C2* solver = c2; // in portfolio mode, the copy of the formula that was solved first
+    cadet_res res;
+    if (options->portfolio_threads > 1 && c2->state == C2_READY) {
+        solver = c2_portfolio_solve(c2, options->portfolio_threads);
+        res = c2_result(solver);
+    } else {
+        res = c2_sat(c2);
+    }
+    if (debug_verbosity >= VERBOSITY_LOW || solver->state == C2_ABORT_LIMIT) {
+        c2_print_statistics(solver);
     }
     switch (res) {
         case CADET_RESULT_UNKNOWN:
@@ -869,41 +1086,44 @@ cadet_res c2_solve_qdimacs(const char* file_name, Options* options) {
             if (log_qdimacs_compliant) {
                 printf("s cnf 1\n");
             }
-            if (c2->options->certify_SAT) {
-                c2_write_AIG_certificate(c2);
+            if (solver->options->certify_SAT) {
+                c2_write_AIG_certificate(solver);
             }
             break;
         case CADET_RESULT_UNSAT:
             V0("UNSAT\n");
-            assert(c2->state == C2_UNSAT);
-            abortif(c2->options->functional_synthesis,
+            assert(solver->state == C2_UNSAT);
+            abortif(solver->options->functional_synthesis,
                     "Should not reach UNSAT output in functional synthesis mode.");
             if (log_qdimacs_compliant) {
                 printf("s cnf 0\n");
             }
             
             V1("  UNSAT via Skolem conflict.\n");
-            c2_print_qdimacs_output(c2_refuting_assignment(c2));
-            abortif(c2->options->certify_internally_UNSAT && ! cert_check_UNSAT(c2),
+            c2_print_qdimacs_output(c2_refuting_assignment(solver));
+            abortif(solver->options->certify_internally_UNSAT && ! cert_check_UNSAT(solver),
                     "Check failed! UNSAT result could not be certified.");
             V1("Result verified.\n");
 
             // For conflicts from CEGAR, not sure if the code above handles this already
 //            V1("  UNSAT via Cegar conflict.\n");
-//            c2_print_qdimacs_output(c2->qcnf, c2->skolem, cegar_get_val);
-//            abortif(c2->options->certify_internally_UNSAT
-//                    && ! cert_check_UNSAT(c2->qcnf, c2->skolem, cegar_get_val),
+//            c2_print_qdimacs_output(solver->qcnf, solver->skolem, cegar_get_val);
+//            abortif(solver->options->certify_internally_UNSAT
+//                    && ! cert_check_UNSAT(solver->qcnf, solver->skolem, cegar_get_val),
 //                    "Check failed! UNSAT result could not be certified.");
 //            V1("Result verified.\n");
             
             // For conflicts from examples; not possible at the moment
 //            V1("  UNSAT via Examples conflict.\n");
-//            c2_print_qdimacs_output(c2->qcnf, c2->examples, examples_get_value_for_conflict_analysis);
-//            abortif(c2->options->certify_internally_UNSAT
-//                    && ! cert_check_UNSAT(c2->qcnf, c2->examples, examples_get_value_for_conflict_analysis) ,
+//            c2_print_qdimacs_output(solver->qcnf, solver->examples, examples_get_value_for_conflict_analysis);
+//            abortif(solver->options->certify_internally_UNSAT
+//                    && ! cert_check_UNSAT(solver->qcnf, solver->examples, examples_get_value_for_conflict_analysis) ,
 //                    "Check failed! UNSAT result could not be certified.");
             break;
     }
+    if (solver != c2) {
+        c2_portfolio_free(solver);
+    }
     c2_free(c2);
     return res;
 }
@@ -914,16 +1134,39 @@ void c2_add_lit(C2* c2, Lit lit) {
         qcnf_add_lit(c2->qcnf, lit);
         return;
     } else {
+        c2_retract_assumptions(c2);
         Clause* c = qcnf_close_clause(c2->qcnf);
-        if (c) {
+        if (c && c2->statistics.sat_calls == 0) {
             c2_new_clause(c2, c);
             c2_rl_new_clause(c);
+        } else if (c) {
+            // Pure literals and closed cases of the last call may not hold for the new clause. Instead of adding the
+            // clause to the Skolem domain, the next call to c2_sat rebuilds it (see c2_prepare_assumptions); learnt
+            // clauses and variable activities carry over. Adding clauses preserves UNSAT results.
+            c2->skolem_outdated = true;
+            if (c2->state != C2_UNSAT) {
+                c2->state = C2_READY;
+            }
+            c2_rl_new_clause(c);
         }
         return;
     }
 }
 
+/* Returns to decision level 0 after a call to c2_sat. Backtracking from the case split adds the clauses to
+ * the Skolem domain again, which is skipped if the Skolem domain is outdated, and UNSAT results stay where
+ * they are, as they may carry over to the next call (see c2_prepare_assumptions).
+ */
+void c2_backtrack_after_solving(C2* c2) {
+    c2_retract_assumptions(c2);
+    if (c2->skolem->decision_lvl > 0 && c2->state != C2_UNSAT && ! c2->skolem_outdated) {
+        c2_backtrack_to_decision_lvl(c2, c2->restart_base_decision_lvl);
+        c2_backtrack_casesplit(c2);
+    }
+}
+
 void c2_new_variable(C2* c2, bool is_universal, unsigned scope_id, unsigned var_id) {
+    c2_backtrack_after_solving(c2);
     while (var_id >= float_vector_count(c2->variable_activities)) {
         float_vector_add(c2->variable_activities, 0.0);
     }
@@ -956,7 +1199,7 @@ void c2_new_clause(C2* c2, Clause* c) {
 
 int c2_val (C2* c2, int lit) {
     assert(c2->state == C2_UNSAT);
-    assert(skolem_is_conflicted(c2->skolem));
+    assert(skolem_is_conflicted(c2->skolem) || c2_has_active_assumptions(c2));
     assert(qcnf_is_universal(c2->qcnf, lit_to_var(lit)));
     return skolem_get_constant_value(c2->skolem, lit) * lit;
 }
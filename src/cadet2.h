@@ -29,6 +29,7 @@ void c2_free(C2*);
 
 C2* c2_from_file(FILE*, Options*);
 C2* c2_from_qaiger(aiger*, Options*);
+C2* c2_from_binary_file(const char* file_name, Options*, unsigned* preprocessing); // see qcnf_binary.h
 
 // Introduces a new variable with identifier var_id.
 void c2_new_2QBF_variable(C2*, bool is_universal, unsigned var_id);
@@ -40,16 +41,21 @@ unsigned c2_fresh_variable(C2*, bool is_universal);
 // Variables used here must be introduced through c2_new_2QBF_variable first.
 void c2_add_lit(C2*, int literal);
 
-// Assume the value of a variable.
+// Assume the value of a variable for the next call to c2_sat. Assumptions are cleared by c2_sat.
 //  - assuming universals makes formulas easier to solve; after SAT results use c2_is_core to check if necessary
 //  - assuming existentials makes formulas harder to solve; after UNSAT results use c2_is_core to check if necessary
-// c2_is_core only works when clause minimization is switched off.
+// The core may contain assumptions that were not necessary. Learnt clauses are kept across calls.
 void c2_assume(C2*, int literal);
 bool c2_is_core(C2*, int assumed_literal);
 
-// Solves the formula encoded in the solver and returns the result.
+// Solves the formula encoded in the solver and returns the result. May be called again after adding
+// clauses; learnt clauses and variable activities are kept, and UNSAT results remain UNSAT.
 cadet_res c2_sat(C2*);
 
+// Sets a callback that is polled during solving; if it returns a nonzero value, c2_sat
+// returns CADET_RESULT_UNKNOWN as soon as possible. Follows ipasir_set_terminate.
+void c2_set_terminate(C2*, void* state, int (*terminate)(void* state));
+
 // Returns the result of the last solver call, and CADET_RESULT_UNKNOWN if not solved yet.
 cadet_res c2_result(C2*);
 
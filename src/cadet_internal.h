@@ -22,6 +22,7 @@ typedef enum {
     C2_UNSAT, // assignment in the satsolver of the skolem domain is a refuting assignment
     C2_EXAMPLES_CONFLICT,
     C2_ABORT_RL, // allows RL code to terminate current computation
+    C2_ABORT_LIMIT, // time or memory limit reached; see c2_reached_resource_limit
     C2_SAT,
     C2_CLOSE_CASE
 } c2_state;
@@ -46,6 +47,16 @@ struct C2_Statistics {
     
     Stats* failed_literals_stats;
     size_t failed_literals_conflicts;
+    
+    size_t learnt_clause_reductions;
+    size_t deleted_learnt_clauses;
+    
+    size_t exported_clauses; // portfolio mode
+    size_t imported_clauses;
+    
+    size_t sat_calls; // incremental solving; see c2_add_lit
+    size_t reused_learnt_clauses;
+    size_t dropped_closed_cases;
 };
 
 struct C2_Magic_Values {
@@ -58,6 +69,9 @@ struct C2_Magic_Values {
     size_t replenish_frequency;
     unsigned num_restarts_before_Jeroslow_Wang;
     unsigned keeping_clauses_threshold;
+    unsigned glue_clause_lbd; // learnt clauses with at most this LBD are never deleted
+    unsigned learnt_clause_reduction_interval; // number of added clauses before the first reduction
+    unsigned learnt_clause_reduction_increment; // the interval grows by this many clauses after each reduction
     
     // Magic constants for case splits
     unsigned num_restarts_before_case_splits;
@@ -81,8 +95,10 @@ struct C2 {
     size_t restarts_since_last_major;
     unsigned next_restart;
     size_t next_major_restart;
+    size_t next_learnt_clause_reduction; // in terms of statistics.added_clauses
     unsigned restart_base_decision_lvl; // decision_lvl used for restarts
     float_vector* variable_activities; // indexed by var_id
+    var_heap* decision_heap; // nondeterministic existentials by activity; kept up to date by the Skolem domain
     
     // Reasoning domains
     Skolem* skolem;
@@ -103,15 +119,38 @@ struct C2 {
     float skolem_success_recent_average;
     C2_CSDP case_split_depth_penalty;
     size_t conflicts_between_case_splits_countdown;
+    struct c2_probe_snapshot* probe_snapshots; // one per probe thread, kept across picks; see c2_case_split_pick_literal
+    
+    // Assumptions; see c2_assume
+    int_vector* assumptions; // for the next call to c2_sat
+    int_vector* universal_assumptions; // assumed on decision level 0 until a call to c2_sat with different universal assumptions
+    int_vector* active_assumptions; // existential assumptions on decision level 1 until the formula changes or c2_sat is called
+    int_vector* core; // assumptions the result of the last call to c2_sat depends on
+    bool skolem_outdated; // clauses were added after the last call to c2_sat; the next call rebuilds the Skolem domain
+    bool pure_literals_suspended; // for the existential assumptions of the next call; restored by c2_conclude_assumptions
+    bool enhanced_pure_literals_suspended;
+    unsigned clauses_before_last_call; // learnt clauses from this index on were learnt in the last call to c2_sat
+    
+    // Termination; see c2_set_terminate
+    int (*terminate)(void* state);
+    void* terminate_state;
+    bool limit_reached; // see c2_reached_resource_limit
+    
+    // Clause sharing; see c2_portfolio.h
+    struct c2_portfolio_worker* portfolio_worker; // NULL unless solving in portfolio mode
     
     struct C2_Statistics statistics;
     
     struct C2_Magic_Values magic;
 };
 
+C2* c2_init_qcnf(QCNF*, Options*); // takes ownership of the QCNF
 void c2_new_variable(C2*, bool is_universal, unsigned scope_id, unsigned var_id);
 void c2_new_clause(C2*, Clause* c);
 bool c2_is_in_conflcit(C2*);
+bool c2_is_terminated(C2*);
+bool c2_reached_resource_limit(C2*);
+void c2_set_sat_interrupts(C2*);
 void c2_simplify(C2*);
 int_vector* c2_refuting_assignment(C2*);
 
@@ -119,6 +158,17 @@ int_vector* c2_refuting_assignment(C2*);
 void c2_backtrack_casesplit(C2*);
 bool c2_casesplits_assume_single_lit(C2*); // returns if any kind of progress happened
 void c2_close_case(C2*);
+void c2_free_probe_snapshots(C2*); // whenever the Skolem domain of c2 is replaced
+
+// Assumptions
+void c2_retract_assumptions(C2*);
+void c2_backtrack_after_solving(C2*);
+void c2_prepare_assumptions(C2*);
+void c2_push_assumptions(C2*);
+void c2_conclude_assumptions(C2*);
+void c2_assumptions_refuted(C2*, int_vector* conflicting_assignment);
+bool c2_has_active_assumptions(C2*);
+void c2_replenish_skolem_satsolver(C2*, bool keep_closed_cases, int_vector* universal_assumptions); // universal_assumptions may be NULL
 
 // CEGAR
 /*
@@ -150,6 +200,7 @@ Clause* c2_minimize_clause(C2*,Clause*);
 void c2_analysis_determine_number_of_partitions(C2* c2);
 
 void c2_delete_learnt_clauses_greater_than(C2* c2, unsigned max_size);
+void c2_reduce_learnt_clauses(C2* c2);
 
 void c2_print_debug_info(C2*);
 void c2_print_colored_literal_name(C2*, char* color, int lit);
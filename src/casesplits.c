@@ -97,7 +97,7 @@ void casesplits_update_interface(Casesplits* cs, Skolem* skolem) {
     // set up satsolver for existentials
     for (unsigned i = 0; i < vector_count(cs->skolem->qcnf->all_clauses); i++) {
         Clause* c = vector_get(cs->skolem->qcnf->all_clauses, i);
-        if (! c->original) {
+        if (c == NULL || ! c->original) {
             continue;
         }
         Lit uc = skolem_get_unique_consequence(cs->skolem, c);
@@ -116,7 +116,7 @@ void casesplits_update_interface(Casesplits* cs, Skolem* skolem) {
     cs->interface_vars = int_vector_init();
     for (unsigned i = 0; i < vector_count(cs->skolem->qcnf->all_clauses); i++) {
         Clause* c = vector_get(cs->skolem->qcnf->all_clauses, i);
-        if (! c->original || c->blocked) {
+        if (c == NULL || ! c->original || c->blocked) {
             continue;
         }
         Lit uc = skolem_get_unique_consequence(cs->skolem, c);
@@ -137,7 +137,9 @@ void casesplits_update_interface(Casesplits* cs, Skolem* skolem) {
         Lit interface_lit = int_vector_get(cs->interface_vars, i);
         assert(interface_lit > 0); // not required for correctness, just a sanity check
         unsigned interface_var = lit_to_var(interface_lit);
-        cegar_remember_original_satlit(cs, interface_var);
+        if (! map_contains(cs->original_satlits, (Lit) interface_var)) { // the interface is updated again when c2_sat is called repeatedly
+            cegar_remember_original_satlit(cs, interface_var);
+        }
     }
     
     V1("Total of %u deterministic vars\n", int_vector_count(cs->skolem->determinization_order));
@@ -176,6 +178,7 @@ void casesplits_free(Casesplits* d) {
         case_free((Case*) vector_get(d->closed_cases, i));
     }
     vector_free(d->closed_cases);
+    free(d);
 }
 
 
@@ -232,21 +235,23 @@ void skolem_print_assignment(Skolem* s) {
     V1("\n");
 }
 
-void casesplits_record_conflicts(Skolem* s, int_vector* decision_sequence) {
+bool casesplits_record_conflicts(Skolem* s, int_vector* decision_sequence) {
     s->record_conflicts = true;
     skolem_propagate(s); // initial propagation
-    for (unsigned i = 0; i < int_vector_count(decision_sequence); i++) {
+    for (unsigned i = 0; i < int_vector_count(decision_sequence) && ! skolem_is_conflicted(s); i++) {
         Lit decision_lit = int_vector_get(decision_sequence, i);
         if (skolem_is_deterministic(s, lit_to_var(decision_lit))) {
             V3("Discovered during replay that decision %d is not needed.\n", decision_lit);
         } else {
             skolem_decision(s, decision_lit);
             skolem_propagate(s);
-            assert(!skolem_is_conflicted(s)); // as we are in conflict recording mode
         }
     }
     V2("max satlit %d\n", satsolver_get_max_var(s->skolem));
     s->record_conflicts = false;
+    // Skolem conflicts are recorded; constants conflicts are only possible with clauses that were added
+    // from outside the search, such as the clauses imported from other portfolio workers.
+    return ! skolem_is_conflicted(s);
 }
 
 int_vector* casesplits_test_assumptions(Casesplits* cs, int_vector* universal_assumptions) {
@@ -293,18 +298,52 @@ Case* casesplits_completed_case_split(Casesplits* cs,
 }
 
 
-void casesplits_encode_closed_case(Casesplits* cs, int_vector* determinization_order, int_vector* universal_assumptions) {
+// Leaves the replay of a closed case that failed; the SAT solver does not contain any clauses of the case
+static bool casesplits_abort_replay(Casesplits* cs, int_vector* universal_assumptions) {
+    vector_reset(cs->skolem->clauses_to_check);
+    pqueue_reset(cs->skolem->determinicity_queue);
+    pqueue_reset(cs->skolem->pure_var_queue);
+    stack_pop(cs->skolem->stack, cs->skolem);
+    rl_unmute();
+    int_vector_free(universal_assumptions);
+    return false;
+}
+
+bool casesplits_encode_closed_case(Casesplits* cs, int_vector* determinization_order, int_vector* universal_assumptions) {
     assert(cs->skolem->decision_lvl == 0);
     assert(!skolem_is_conflicted(cs->skolem));
     assert(!cs->skolem->record_conflicts);
     
+    for (unsigned i = 0; i < int_vector_count(universal_assumptions); i++) {
+        Lit lit = int_vector_get(universal_assumptions, i);
+        if (! skolem_is_deterministic(cs->skolem, lit_to_var(lit))) {
+            V1("Closed case assumes %d, which is not deterministic on decision level 0 any more.\n", lit);
+            int_vector_free(determinization_order);
+            int_vector_free(universal_assumptions);
+            return false;
+        }
+        if (! map_contains(cs->original_satlits, lit)) {
+            cegar_remember_original_satlit(cs, lit_to_var(lit)); // the interface changed since the case was closed
+        }
+    }
+    
     rl_mute();
     stack_push(cs->skolem->stack);
     
     // Encode the disjunction over the potentially conflicted variables.
     // This excludes all solutions for which this Skolem function works
-    casesplits_record_conflicts(cs->skolem, determinization_order);
+    bool replayed = casesplits_record_conflicts(cs->skolem, determinization_order);
     int_vector_free(determinization_order);
+    if (! replayed) {
+        V1("Replay of the closed case ran into a conflict.\n");
+        return casesplits_abort_replay(cs, universal_assumptions);
+    }
+    for (unsigned i = 0; i < var_vector_count(cs->skolem->qcnf->vars); i++) {
+        if (qcnf_var_exists(cs->skolem->qcnf, i) && ! skolem_is_deterministic(cs->skolem, i)) {
+            V1("Replay of the closed case left variable %u nondeterministic.\n", i);
+            return casesplits_abort_replay(cs, universal_assumptions);
+        }
+    }
     determinization_order = case_splits_determinization_order_with_polarities(cs->skolem);
     int_vector* potentially_conflicted_variables = int_vector_copy(cs->skolem->potentially_conflicted_variables);
     int_vector* unique_consequences = int_vector_copy(cs->skolem->unique_consequence);
@@ -330,9 +369,18 @@ void casesplits_encode_closed_case(Casesplits* cs, int_vector* determinization_o
     //#endif
     
     if ( ! cs->skolem->options->functional_synthesis) {
+        satsolver_push(cs->skolem->skolem);
         skolem_encode_global_conflict_check(cs->skolem);
         int_vector* necessary_assumptions = casesplits_test_assumptions(cs, universal_assumptions);
-        abortif(necessary_assumptions == NULL, "Case split was not successfully closed");
+        satsolver_pop(cs->skolem->skolem);
+        if (necessary_assumptions == NULL) {
+            V1("Case split does not close any more.\n");
+            int_vector_free(determinization_order);
+            int_vector_free(potentially_conflicted_variables);
+            int_vector_free(unique_consequences);
+            return casesplits_abort_replay(cs, universal_assumptions);
+        }
+        skolem_encode_global_conflict_check(cs->skolem);
         for (unsigned i = 0; i < int_vector_count(necessary_assumptions); i++) {
             Lit lit = int_vector_get(necessary_assumptions, i);
             int satlit = (int) (long) map_get(cs->original_satlits, - lit);
@@ -357,12 +405,6 @@ void casesplits_encode_closed_case(Casesplits* cs, int_vector* determinization_o
         skolem_encode_global_conflict_check(cs->skolem);
     }
     
-#ifdef DEBUG
-    for (unsigned i = 0; i < var_vector_count(cs->skolem->qcnf->vars); i++) {
-        abortif(qcnf_var_exists(cs->skolem->qcnf, i) && ! skolem_is_deterministic(cs->skolem, i), "A variable remained deterministic after casesplit replay.");
-    }
-#endif
-    
     stack_pop(cs->skolem->stack, cs->skolem);
     rl_unmute();
     
@@ -371,6 +413,7 @@ void casesplits_encode_closed_case(Casesplits* cs, int_vector* determinization_o
                                     determinization_order,
                                     unique_consequences,
                                     potentially_conflicted_variables);
+    return true;
 }
 
 
@@ -454,28 +497,50 @@ int_vector* case_splits_determinization_order_with_polarities(Skolem* s) {
     return result;
 }
 
-void casesplits_steal_cases(Casesplits* new_cs, Casesplits* old_cs) {
-    LOG_WARNING("This function is deprecated.");
+/* Replays the function cases of old_cs in the Skolem domain of new_cs, which may contain clauses that were added
+ * since the cases were closed. Cases that no longer close are dropped, and so are CEGAR cubes, as they only record
+ * the assignment to the universals, which the new clauses may refute. Returns the number of dropped cases.
+ */
+unsigned casesplits_replay_cases(Casesplits* new_cs, Casesplits* old_cs) {
+    unsigned dropped = 0;
     for (unsigned i = 0; i < vector_count(old_cs->closed_cases); i++) {
         Case* c = (Case*) vector_get(old_cs->closed_cases, i);
-        if (c->type == 0) {
-            casesplits_record_cegar_cube(new_cs, c->universal_assumptions, c->determinization_order);
-            // We passed these objects on to the new casesplits object, so make sure these
-            // objects will not be deallocated during free of old_cs below.
-            c->universal_assumptions = NULL;
-            c->determinization_order = NULL;
-            assert(c->unique_consequences == NULL);
-            casesplits_encode_CEGAR_case(new_cs);
-        } else {
-            assert(c->type == 1);
-            // We passed these objects on to the new casesplits object, so make sure these
-            // objects will not be deallocated during free of old_cs below.
-            casesplits_encode_closed_case(new_cs, c->determinization_order, c->universal_assumptions);
+        if (c->type == 1 && ! skolem_is_conflicted(new_cs->skolem)) {
+            // The vectors pass on to new_cs, so they must not be deallocated with old_cs
+            bool replayed = casesplits_encode_closed_case(new_cs, c->determinization_order, c->universal_assumptions);
             c->universal_assumptions = NULL;
             c->determinization_order = NULL;
-            c->unique_consequences = NULL;
+            if (replayed) {
+                continue;
+            }
+        }
+        dropped += 1;
+    }
+    return dropped;
+}
+
+/* Excludes the universal assignments of a case that was closed in another Skolem domain over the same formula, such
+ * as the snapshots for parallel probing. Function cases are encoded by their assumptions only, as replaying their
+ * Skolem functions costs about as much as closing them again; the encoding is hence weaker than in the domain that
+ * closed the case. The case is not recorded in cs. Returns false if an assumption is not deterministic in cs->skolem.
+ */
+bool casesplits_encode_case_copy(Casesplits* cs, Case* c) {
+    assert(cs->skolem->decision_lvl == 0);
+    for (unsigned i = 0; i < int_vector_count(c->universal_assumptions); i++) {
+        Lit lit = int_vector_get(c->universal_assumptions, i);
+        if (! skolem_is_deterministic(cs->skolem, lit_to_var(lit))) {
+            return false;
         }
+        if (! map_contains(cs->original_satlits, - lit)) {
+            cegar_remember_original_satlit(cs, lit_to_var(lit));
+        }
+    }
+    for (unsigned i = 0; i < int_vector_count(c->universal_assumptions); i++) {
+        Lit lit = int_vector_get(c->universal_assumptions, i);
+        satsolver_add(cs->skolem->skolem, (int) (long) map_get(cs->original_satlits, - lit));
     }
+    satsolver_clause_finished_for_context(cs->skolem->skolem, 0);
+    return true;
 }
 
 void casesplits_print_statistics(Casesplits* cs) {
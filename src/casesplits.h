@@ -72,14 +72,15 @@ bool casesplits_is_initialized(Casesplits*);
 void casesplits_free(Casesplits*);
 
 int_vector* case_splits_determinization_order_with_polarities(Skolem*);
-void casesplits_encode_closed_case(Casesplits* cs, int_vector* determinization_order, int_vector* universal_assumptions);
+bool casesplits_encode_closed_case(Casesplits* cs, int_vector* determinization_order, int_vector* universal_assumptions); // false if the replay of the case failed
 void casesplits_encode_CEGAR_case(Casesplits*);
-void casesplits_steal_cases(Casesplits* new_cs, Casesplits* old_cs); // for satsolver refreshs
+unsigned casesplits_replay_cases(Casesplits* new_cs, Casesplits* old_cs); // for satsolver refreshs; returns the number of dropped cases
+bool casesplits_encode_case_copy(Casesplits*, Case* c); // for the snapshots for parallel probing
 void casesplits_record_cegar_cube(Casesplits*, int_vector* cube, int_vector* partial_assignment);
 void casesplits_encode_case_into_satsolver(Skolem*, Case* c, SATSolver* sat);
 void casesplits_print_statistics(Casesplits*);
 
-void casesplits_record_conflicts(Skolem* s, int_vector* decision_sequence);
+bool casesplits_record_conflicts(Skolem* s, int_vector* decision_sequence); // false if the replay ran into a conflict
 int_vector* casesplits_test_assumptions(Casesplits* cs, int_vector* universal_assumptions);
 
 // Interface
@@ -80,6 +80,12 @@ void cegar_one_round_for_conflicting_assignment(C2* c2) {
         satsolver_assume(cs->exists_solver, val * (Lit) var_id);
         V3(" %d", val * (Lit) var_id);
     }
+    // Existential assumptions restrict the values the existentials can take
+    for (unsigned i = 0; i < int_vector_count(c2->active_assumptions); i++) {
+        Lit lit = int_vector_get(c2->active_assumptions, i);
+        satsolver_assume(cs->exists_solver, lit);
+        V3(" %d", lit);
+    }
     V3("\n");
     
 #ifdef DEBUG
@@ -163,7 +169,7 @@ void cegar_solve_2QBF_by_cegar(C2* c2, int rounds_num) {
     assert(casesplits_is_initialized(c2->cs));
     
     // solver loop
-    while (c2->state == C2_READY && rounds_num--) {
+    while (c2->state == C2_READY && rounds_num-- && ! c2_is_terminated(c2)) {
         if (!skolem_check_if_domain_is_empty(c2->skolem)) {
             cegar_one_round_for_conflicting_assignment(c2);
         } else {
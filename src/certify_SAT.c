@@ -20,6 +20,11 @@
 #define AIGERLIT_UNDEFINED INT_MAX
 #define QUANTIFIER_ELIMINATION_OUTPUT_STRING "There is an assignment to the existentials"
 
+static bool cert_has_suffix(const char* str, const char* suffix) {
+    size_t len = strlen(str);
+    return len >= strlen(suffix) && strcmp(str + len - strlen(suffix), suffix) == 0;
+}
+
 void cert_write_aiger(aiger* a, Options* o) {
     const char* filename = o->certificate_file_name;
     
@@ -29,6 +34,13 @@ void cert_write_aiger(aiger* a, Options* o) {
     int write_success = 0;
     if (!filename || strcmp(filename, "stdout") == 0) {
         write_success = aiger_write_to_file(a, aiger_ascii_mode, stdout);
+    } else if (! cert_has_suffix(filename, ".aag") && ! cert_has_suffix(filename, ".gz") && aigeru_has_builder_numbering(a)) {
+        // binary format; written without reencoding a, see aigeru_write_binary
+        FILE* file = fopen(filename, "w");
+        write_success = file != NULL && aigeru_write_binary(a, file);
+        if (file != NULL && fclose(file) != 0) {
+            write_success = 0;
+        }
     } else {
         write_success = aiger_open_and_write_to_file(a, filename);
         
@@ -104,12 +116,13 @@ Lit cert_get_unique_consequence(int_vector* ucs, Clause* c) {
 }
 
 
-void cert_encode_unique_antecedents(QCNF* qcnf, aiger* a, int_vector* aigerlits, int_vector* unique_consequences, unsigned *max_sym, Lit lit) {
+void cert_encode_unique_antecedents(QCNF* qcnf, aigeru_builder* b, int_vector* aigerlits, int_vector* unique_consequences, Lit lit) {
     assert(lit);
     unsigned var_id = lit_to_var(lit);
     
     // encode all the antecedents
     int_vector* antecedent_aigerlits = int_vector_init();
+    int_vector* conjuncts = int_vector_init();
     vector* occs = qcnf_get_occs_of_lit(qcnf, lit);
     for (unsigned i = 0; i < vector_count(occs); i++) {
         Clause* c = vector_get(occs, i);
@@ -118,19 +131,20 @@ void cert_encode_unique_antecedents(QCNF* qcnf, aiger* a, int_vector* aigerlits,
         }
         if (cert_get_unique_consequence(unique_consequences, c) == lit) {
             // encode the antecedent
-            unsigned antecedent = aiger_true; // empty conjunction is true
+            int_vector_reset(conjuncts);
             for (unsigned j = 0; j < c->size; j++) {
                 Lit clause_lit = c->occs[j];
                 if (clause_lit != lit) { // != unique_consequence
                     unsigned clause_aigerlit = mapped_lit2aigerlit(aigerlits, clause_lit);
-                    antecedent = aigeru_AND(a, max_sym, antecedent, negate(clause_aigerlit));
+                    int_vector_add(conjuncts, (int) negate(clause_aigerlit));
                 }
             }
-            int_vector_add(antecedent_aigerlits, (int) antecedent);
+            int_vector_add(antecedent_aigerlits, (int) aigeru_multiAND(b, conjuncts)); // empty conjunction is true
         }
     }
+    int_vector_free(conjuncts);
     assert(int_vector_get(aigerlits, var_id) == AIGERLIT_UNDEFINED);  // variable should not be defined twice; using 0 as the default
-    unsigned aigerlit_for_lit = aigeru_multiOR(a, max_sym, antecedent_aigerlits);
+    unsigned aigerlit_for_lit = aigeru_multiOR(b, antecedent_aigerlits);
     V3("Lit %d assigned aigerlit %u\n", lit, aigerlit_for_lit);
     if (lit < 0) {
         aigerlit_for_lit = negate(aigerlit_for_lit);
@@ -146,21 +160,20 @@ bool cert_is_dlvl_zero_var(Skolem* skolem, unsigned var_id) {
 
 
 // Returns an aiger lit that is true iff the cube is satisfied.
-unsigned cert_encode_c2_cube(C2* c2, aiger* a, unsigned *max_sym, int_vector* aigerlits, int_vector* cube) {
+unsigned cert_encode_c2_cube(C2* c2, aigeru_builder* b, int_vector* aigerlits, int_vector* cube) {
     int_vector* cube_aigerlits = int_vector_init();
     for (unsigned i = 0; i < int_vector_count(cube); i++) {
         Lit l = int_vector_get(cube, i);
         assert(skolem_get_decision_lvl(c2->skolem, lit_to_var(l)) == 0); // Currently restricted to dlvl0 cubes
         int_vector_add(cube_aigerlits, (int) mapped_lit2aigerlit(aigerlits, l));
     }
-    unsigned outputlit = inc(max_sym);
-    aigeru_add_multiAND(a, max_sym, outputlit, cube_aigerlits);
+    unsigned outputlit = aigeru_multiAND(b, cube_aigerlits);
     int_vector_free(cube_aigerlits);
     return outputlit;
 }
 
 
-unsigned cert_encode_CEGAR(Skolem* skolem, aiger* a, unsigned *max_sym, int_vector* aigerlits, Case* c) {
+unsigned cert_encode_CEGAR(Skolem* skolem, aigeru_builder* b, int_vector* aigerlits, Case* c) {
     assert(c->type == 0);  // encodes a function
     assert(c->universal_assumptions != NULL);
     
@@ -179,21 +192,22 @@ unsigned cert_encode_CEGAR(Skolem* skolem, aiger* a, unsigned *max_sym, int_vect
         }
     }
     
-    unsigned case_is_valid = aiger_true;
+    int_vector* assumption_aigerlits = int_vector_init();
     for (unsigned i = 0; i < int_vector_count(c->universal_assumptions); i++) {
         Lit assumption = int_vector_get(c->universal_assumptions, i);
-        unsigned assumption_aigerlit = mapped_lit2aigerlit(aigerlits, assumption);
-        case_is_valid = aigeru_AND(a, max_sym, case_is_valid, assumption_aigerlit);
+        int_vector_add(assumption_aigerlits, (int) mapped_lit2aigerlit(aigerlits, assumption));
     }
+    unsigned case_is_valid = aigeru_multiAND(b, assumption_aigerlits);
+    int_vector_free(assumption_aigerlits);
     return case_is_valid;
 }
 
-unsigned cert_encode_conflicts(Skolem* skolem, aiger* a, unsigned *max_sym, int_vector* aigerlits,
+unsigned cert_encode_conflicts(Skolem* skolem, aigeru_builder* b, int_vector* aigerlits,
                                int_vector* decisions,
                                int_vector* potentially_conflicted_variables,
                                int_vector* unique_consequences) {
     
-    unsigned conflict = aiger_false;
+    int_vector* conflict_aigerlits = int_vector_init();
     
     int_vector_sort(potentially_conflicted_variables, compare_integers_natural_order); // to enable logarithmic lookup
     
@@ -211,24 +225,26 @@ unsigned cert_encode_conflicts(Skolem* skolem, aiger* a, unsigned *max_sym, int_
             int_vector_set(aigerlits, var_id, AIGERLIT_UNDEFINED);
             
             // encode other side
-            cert_encode_unique_antecedents(skolem->qcnf, a, aigerlits, unique_consequences, max_sym, polarity * (Lit) var_id);
+            cert_encode_unique_antecedents(skolem->qcnf, b, aigerlits, unique_consequences, polarity * (Lit) var_id);
             
             // encode conflict
             unsigned anti_aigerlit = (unsigned) int_vector_get(aigerlits, var_id);
-            unsigned conflict_aigerlit = aigeru_AND(a, max_sym,
+            unsigned conflict_aigerlit = aigeru_AND(b,
                                                     polarity > 0 ? negate(aigerlit) : aigerlit,
                                                     polarity > 0 ? anti_aigerlit : negate(anti_aigerlit));
-            conflict = aigeru_OR(a, max_sym, conflict, conflict_aigerlit);
+            int_vector_add(conflict_aigerlits, (int) conflict_aigerlit);
             
             // reset the aigerlit to original value
             int_vector_set(aigerlits, var_id, (int) aigerlit);
         }
     }
+    unsigned conflict = aigeru_multiOR(b, conflict_aigerlits);
+    int_vector_free(conflict_aigerlits);
     return conflict;
 }
 
 // Certify all vars with dlvl>0 by writing out the unique consequences in the correct order
-void cert_encode_function_for_case(Skolem* skolem, aiger* a, unsigned *max_sym,
+void cert_encode_function_for_case(Skolem* skolem, aigeru_builder* b,
                                    int_vector* aigerlits,
                                    int_vector* decisions,
                                    int_vector* unique_consequences) {
@@ -242,19 +258,19 @@ void cert_encode_function_for_case(Skolem* skolem, aiger* a, unsigned *max_sym,
         }
         if (int_vector_get(aigerlits, var_id) == AIGERLIT_UNDEFINED) {
             assert(!qcnf_is_universal(skolem->qcnf, var_id));
-            cert_encode_unique_antecedents(skolem->qcnf, a, aigerlits, unique_consequences, max_sym, - decision_lit);
+            cert_encode_unique_antecedents(skolem->qcnf, b, aigerlits, unique_consequences, - decision_lit);
         }
     }
 }
 
 
-unsigned cert_dlvl0_definitions(aiger* a, int_vector* aigerlits, Skolem* skolem, unsigned* max_sym) {
+unsigned cert_dlvl0_definitions(aigeru_builder* b, int_vector* aigerlits, Skolem* skolem) {
     int_vector* decision_sequence = case_splits_determinization_order_with_polarities(skolem);
-    cert_encode_function_for_case(skolem, a, max_sym, aigerlits, decision_sequence,
+    cert_encode_function_for_case(skolem, b, aigerlits, decision_sequence,
                                   skolem->unique_consequence);
     
     if (skolem->options->quantifier_elimination) {
-        unsigned res = cert_encode_conflicts(skolem, a, max_sym, aigerlits, decision_sequence,
+        unsigned res = cert_encode_conflicts(skolem, b, aigerlits, decision_sequence,
                                              skolem->potentially_conflicted_variables,
                                              skolem->unique_consequence);
         int_vector_free(decision_sequence);
@@ -373,11 +389,12 @@ void c2_write_AIG_certificate(C2* c2) {
         return;
     }
     
-    unsigned max_sym = var2aigerlit(a->maxvar);
-    assert(c2->options->certificate_type != QBFCERT || max_sym == var2aigerlit(a->maxvar + 1));
+    aigeru_builder* b = aigeru_builder_init(a, var2aigerlit(a->maxvar));
+    b->balanced = c2->options->certificate_balanced_gates;
+    assert(c2->options->certificate_type != QBFCERT || b->max_sym == var2aigerlit(a->maxvar + 1));
     
     // Certificate for the dlvl0 variables
-    unsigned dlvl0_conflict_aigerlit = cert_dlvl0_definitions(a, aigerlits, skolem_dlvl0, &max_sym);
+    unsigned dlvl0_conflict_aigerlit = cert_dlvl0_definitions(b, aigerlits, skolem_dlvl0);
     
     // The following data structures remember all the aigerlits for all cases; dlvl0 vars are only remembered once
     vector* case_aigerlits = vector_init(); // stores for every variable an int_vector of aigerlits for the different cases
@@ -398,11 +415,11 @@ void c2_write_AIG_certificate(C2* c2) {
         unsigned case_applies = AIGERLIT_UNDEFINED;
         Case* c = vector_get(c2->cs->closed_cases, case_idx);
         if (c->type == 0) {  // CEGAR assignment
-            case_applies = cert_encode_CEGAR(skolem_dlvl0, a, &max_sym, aigerlits, c);
+            case_applies = cert_encode_CEGAR(skolem_dlvl0, b, aigerlits, c);
         } else {  // certificate is an actual function, closed case split
-            cert_encode_function_for_case(skolem_dlvl0, a, &max_sym, aigerlits,
+            cert_encode_function_for_case(skolem_dlvl0, b, aigerlits,
                                           c->determinization_order, c->unique_consequences);
-            case_applies = negate(cert_encode_conflicts(skolem_dlvl0, a, &max_sym, aigerlits,
+            case_applies = negate(cert_encode_conflicts(skolem_dlvl0, b, aigerlits,
                                                         c->determinization_order,
                                                         c->potentially_conflicted_variables,
                                                         c->unique_consequences));
@@ -445,30 +462,30 @@ void c2_write_AIG_certificate(C2* c2) {
         // -- nothing to be done
         
         // (2) None of the cases applies
-        unsigned some_case_applies = aiger_false;
-        for (unsigned i = 0; i < int_vector_count(case_selectors); i++) {
-            unsigned sel = (unsigned) int_vector_get(case_selectors, i);
-            some_case_applies = aigeru_OR(a, &max_sym, some_case_applies, sel);
-        }
+        unsigned some_case_applies = aigeru_multiOR(b, case_selectors);
         
         // (3) One of the clauses with only universal variables applies
-        unsigned some_universal_violated = aiger_false;
+        int_vector* violated_aigerlits = int_vector_init();
+        int_vector* clause_aigerlits = int_vector_init();
         for (unsigned i = 0; i < int_vector_count(c2->qcnf->universal_clauses); i++) {
             unsigned universal_clause_idx = (unsigned) int_vector_get(c2->qcnf->universal_clauses, i);
             Clause* c = vector_get(c2->qcnf->all_clauses, universal_clause_idx);
             assert(c->universal_clause);
-            unsigned clause_satisfied = aiger_false;
+            int_vector_reset(clause_aigerlits);
             for (unsigned j = 0; j < c->size; j++) {
                 Lit l = c->occs[j];
                 assert(qcnf_is_universal(c2->qcnf, lit_to_var(l)));
                 unsigned al = mapped_lit2aigerlit(aigerlits, l); // universals have unique aigerlits throughout all cases
-                clause_satisfied = aigeru_OR(a, &max_sym, clause_satisfied, al);
+                int_vector_add(clause_aigerlits, (int) al);
             }
-            some_universal_violated = aigeru_OR(a, &max_sym, some_universal_violated, negate(clause_satisfied));
+            int_vector_add(violated_aigerlits, (int) negate(aigeru_multiOR(b, clause_aigerlits)));
         }
+        unsigned some_universal_violated = aigeru_multiOR(b, violated_aigerlits);
+        int_vector_free(clause_aigerlits);
+        int_vector_free(violated_aigerlits);
         
-        unsigned projection = aigeru_AND(a, &max_sym, some_case_applies, negate(some_universal_violated));
-        projection = aigeru_AND(a, &max_sym, projection, negate(dlvl0_conflict_aigerlit));
+        unsigned projection = aigeru_AND(b, some_case_applies, negate(some_universal_violated));
+        projection = aigeru_AND(b, projection, negate(dlvl0_conflict_aigerlit));
         aiger_add_output(a, projection, QUANTIFIER_ELIMINATION_OUTPUT_STRING);
         
         if (c2->options->verify) {
@@ -489,7 +506,7 @@ void c2_write_AIG_certificate(C2* c2) {
             if (num == 1) {
                 outlit_for_var = (unsigned) int_vector_get(aigerlits_for_var, 0);
             } else {
-                outlit_for_var = aigeru_multiMUX(a, &max_sym, case_selectors, aigerlits_for_var);
+                outlit_for_var = aigeru_multiMUX(b, case_selectors, aigerlits_for_var);
             }
             int_vector_set(out_aigerlits, var_id, (int) outlit_for_var);
             int_vector_free(aigerlits_for_var);
@@ -508,6 +525,19 @@ void c2_write_AIG_certificate(C2* c2) {
         
         int_vector_free(out_aigerlits);
     }
+    if (debug_verbosity >= VERBOSITY_LOW) {
+        aigeru_print_statistics(b);
+    }
+    unsigned effort = c2->options->certificate_minimization_effort;
+    if (effort > 0) {
+        aigeru_builder* minimized = aigeru_minimize(a, effort);
+        V1("  Minimized to %u AND gates and depth %u (effort %u)\n", minimized->a->num_ands, aigeru_depth(minimized), effort);
+        abortif(! cert_validate_minimization(a, minimized->a), "Minimization of the certificate is incorrect!");
+        aiger_reset(a);
+        aigeru_builder_free(b);
+        a = minimized->a;
+        b = minimized;
+    }
     cert_write_aiger(a, c2->options);
     
     abortif(!valid, "Validation of certificate invalid!");
@@ -516,5 +546,6 @@ void c2_write_AIG_certificate(C2* c2) {
     vector_free(case_aigerlits);
     int_vector_free(case_selectors);
     skolem_free(skolem_dlvl0);
+    aigeru_builder_free(b);
     aiger_reset(a);
 }
@@ -23,7 +23,7 @@ bool cert_check_UNSAT(C2* c2) {
     
     for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
         Clause* c = vector_get(c2->qcnf->all_clauses, i);
-        if (c->original) {
+        if (c && c->original) {
             for (unsigned j = 0; j < c->size; j++) {
                 satsolver_add(checker, c->occs[j]);
             }
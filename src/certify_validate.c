@@ -35,23 +35,39 @@ void cert_validate_print_assignment(aiger* a, QCNF* qcnf, SATSolver* checker, in
 //    V0("\n");
 }
 
-void cert_validate_encode_aiger(aiger* a, SATSolver* checker, int truelit) {
+// The variables of the gates are shifted by offset; inputs and constants are not
+static int cert_validate_shifted_lit(aiger* a, unsigned aigerlit, int truelit, int offset) {
+    int lit = aiger_lit2lit(aigerlit, truelit);
+    if (offset == 0 || aigerlit == aiger_true || aigerlit == aiger_false || aiger_is_input(a, aiger_strip(aigerlit))) {
+        return lit;
+    }
+    return lit > 0 ? lit + offset : lit - offset;
+}
+
+static void cert_validate_encode_gates(aiger* a, SATSolver* checker, int truelit, int offset) {
     for (unsigned i = 0; i < a->num_ands; i++) {
         aiger_and and = a->ands[i];
+        int lhs = cert_validate_shifted_lit(a, and.lhs, truelit, offset);
+        int rhs0 = cert_validate_shifted_lit(a, and.rhs0, truelit, offset);
+        int rhs1 = cert_validate_shifted_lit(a, and.rhs1, truelit, offset);
         
-        satsolver_add(checker,   aiger_lit2lit(and.rhs0, truelit));
-        satsolver_add(checker, - aiger_lit2lit(and.lhs, truelit));
+        satsolver_add(checker,   rhs0);
+        satsolver_add(checker, - lhs);
         satsolver_clause_finished(checker);
         
-        satsolver_add(checker,   aiger_lit2lit(and.rhs1, truelit));
-        satsolver_add(checker, - aiger_lit2lit(and.lhs, truelit));
+        satsolver_add(checker,   rhs1);
+        satsolver_add(checker, - lhs);
         satsolver_clause_finished(checker);
         
-        satsolver_add(checker, - aiger_lit2lit(and.rhs0, truelit));
-        satsolver_add(checker, - aiger_lit2lit(and.rhs1, truelit));
-        satsolver_add(checker,   aiger_lit2lit(and.lhs, truelit));
+        satsolver_add(checker, - rhs0);
+        satsolver_add(checker, - rhs1);
+        satsolver_add(checker,   lhs);
         satsolver_clause_finished(checker);
     }
+}
+
+void cert_validate_encode_aiger(aiger* a, SATSolver* checker, int truelit) {
+    cert_validate_encode_gates(a, checker, truelit, 0);
     assert(satsolver_sat(checker) == SATSOLVER_SAT);
 }
 
@@ -61,7 +77,7 @@ Lit cert_validate_encode_violation_of_some_clause(aiger* a, QCNF* qcnf, int_vect
     Lit some_clause_violated = - truelit;
     for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
         Clause* c = vector_get(qcnf->all_clauses, i);
-        if (qcnf_is_original_clause(qcnf, c->clause_idx)) {
+        if (qcnf_is_original_clause(qcnf, i)) {
             Lit this_clause_violated = satsolver_inc_max_var(checker);
             for (unsigned j = 0; j < c->size; j++) {
                 Lit lit = c->occs[j];
@@ -184,7 +200,7 @@ bool cert_validate_functional_synthesis(aiger* a, QCNF* qcnf, int_vector* aigerl
     // encode the qcnf in the satlits in qcnfvar2satlit
     for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
         Clause* c = vector_get(qcnf->all_clauses, i);
-        if (c->original) {
+        if (c && c->original) {
             for (unsigned j = 0; j < c->size; j++) {
                 Lit l = c->occs[j];
                 unsigned var_id = lit_to_var(l);
@@ -257,7 +273,7 @@ bool cert_validate_quantifier_elimination(aiger* a, QCNF* qcnf, int_vector* aige
     // encode the qcnf in the satlits in qcnfvar2satlit
     for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
         Clause* c = vector_get(qcnf->all_clauses, i);
-        if (c->original) {
+        if (c && c->original) {
             for (unsigned j = 0; j < c->size; j++) {
                 Lit l = c->occs[j];
                 unsigned var_id = lit_to_var(l);
@@ -287,3 +303,51 @@ bool cert_validate_quantifier_elimination(aiger* a, QCNF* qcnf, int_vector* aige
     satsolver_free(checker);
     return res == SATSOLVER_UNSAT;
 }
+
+
+// Checks that the outputs of the minimized circuit (see aigeru_minimize) equal those of the original circuit
+bool cert_validate_minimization(aiger* original, aiger* minimized) {
+#ifndef DEBUG
+    return true;
+#endif
+    V1("Validating minimization from %u to %u gates.\n", original->num_ands, minimized->num_ands);
+    assert(original->num_outputs == minimized->num_outputs);
+    SATSolver* checker = satsolver_init();
+    satsolver_set_max_var(checker, (int) (original->maxvar + minimized->maxvar));
+    
+    int truelit = satsolver_inc_max_var(checker);
+    satsolver_add(checker, truelit);
+    satsolver_clause_finished(checker);
+    
+    cert_validate_encode_gates(original, checker, truelit, 0);
+    cert_validate_encode_gates(minimized, checker, truelit, (int) original->maxvar);
+    
+    // Miter: some output differs
+    int_vector* differences = int_vector_init();
+    for (unsigned i = 0; i < original->num_outputs; i++) {
+        int x = cert_validate_shifted_lit(original, original->outputs[i].lit, truelit, 0);
+        int y = cert_validate_shifted_lit(minimized, minimized->outputs[i].lit, truelit, (int) original->maxvar);
+        int difference = satsolver_inc_max_var(checker);
+        satsolver_add(checker, - difference);
+        satsolver_add(checker, x);
+        satsolver_add(checker, y);
+        satsolver_clause_finished(checker);
+        satsolver_add(checker, - difference);
+        satsolver_add(checker, - x);
+        satsolver_add(checker, - y);
+        satsolver_clause_finished(checker);
+        int_vector_add(differences, difference);
+    }
+    for (unsigned i = 0; i < int_vector_count(differences); i++) {
+        satsolver_add(checker, int_vector_get(differences, i));
+    }
+    satsolver_clause_finished(checker);
+    
+    sat_res res = satsolver_sat(checker);
+    if (res != SATSOLVER_UNSAT) {
+        LOG_ERROR("Minimized certificate differs from the original one.");
+    }
+    int_vector_free(differences);
+    satsolver_free(checker);
+    return res == SATSOLVER_UNSAT;
+}
@@ -0,0 +1,100 @@
+//
+//  clause_arena.c
+//  cadet
+//
+
+#include "clause_arena.h"
+
+#include <assert.h>
+#include <string.h>
+
+
+#define CLAUSE_ARENA_INITIAL_BLOCK_SIZE (1 << 16)
+#define CLAUSE_ARENA_MAX_BLOCK_SIZE (1 << 24)
+#define CLAUSE_ARENA_ALIGNMENT sizeof(int)
+
+clause_arena* clause_arena_init() {
+    clause_arena* a = malloc(sizeof(clause_arena));
+    a->block_capacity = 4;
+    a->blocks = malloc(sizeof(char*) * a->block_capacity);
+    a->block_count = 0;
+    a->pos = NULL;
+    a->end = NULL;
+    a->next_block_size = CLAUSE_ARENA_INITIAL_BLOCK_SIZE;
+    a->free_lists = NULL;
+    a->free_list_count = 0;
+    a->allocated_bytes = 0;
+    a->released_bytes = 0;
+    return a;
+}
+
+void clause_arena_free(clause_arena* a) {
+    for (unsigned i = 0; i < a->block_count; i++) {
+        free(a->blocks[i]);
+    }
+    free(a->blocks);
+    free(a->free_lists);
+    free(a);
+}
+
+static void clause_arena_new_block(clause_arena* a, size_t min_bytes) {
+    size_t size = a->next_block_size;
+    if (size < min_bytes) {
+        size = min_bytes;
+    }
+    if (a->next_block_size < CLAUSE_ARENA_MAX_BLOCK_SIZE) {
+        a->next_block_size *= 2;
+    }
+    if (a->block_count == a->block_capacity) {
+        a->block_capacity *= 2;
+        a->blocks = realloc(a->blocks, sizeof(char*) * a->block_capacity);
+    }
+    char* block = malloc(size);
+    a->blocks[a->block_count++] = block;
+    a->pos = block;
+    a->end = block + size;
+}
+
+static size_t clause_arena_round(size_t bytes) {
+    return (bytes + CLAUSE_ARENA_ALIGNMENT - 1) & ~ (CLAUSE_ARENA_ALIGNMENT - 1);
+}
+
+void* clause_arena_alloc(clause_arena* a, size_t bytes) {
+    bytes = clause_arena_round(bytes);
+    size_t list = bytes / CLAUSE_ARENA_ALIGNMENT;
+    if (list < a->free_list_count && a->free_lists[list] != NULL) {
+        char* res = a->free_lists[list];
+        memcpy(&a->free_lists[list], res, sizeof(char*)); // the memory may not be aligned for pointers
+        a->released_bytes -= bytes;
+        a->allocated_bytes += bytes;
+        return res;
+    }
+    if ((size_t) (a->end - a->pos) < bytes) {
+        clause_arena_new_block(a, bytes);
+    }
+    void* res = a->pos;
+    a->pos += bytes;
+    a->allocated_bytes += bytes;
+    return res;
+}
+
+void clause_arena_release(clause_arena* a, void* memory, size_t bytes) {
+    bytes = clause_arena_round(bytes);
+    assert(bytes >= sizeof(char*));
+    size_t list = bytes / CLAUSE_ARENA_ALIGNMENT;
+    if (list >= a->free_list_count) {
+        unsigned count = a->free_list_count == 0 ? 16 : a->free_list_count;
+        while (count <= list) {
+            count *= 2;
+        }
+        a->free_lists = realloc(a->free_lists, sizeof(char*) * count);
+        for (unsigned i = a->free_list_count; i < count; i++) {
+            a->free_lists[i] = NULL;
+        }
+        a->free_list_count = count;
+    }
+    memcpy(memory, &a->free_lists[list], sizeof(char*));
+    a->free_lists[list] = memory;
+    a->allocated_bytes -= bytes;
+    a->released_bytes += bytes;
+}
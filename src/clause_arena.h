@@ -0,0 +1,39 @@
+//
+//  clause_arena.h
+//  cadet
+//
+//  Bump allocator for clauses. Clauses are placed consecutively in large blocks, so that clauses
+//  created together (e.g. all clauses of the input formula) also lie together in memory. Blocks never
+//  move, so Clause* stay valid. Released clauses (see qcnf_delete_clause) go to a free list for their
+//  size and are reused by the next clause of the same size; blocks are returned only when the whole
+//  arena is freed.
+//
+
+#ifndef clause_arena_h
+#define clause_arena_h
+
+#include <stdlib.h>
+
+typedef struct {
+    char** blocks;
+    unsigned block_count;
+    unsigned block_capacity;
+    char* pos; // next free byte in the current block
+    char* end; // end of the current block
+    size_t next_block_size;
+    
+    char** free_lists; // indexed by the size of the released memory in multiples of the alignment; linked through their first bytes
+    unsigned free_list_count;
+    
+    // Statistics
+    size_t allocated_bytes; // in use
+    size_t released_bytes; // in the free lists
+} clause_arena;
+
+clause_arena* clause_arena_init();
+void clause_arena_free(clause_arena*);
+
+void* clause_arena_alloc(clause_arena*, size_t bytes);
+void clause_arena_release(clause_arena*, void* memory, size_t bytes); // bytes must be the same as for the allocation
+
+#endif /* clause_arena_h */
@@ -49,9 +49,12 @@ conflict_analysis* conflcit_analysis_init(C2* c2) {
     conflict_analysis* ca = malloc(sizeof(conflict_analysis));
     ca->c2 = c2;
     ca->conflicting_assignment = int_vector_init();
-    ca->queue = worklist_init_unique_computation(qcnf_compare_literals_by_var_id);
+    ca->queue = worklist_init_dense(qcnf_compare_literals_by_var_id, bit_vector_index_of_lit, true);
     ca->resolution_graph = map_init();
     ca->resolutions_of_last_conflict = int_vector_init();
+    ca->learnt_clause_lbd = int_vector_init();
+    ca->learnt_clause_uses = int_vector_init();
+    ca->lbd_lvls = int_vector_init();
     
     conflict_analsysis_reset(ca);
     
@@ -63,6 +66,9 @@ void conflict_analysis_free(conflict_analysis* ca) {
     int_vector_free(ca->conflicting_assignment);
     worklist_free(ca->queue);
     int_vector_free(ca->resolutions_of_last_conflict);
+    int_vector_free(ca->learnt_clause_lbd);
+    int_vector_free(ca->learnt_clause_uses);
+    int_vector_free(ca->lbd_lvls);
     for (unsigned i = 0; i < vector_count(ca->c2->qcnf->all_clauses); i++) {
         if (map_contains(ca->resolution_graph, (int) i)) {
             int_vector* resolutions = map_get(ca->resolution_graph, (int) i);
@@ -81,6 +87,76 @@ unsigned conflict_analysis_get_decision_lvl(conflict_analysis*  ca, unsigned var
     }
 }
 
+unsigned conflict_analysis_get_lbd(conflict_analysis* ca, Clause* c) {
+    if (c->clause_idx < int_vector_count(ca->learnt_clause_lbd)) {
+        return (unsigned) int_vector_get(ca->learnt_clause_lbd, c->clause_idx);
+    }
+    return 0;
+}
+
+void conflict_analysis_set_lbd(conflict_analysis* ca, Clause* c, unsigned lbd) {
+    while (int_vector_count(ca->learnt_clause_lbd) <= c->clause_idx) {
+        int_vector_add(ca->learnt_clause_lbd, 0);
+        int_vector_add(ca->learnt_clause_uses, 0);
+    }
+    int_vector_set(ca->learnt_clause_lbd, c->clause_idx, (int) lbd);
+}
+
+unsigned conflict_analysis_get_uses(conflict_analysis* ca, Clause* c) {
+    if (c->clause_idx < int_vector_count(ca->learnt_clause_uses)) {
+        return (unsigned) int_vector_get(ca->learnt_clause_uses, c->clause_idx);
+    }
+    return 0;
+}
+
+void conflict_analysis_forget_clause(conflict_analysis* ca, Clause* c) {
+    if (c->clause_idx < int_vector_count(ca->learnt_clause_lbd)) {
+        int_vector_set(ca->learnt_clause_lbd, c->clause_idx, 0);
+        int_vector_set(ca->learnt_clause_uses, c->clause_idx, 0);
+    }
+    if (map_contains(ca->resolution_graph, (int) c->clause_idx) && ! ca->c2->options->reinforcement_learning) { // rewards follow the resolutions back
+        int_vector_free(map_get(ca->resolution_graph, (int) c->clause_idx));
+        map_remove(ca->resolution_graph, (int) c->clause_idx);
+    }
+}
+
+void conflict_analysis_reset_uses(conflict_analysis* ca) {
+    for (unsigned i = 0; i < int_vector_count(ca->learnt_clause_uses); i++) {
+        int_vector_set(ca->learnt_clause_uses, i, 0);
+    }
+}
+
+// Number of distinct decision levels among the variables of the clause; all of them must be assigned
+static unsigned conflict_analysis_compute_lbd(conflict_analysis* ca, Clause* c) {
+    int_vector_reset(ca->lbd_lvls);
+    for (unsigned i = 0; i < c->size; i++) {
+        int_vector_add(ca->lbd_lvls, (int) conflict_analysis_get_decision_lvl(ca, lit_to_var(c->occs[i])));
+    }
+    int_vector_sort(ca->lbd_lvls, compare_integers_natural_order);
+    unsigned lbd = 0;
+    for (unsigned i = 0; i < int_vector_count(ca->lbd_lvls); i++) {
+        if (i == 0 || int_vector_get(ca->lbd_lvls, i) != int_vector_get(ca->lbd_lvls, i - 1)) {
+            lbd++;
+        }
+    }
+    return lbd;
+}
+
+// Learnt clauses that serve as reasons are used, and their LBD may have decreased since they were learnt
+static void conflict_analysis_bump_learnt_clause(conflict_analysis* ca, Clause* reason) {
+    unsigned lbd = conflict_analysis_get_lbd(ca, reason);
+    if (lbd == 0) {
+        return;
+    }
+    int_vector_set(ca->learnt_clause_uses, reason->clause_idx, int_vector_get(ca->learnt_clause_uses, reason->clause_idx) + 1);
+    if (lbd > 2) {
+        unsigned new_lbd = conflict_analysis_compute_lbd(ca, reason);
+        if (new_lbd < lbd) {
+            conflict_analysis_set_lbd(ca, reason, new_lbd);
+        }
+    }
+}
+
 void conflict_analysis_schedule_causing_vars_in_work_queue(conflict_analysis* ca, Clause* reason, Lit consequence) {
     assert(consequence != 0);
     assert(lit_to_var(consequence) < var_vector_count(ca->c2->qcnf->vars));
@@ -107,7 +183,7 @@ void conflict_analysis_schedule_causing_vars_in_work_queue(conflict_analysis* ca
         assert(ca->domain_get_value(ca->domain, -l) == 1);
         
         // activity heuristics
-        if (!set_contains(ca->queue->s, (void*) (int64_t) - l)) {
+        if (!worklist_contains(ca->queue, (void*) (int64_t) - l)) {
             c2_increase_activity(ca->c2, (unsigned) abs(l), ca->c2->magic.activity_bump_value);
         }
         
@@ -145,7 +221,7 @@ bool is_reason_for_lit(conflict_analysis* ca, Clause* c, Lit lit) {
 unsigned determine_cost(conflict_analysis* ca, Clause* c) {
     unsigned cost = 0;
     for (unsigned i = 0; i < c->size; i++) {
-        if (! set_contains(ca->queue->s, (void*)(int64_t) - c->occs[i])) {
+        if (! worklist_contains(ca->queue, (void*)(int64_t) - c->occs[i])) {
             cost++;
         }
     }
@@ -204,6 +280,7 @@ void conflict_analysis_follow_implication_graph(conflict_analysis* ca) {
                         qcnf_print_clause(reason, stdout);
                     }
                     int_vector_add(ca->resolutions_of_last_conflict, (int) reason->clause_idx);
+                    conflict_analysis_bump_learnt_clause(ca, reason);
                     conflict_analysis_schedule_causing_vars_in_work_queue(ca, reason, lit);
                 } else {
                     assert(skolem_is_decision_var(ca->c2->skolem, lit_to_var(lit)) || lit_to_var(lit) == ca->conflicted_var_id);
@@ -213,10 +290,10 @@ void conflict_analysis_follow_implication_graph(conflict_analysis* ca) {
                 abortif(ca->c2->state == C2_SKOLEM_CONFLICT
                         && ! skolem_is_decision_var(ca->c2->skolem, var_id)
                         && ! int_vector_contains(ca->c2->skolem->universals_assumptions, lit)
+                        && ! int_vector_contains(ca->c2->active_assumptions, lit)
                         && ! qcnf_is_universal(ca->c2->qcnf, var_id),
                         "No reason for lit %d found in conflict analysis.\n", lit);
-                int_vector_add(ca->conflicting_assignment, lit);
-                // TODO: this is where assumptions for incremental solving would come in
+                int_vector_add(ca->conflicting_assignment, lit); // decisions and assumptions (see c2_push_assumptions)
             }
         }
     }
@@ -324,8 +401,12 @@ Clause* analyze_conflict(conflict_analysis* ca,
         qcnf_add_lit(ca->c2->qcnf, - int_vector_get(ca->conflicting_assignment, i));
     }
     Clause* c = qcnf_close_clause(ca->c2->qcnf);
+    if (c == NULL && c2_has_active_assumptions(ca->c2)) {
+        return NULL; // an existing clause contradicts the assumptions; see c2_assumptions_refuted
+    }
     abortif(!c, "Learnt clause could not be created");
     c->original = 0;
+    conflict_analysis_set_lbd(ca, c, conflict_analysis_compute_lbd(ca, c));
     map_add(ca->resolution_graph, (int) c->clause_idx, ca->resolutions_of_last_conflict);
     ca->resolutions_of_last_conflict = int_vector_init();
     c2_rl_new_clause(c);
@@ -31,6 +31,11 @@ struct conflict_analysis {
     
     map* resolution_graph; // mapping clause_idxs of learnt clauses to int_vectors holding clause_idxs they are derived from.
     int_vector* resolutions_of_last_conflict; // containing clause idxs that were 'reasons' in last conflict
+    
+    // Quality of learnt clauses for the clause database reduction; indexed by clause_idx
+    int_vector* learnt_clause_lbd; // number of distinct decision levels of the literals (glue); 0 for clauses that must not be deleted
+    int_vector* learnt_clause_uses; // number of conflicts in which the clause was a reason since the last reduction
+    int_vector* lbd_lvls; // scratch space for computing the LBD
 };
 
 conflict_analysis* conflcit_analysis_init(C2* c2);
@@ -45,5 +50,10 @@ Clause* analyze_conflict(conflict_analysis* ca,
                                         bool (*domain_is_legal_dependence)(void* domain, unsigned var_id, unsigned depending_on),
                                         unsigned (*domain_get_decision_lvl)(void* domain, unsigned var_id));
 
+unsigned conflict_analysis_get_lbd(conflict_analysis*, Clause*); // 0 if the clause is not a deletable learnt clause
+void conflict_analysis_set_lbd(conflict_analysis*, Clause*, unsigned lbd);
+unsigned conflict_analysis_get_uses(conflict_analysis*, Clause*);
+void conflict_analysis_reset_uses(conflict_analysis*);
+void conflict_analysis_forget_clause(conflict_analysis*, Clause*); // before the clause is deleted
 
 #endif /* conflict_analysis_h */
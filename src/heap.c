@@ -135,27 +135,49 @@ worklist* worklist_init(heap_comparator c) {
     worklist* w = malloc(sizeof(worklist));
     w->h = heap_init(c);
     w->s = set_init();
+    w->dense = NULL;
+    w->index = NULL;
     w->unique_computation = false;
     return w;
 }
+worklist* worklist_init_dense(heap_comparator c, dense_index_function index, bool unique_computation) {
+    worklist* w = malloc(sizeof(worklist));
+    w->h = heap_init(c);
+    w->s = NULL;
+    w->dense = bit_vector_init_growable();
+    w->index = index;
+    w->unique_computation = unique_computation;
+    return w;
+}
 void worklist_free(worklist* w) {
     heap_free(w->h);
-    set_free(w->s);
+    if (w->s) {set_free(w->s);}
+    if (w->dense) {bit_vector_free(w->dense);}
     free(w);
 }
 unsigned worklist_count(worklist* w) {
-    assert(w->unique_computation || heap_count(w->h) == set_count(w->s));
+    assert(w->unique_computation || w->dense || heap_count(w->h) == set_count(w->s));
     return heap_count(w->h);
 }
 void worklist_push(worklist* w, void* data) {
-    if (!set_contains(w->s, data)) {
+    if (!worklist_contains(w, data)) {
         heap_push(w->h, data);
-        set_add(w->s, data);
+        if (w->dense) {
+            bit_vector_add(w->dense, w->index(data));
+        } else {
+            set_add(w->s, data);
+        }
     }
 }
 void* worklist_pop(worklist* w) {
     void* data = heap_pop(w->h);
-    if (!w->unique_computation) {set_remove(w->s, data);}
+    if (!w->unique_computation) {
+        if (w->dense) {
+            bit_vector_remove(w->dense, w->index(data));
+        } else {
+            set_remove(w->s, data);
+        }
+    }
     return data;
 }
 void* worklist_peek(worklist* w) {
@@ -165,9 +187,16 @@ void* worklist_get(worklist* w, unsigned pos) {
     return heap_get(w->h, pos);
 }
 bool worklist_contains(worklist* w, void* data) {
+    if (w->dense) {
+        return bit_vector_contains(w->dense, w->index(data));
+    }
     return set_contains(w->s, data);
 }
 void worklist_reset(worklist* w) {
     vector_reset(w->h->vector);
-    set_reset(w->s);
+    if (w->dense) {
+        bit_vector_reset(w->dense);
+    } else {
+        set_reset(w->s);
+    }
 }
@@ -11,6 +11,7 @@
 
 #include "vector.h"
 #include "set.h"
+#include "bit_vector.h"
 
 typedef int (*heap_comparator)(const void*, const void*);
 
@@ -33,12 +34,15 @@ void heap_test();
 
 typedef struct {
     heap* h;
-    set* s;
+    set* s; // membership, if elements have no dense index
+    bit_vector* dense; // membership by dense index; NULL if the set is used
+    dense_index_function index;
     bool unique_computation;
 } worklist;
 
 worklist* worklist_init(heap_comparator);
 worklist* worklist_init_unique_computation(heap_comparator);
+worklist* worklist_init_dense(heap_comparator, dense_index_function, bool unique_computation);
 void worklist_free(worklist*);
 unsigned worklist_count(worklist*);
 void worklist_push(worklist*, void*);
@@ -8,7 +8,7 @@
 
 #include "log.h"
 
-int debug_verbosity = VERBOSITY_NONE;
-bool log_qdimacs_compliant = false;
-bool log_colors = true;
-bool log_silent = false;
+_Thread_local int debug_verbosity = VERBOSITY_NONE;
+_Thread_local bool log_qdimacs_compliant = false;
+_Thread_local bool log_colors = true;
+_Thread_local bool log_silent = false;
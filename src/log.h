@@ -36,10 +36,18 @@
 #define KORANGE  "\x1B[38;5;202m"
 #define KORANGE_BOLD  "\x1B[01;38;5;202m"
 
-int debug_verbosity;
-bool log_qdimacs_compliant;
-bool log_colors;
-bool log_silent;
+#ifdef __cplusplus
+#define LOG_THREAD_LOCAL thread_local
+#else
+#define LOG_THREAD_LOCAL _Thread_local
+#endif
+
+// Thread-local, so that solvers running in parallel threads (see c2_portfolio.h) can log independently.
+// New threads start with the defaults from log.c.
+extern LOG_THREAD_LOCAL int debug_verbosity;
+extern LOG_THREAD_LOCAL bool log_qdimacs_compliant;
+extern LOG_THREAD_LOCAL bool log_colors;
+extern LOG_THREAD_LOCAL bool log_silent;
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wgnu-zero-variadic-macro-arguments"
@@ -123,6 +123,25 @@ int main(int argc, const char* argv[]) {
                         options->certificate_type = QBFCERT;
                     } else if (strcmp(argv[i], "--qaiger") == 0) {
                         options->certificate_type = QAIGER;
+                    } else if (strcmp(argv[i], "--unbalanced_gates") == 0) {
+                        options->certificate_balanced_gates = false;
+                    } else if (strcmp(argv[i], "--minimize_certificate") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing effort level for argument --minimize_certificate\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->certificate_minimization_effort = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->certificate_minimization_effort > 3, "Effort levels for certificate minimization range from 0 to 3.");
+                        i++;
+                    } else if (strcmp(argv[i], "--write_binary") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("File name for binary formula missing.\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->binary_file_name = argv[i+1];
+                        i++;
                     } else if (strcmp(argv[i], "--qdimacs_out") == 0) {
                         log_qdimacs_compliant = !log_qdimacs_compliant;
                         log_colors = false;
@@ -140,12 +159,66 @@ int main(int argc, const char* argv[]) {
                         i++;
                     } else if (strcmp(argv[i], "--case_splits") == 0) {
                         options->casesplits = ! options->casesplits;
+                    } else if (strcmp(argv[i], "--probe_threads") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of threads for argument --probe_threads\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->casesplits_probe_threads = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->casesplits_probe_threads > 256, "Parallel probing supports at most 256 threads.");
+                        i++;
                     } else if (strcmp(argv[i], "--fresh_seed") == 0) {
                         options->fresh_random_seed = true;
+                    } else if (strcmp(argv[i], "--portfolio") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of threads for argument --portfolio\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->portfolio_threads = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->portfolio_threads > 256, "Portfolio supports at most 256 threads.");
+                        i++;
+                    } else if (strcmp(argv[i], "--time_limit") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of seconds for argument --time_limit\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->time_limit = strtod(argv[i+1], NULL);
+                        abortif(options->time_limit < 0, "Time limit must not be negative.");
+                        i++;
+                    } else if (strcmp(argv[i], "--mem_limit") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of megabytes for argument --mem_limit\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->mem_limit = (unsigned) strtol(argv[i+1], NULL, 0);
+                        i++;
                     } else if (strcmp(argv[i], "--random_decisions") == 0) {
                         options->random_decisions = true;
                     } else if (strcmp(argv[i], "--minimize") == 0) {
                         options->minimize_learnt_clauses = ! options->minimize_learnt_clauses;
+                    } else if (strcmp(argv[i], "--delete_clauses") == 0) {
+                        options->delete_clauses_on_restarts = ! options->delete_clauses_on_restarts;
+                    } else if (strcmp(argv[i], "--reduction_interval") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of clauses for argument --reduction_interval\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->clause_reduction_interval = (unsigned) strtol(argv[i+1], NULL, 0);
+                        abortif(options->clause_reduction_interval == 0, "The reduction interval must be positive.");
+                        i++;
+                    } else if (strcmp(argv[i], "--reduction_increment") == 0) {
+                        if (i + 1 >= argc) {
+                            LOG_ERROR("Missing number of clauses for argument --reduction_increment\n");
+                            print_usage(argv[0]);
+                            return 1;
+                        }
+                        options->clause_reduction_increment = (unsigned) strtol(argv[i+1], NULL, 0);
+                        i++;
                     } else if (strcmp(argv[i], "--miniscoping") == 0) {
                         options->miniscoping = ! options->miniscoping;
                     } else if (strcmp(argv[i], "--miniscoping_info") == 0) {
@@ -4,13 +4,16 @@
 #include "util.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 
-#define INITIAL_MAP_SIZE 10
+#define INITIAL_MAP_SIZE 8
+#define MAP_MAX_DIST 255 // the distance array uses one byte per slot; longer probe sequences trigger a resize
+#define MAP_NOT_FOUND ((size_t) -1)
 
-int map_hash_function(int key, size_t size) {
-    return hash32shiftmult(key) % (int) size;
+static inline size_t map_home_slot(map* container, int key) {
+    return (size_t) (unsigned) hash32shiftmult(key) & (container->size - 1);
 }
 
 map* map_init() {
@@ -18,123 +21,146 @@ map* map_init() {
 }
 
 map* map_init_size(size_t size) {
+    size_t slots = INITIAL_MAP_SIZE;
+    while (slots < size) {
+        slots *= 2;
+    }
     map* container = malloc(sizeof(map));
-    container->data = calloc(sizeof(map_entry*), size);
+    container->keys = malloc(sizeof(int) * slots);
+    container->data = malloc(sizeof(void*) * slots);
+    container->dist = calloc(sizeof(uint8_t), slots);
     container->count = 0;
-    container->size = size;
+    container->size = slots;
     return container;
 }
 
-map_entry* map_get_entry(map* container, int key) {
-    int hash = map_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    map_entry* entry = container->data[hash];
-    while (entry != NULL && entry->key != key) {
-        entry = entry->next;
+static size_t map_find(map* container, int key) {
+    size_t mask = container->size - 1;
+    size_t i = map_home_slot(container, key);
+    for (unsigned d = 1; d <= container->dist[i]; d++) { // Robin Hood: key cannot be behind a slot closer to its home
+        if (container->dist[i] == d && container->keys[i] == key) {
+            return i;
+        }
+        i = (i + 1) & mask;
     }
-    return entry;
+    return MAP_NOT_FOUND;
 }
 
 bool map_contains(map* container, int key) {
-    return map_get_entry(container, key) != NULL;
+    return map_find(container, key) != MAP_NOT_FOUND;
 }
 
 void* map_get(map* container, int key) {
-    map_entry* entry = map_get_entry(container, key);
-    assert(entry != NULL);
-    assert(entry->key == key);
-    return entry->data;
+    size_t i = map_find(container, key);
+    assert(i != MAP_NOT_FOUND);
+    assert(container->keys[i] == key);
+    return container->data[i];
 }
 
 // Same as map_add, but works only if the element is already in the map
 void map_update(map* container, int key, void* data) {
-    map_entry* entry = map_get_entry(container, key);
-    assert(entry != NULL);
-    entry->data = data;
+    size_t i = map_find(container, key);
+    assert(i != MAP_NOT_FOUND);
+    container->data[i] = data;
+}
+
+// Places the entry without checking the load factor
+static void map_insert(map* container, int key, void* data) {
+    size_t mask = container->size - 1;
+    size_t i = map_home_slot(container, key);
+    unsigned d = 1;
+    while (container->dist[i] != 0) {
+        if (container->dist[i] < d) { // take the slot from the richer entry, continue with that one
+            int displaced_key = container->keys[i];
+            void* displaced_data = container->data[i];
+            unsigned displaced_dist = container->dist[i];
+            container->keys[i] = key;
+            container->data[i] = data;
+            container->dist[i] = (uint8_t) d;
+            key = displaced_key;
+            data = displaced_data;
+            d = displaced_dist;
+        }
+        i = (i + 1) & mask;
+        d++;
+        if (d == MAP_MAX_DIST) {
+            map_resize(container, 2 * container->size);
+            map_insert(container, key, data);
+            return;
+        }
+    }
+    container->keys[i] = key;
+    container->data[i] = data;
+    container->dist[i] = (uint8_t) d;
 }
 
 void map_add(map* container, int key, void* data) {
     assert(!map_contains(container, key));
-    int hash = map_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    map_entry* new_entry = malloc(sizeof(map_entry));
-    new_entry->key = key;
-    new_entry->data = data;
-    new_entry->next = container->data[hash];
-    container->data[hash] = new_entry;
-    
     container->count++;
-    
-    if (container->count > container->size + container->size / 2) {
+    if (4 * container->count > 3 * container->size) {
         map_resize(container, 2 * container->size);
     }
+    map_insert(container, key, data);
 }
 
 void map_resize(map* container, size_t new_size) {
 //    V4("Resizing container to size %zu\n", new_size);
     size_t old_size = container->size;
-    map_entry** old_data = container->data;
+    int* old_keys = container->keys;
+    void** old_data = container->data;
+    uint8_t* old_dist = container->dist;
     
-    container->size = new_size;
-    container->data = calloc(sizeof(map_entry*), new_size);
+    size_t slots = INITIAL_MAP_SIZE;
+    while (slots < new_size || 4 * container->count > 3 * slots) {
+        slots *= 2;
+    }
+    container->size = slots;
+    container->keys = malloc(sizeof(int) * slots);
+    container->data = malloc(sizeof(void*) * slots);
+    container->dist = calloc(sizeof(uint8_t), slots);
     
     for (size_t i = 0; i < old_size; i++) {
-        map_entry* entry = old_data[i];
-        while (entry != NULL) {
-            map_entry* next = entry->next;
-            int new_hash = map_hash_function(entry->key, container->size);
-            assert(new_hash >= 0 && new_hash < (int) container->size);
-            
-            entry->next = container->data[new_hash];
-            container->data[new_hash] = entry;
-            
-            entry = next;
+        if (old_dist[i] != 0) {
+            map_insert(container, old_keys[i], old_data[i]);
         }
     }
     
+    free(old_keys);
     free(old_data);
+    free(old_dist);
 }
 
 void map_remove(map* container, int key) {
-    int hash = map_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    map_entry* entry = container->data[hash];
-    map_entry* prev = NULL;
-    while (entry != NULL && entry->key != key) {
-        prev = entry;
-        entry = entry->next;
-    }
-    if (entry == NULL) {
+    size_t i = map_find(container, key);
+    if (i == MAP_NOT_FOUND) {
         return;
     }
-    
-    if (prev == NULL) {
-        container->data[hash] = entry->next;
-    } else {
-        prev->next = entry->next;
+    container->count--;
+    // Backward shift deletion: move the following displaced entries one slot closer to their home
+    size_t mask = container->size - 1;
+    size_t next = (i + 1) & mask;
+    while (container->dist[next] > 1) {
+        container->keys[i] = container->keys[next];
+        container->data[i] = container->data[next];
+        container->dist[i] = (uint8_t) (container->dist[next] - 1);
+        i = next;
+        next = (next + 1) & mask;
     }
-    
-    free(entry);
+    container->dist[i] = 0;
 }
 
 void map_reset(map* container) {
-    for (size_t i = 0; i < container->size; i++) {
-        map_entry* next_e;
-        for (map_entry* e = container->data[i]; e != NULL; e = next_e) {
-            next_e = e->next;
-            free(e);
-        }
-        container->data[i] = 0;
+    if (map_count(container) == 0) {
+        return;
     }
+    memset(container->dist, 0, sizeof(uint8_t) * container->size);
     container->count = 0;
 }
 
 void map_free(map* container) {
-    map_reset(container);
+    free(container->keys);
     free(container->data);
+    free(container->dist);
     free(container);
 }
 
@@ -3,20 +3,15 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-struct map_entry;
-typedef struct map_entry map_entry;
-
-struct map_entry {
-    int        key;
-    void*      data;
-    map_entry* next;
-};
-
+// Open addressing with linear probing and Robin Hood displacement; see set.h
 struct map {
-    map_entry** data;
-    size_t      size;
-    size_t      count;
+    int*     keys;
+    void**   data;
+    uint8_t* dist;  // 1 + distance of the key from its home slot; 0 for empty slots
+    size_t   size;  // number of slots, always a power of two
+    size_t   count;
 };
 
 typedef struct map map;
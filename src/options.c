@@ -38,7 +38,9 @@ Options* default_options() {
     o->use_qbf_engine_also_for_propositional_problems = false;
     o->casesplits = false;
     o->casesplits_cubes = false;
+    o->casesplits_probe_threads = 0;
     o->random_decisions = false;
+    o->portfolio_threads = 0;
 
     // Examples domain
     o->examples_max_num = 0; // 0 corresponds to not doing examples at all
@@ -53,6 +55,10 @@ Options* default_options() {
     o->certify_SAT = false;
     o->certificate_file_name = NULL;
     o->certificate_type = CAQECERT;
+    o->certificate_balanced_gates = true;
+    o->certificate_minimization_effort = 2;
+    
+    o->binary_file_name = NULL;
 
     // Optimizations
     o->plaisted_greenbaum_completion = false; // pure literal detection is better
@@ -60,7 +66,9 @@ Options* default_options() {
     o->miniscoping = false;
     o->find_smallest_reason = true;
     o->minimize_learnt_clauses = true;
-    o->delete_clauses_on_restarts = false;
+    o->delete_clauses_on_restarts = true;
+    o->clause_reduction_interval = 2000;
+    o->clause_reduction_increment = 300;
     o->pure_literals = true;
     o->enhanced_pure_literals = false;
 
@@ -79,6 +87,8 @@ Options* default_options() {
     o->rl_slim_state = false;
     o->reinforcement_learning_mock = false;
     o->hard_decision_limit = 0;  // 0 means no limit
+    o->time_limit = 0;
+    o->mem_limit = 0;
     o->verify = 1;
     return o;
 }
@@ -99,17 +109,27 @@ char* options_get_help() {
     "\t--qbfcert\t\tWrite certificate in qbfcert-readable format.\n\t\t\t\tOnly compatible with aag file ending.\n"
     "\t--caqecert\t\tWrite certificate in caqecert format (default)\n"
     "\t--qaiger\t\tWrite certificate in qaiger format\n"
+    "\t--unbalanced_gates\tBuild multi-input gates of certificates as chains\n\t\t\t\tinstead of balanced trees (default %d)\n"
+    "\t--minimize_certificate [0-3]\tEffort for minimizing certificates before writing\n\t\t\t\tthem; 0 switches minimization off (default %u)\n"
+    "\t--write_binary [file]\tWrite the formula after preprocessing in binary format.\n\t\t\t\tBinary files are recognized when reading.\n"
     "\n  Options for the QBF engine\n"
     "\t--debugging \t\tEasy debugging configuration (default %d)\n"
     "\t--cegar\t\t\tUse CEGAR refinements in addition to clause learning\n\t\t\t\t(default %d)\n"
     "\t--cegar_only\t\tUse CEGAR strategy exclusively (default %d)\n"
     "\t--case_splits \t\tCase distinctions (default %d) \n"
+    "\t--probe_threads [N]\tProbe the literals for case distinctions in N\n\t\t\t\tparallel threads (default %u)\n"
     "\t--sat_by_qbf\t\tUse QBF engine also for propositional problems\n\t\t\t\t(default %d)\n"
     "\t--miniscoping \t\tEnables miniscoping (default %d)\n"
     "\t--minimize \t\tConflict minimization (default %d) \n"
+    "\t--delete_clauses \tPeriodically delete learnt clauses with high LBD\n\t\t\t\t(default %d)\n"
+    "\t--reduction_interval [N]\tAdded clauses before the first deletion of\n\t\t\t\tlearnt clauses (default %u)\n"
+    "\t--reduction_increment [N]\tGrowth of the interval after each deletion\n\t\t\t\t(default %u)\n"
     "\t--pure_literals\t\tUse pure literal detection (default %d)\n"
     "\t--fresh_seed\t\tUse a fresh random seed for every initialization of\n\t\t\t\tthe solver (default false)\n"
+    "\t--portfolio [N]\t\tSolve with N diversified configurations in parallel\n\t\t\t\tthreads; first result wins (default %u)\n"
     "\t-l [N]\t\t\tStop after N decisions; return UNKNONW (30).\n"
+    "\t--time_limit [sec]\tStop after the given wall-clock time; return UNKNOWN\n\t\t\t\t(30) and print statistics.\n"
+    "\t--mem_limit [MB]\tStop when the peak memory of the process (all threads)\n\t\t\t\texceeds the limit; return UNKNOWN (30) and print\n\t\t\t\tstatistics.\n"
 //    "\t--enhanced_pure_literals\tUse enhanced pure literal detection (default %d)\n"
 //    "\t--qbce\t\t\tBlocked clause elimination (default %d)\n"
 //    "\t--pg\t\t\tPlaisted Greenbaum completion (default %d).\n"
@@ -135,14 +155,21 @@ char* options_get_help() {
     "\t--rl_self_reward_factor \t\t(default %f)\n"
     "\n",
     debug_verbosity,
+    ! o->certificate_balanced_gates,
+    o->certificate_minimization_effort,
     o->easy_debugging,
     o->cegar,
     o->cegar_only,
     o->casesplits,
+    o->casesplits_probe_threads,
     o->use_qbf_engine_also_for_propositional_problems,
     o->miniscoping,
     o->minimize_learnt_clauses,
+    o->delete_clauses_on_restarts,
+    o->clause_reduction_interval,
+    o->clause_reduction_increment,
     o->pure_literals,
+    o->portfolio_threads,
 //    o->enhanced_pure_literals,
 //    o->qbce,
 //    o->plaisted_greenbaum_completion,
@@ -165,6 +192,12 @@ char* options_get_help() {
 
 void options_print(Options* o) {
     V1("Decision limit: %u\n", o->hard_decision_limit);
+    if (o->time_limit != 0) {
+        V1("Time limit: %.1f seconds\n", o->time_limit);
+    }
+    if (o->mem_limit != 0) {
+        V1("Memory limit: %u MB\n", o->mem_limit);
+    }
 }
 
 void options_free(Options* o) {
@@ -38,6 +38,8 @@ typedef struct {
     bool rl_slim_state;
     bool reinforcement_learning_mock; // for testing reinforcement learning code
     unsigned hard_decision_limit;
+    double time_limit; // in seconds, measured from the initialization of the solver; 0 means no limit
+    unsigned mem_limit; // in megabytes; 0 means no limit
     bool verify;
     
     // Use a configuration of CADET 2 that is easier to debug than the
@@ -50,6 +52,7 @@ typedef struct {
     bool use_qbf_engine_also_for_propositional_problems;
     unsigned examples_max_num;
     bool random_decisions;
+    unsigned portfolio_threads; // number of diversified configurations solved in parallel threads; 0 or 1 for a single configuration
     
     // Aiger interpretations
     const char* aiger_controllable_input_prefix;
@@ -61,10 +64,16 @@ typedef struct {
     bool certify_SAT;
     const char* certificate_file_name;
     function_output_format certificate_type;
+    bool certificate_balanced_gates; // multi-input gates as balanced trees instead of chains; see aigeru_builder
+    unsigned certificate_minimization_effort; // 0 writes certificates as generated; see aigeru_minimize
+    
+    // Binary formula output; written after parsing and preprocessing
+    const char* binary_file_name;
     
     // Case splits
     bool casesplits;
     bool casesplits_cubes; // old case split code
+    unsigned casesplits_probe_threads; // threads that probe the candidate literals of case splits; 0 or 1 to probe sequentially
     
     // Optimizations
     bool plaisted_greenbaum_completion;
@@ -74,6 +83,8 @@ typedef struct {
     bool minimize_learnt_clauses;
     bool preprocess;
     bool delete_clauses_on_restarts;
+    unsigned clause_reduction_interval; // added clauses before the first reduction of learnt clauses
+    unsigned clause_reduction_increment; // the interval grows by this many clauses after each reduction
     bool pure_literals;
     bool enhanced_pure_literals;
     bool failed_literals;
@@ -25,6 +25,12 @@
 //  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
 #include "cadet_internal.h"
 
 #include "util.h"
@@ -33,38 +39,136 @@
 #include "aiger.h"
 #include "aiger_utils.h"
 #include "c2_rl.h"
+#include "qcnf_binary.h"
 
 #include <string.h>
 #include <assert.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* The part of a QDIMACS file after the header. Regular files are mapped into memory; for pipes and
+ * stdin the rest of the stream is read into a buffer with large reads.
+ */
+typedef struct {
+    char* data;
+    size_t size;
+    bool is_mapped;
+    const char* pos;
+    const char* end;
+    int line_num;
+} QDIMACS_Input;
+
+static void qdimacs_input_init(QDIMACS_Input* in, FILE* file, int line_num) {
+    in->line_num = line_num;
+    in->is_mapped = false;
+    
+    long offset = ftell(file); // accounts for the header already read through the FILE buffer
+    struct stat st;
+    if (offset >= 0 && fstat(fileno(file), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > offset) {
+        void* data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+        if (data != MAP_FAILED) {
+            posix_madvise(data, (size_t) st.st_size, POSIX_MADV_SEQUENTIAL);
+            in->data = data;
+            in->size = (size_t) st.st_size;
+            in->is_mapped = true;
+            in->pos = in->data + offset;
+            in->end = in->data + in->size;
+            return;
+        }
+    }
+    
+    size_t capacity = 1 << 20;
+    in->data = malloc(capacity);
+    in->size = 0;
+    size_t n = 0;
+    while ((n = fread(in->data + in->size, 1, capacity - in->size, file)) > 0) {
+        in->size += n;
+        if (in->size == capacity) {
+            capacity *= 2;
+            in->data = realloc(in->data, capacity);
+        }
+    }
+    in->pos = in->data;
+    in->end = in->data + in->size;
+}
 
-inline static void skip_space(char* buffer, size_t* pos) {
-    while (buffer[*pos] == ' ') {
-        (*pos)++;
+static void qdimacs_input_free(QDIMACS_Input* in) {
+    if (in->is_mapped) {
+        munmap(in->data, in->size);
+    } else {
+        free(in->data);
     }
 }
 
-static inline int create_lit(int var, bool negated) { return negated ? -var : var; }
+static inline bool qdimacs_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline void qdimacs_skip_space(QDIMACS_Input* in) {
+    while (in->pos < in->end && (*in->pos == ' ' || *in->pos == '\t')) {
+        in->pos++;
+    }
+}
 
-inline static int get_next_lit(char* buffer, size_t* pos, int line_num) {
-    if (!(buffer[*pos] == '-' || (buffer[*pos] >= '0' && buffer[*pos] <= '9'))) {
-        V1("Unexpected character: %c (ascii: %d) in line %d char %zu\n",buffer[*pos],buffer[*pos],line_num,*pos);
-        assert(false);
+static inline void qdimacs_skip_line(QDIMACS_Input* in) {
+    while (in->pos < in->end && *in->pos != '\n') {
+        in->pos++;
+    }
+    if (in->pos < in->end) {
+        in->pos++;
+        in->line_num++;
     }
-    bool negated = (buffer[*pos] == '-');
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Number of leading ASCII digits in the eight characters of chunk; the first character is in the lowest byte.
+static inline unsigned swar_count_leading_digits(uint64_t chunk) {
+    uint64_t high_nibbles = chunk & 0xF0F0F0F0F0F0F0F0ULL;
+    uint64_t shifted_high_nibbles = ((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4;
+    uint64_t diff = (high_nibbles | shifted_high_nibbles) ^ 0x3333333333333333ULL; // zero bytes are digits
+    uint64_t digit_bytes = ~(((diff & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | diff | 0x7F7F7F7F7F7F7F7FULL);
+    uint64_t non_digit_bytes = ~digit_bytes & 0x8080808080808080ULL;
+    return non_digit_bytes ? (unsigned) __builtin_ctzll(non_digit_bytes) / 8 : 8;
+}
+
+// Value of the first n (1 to 8) characters of chunk, which must be digits.
+static inline unsigned swar_parse_digits(uint64_t chunk, unsigned n) {
+    assert(n >= 1 && n <= 8);
+    uint64_t val = (chunk & 0x0F0F0F0F0F0F0F0FULL) << (8 * (8 - n)); // missing digits become leading zeros
+    val = (val * 10) + (val >> 8);
+    val = (((val & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+           + (((val >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return (unsigned) val;
+}
+#endif
+
+static inline int qdimacs_read_lit(QDIMACS_Input* in) {
+    bool negated = in->pos < in->end && *in->pos == '-';
     if (negated) {
-        (*pos)++;
+        in->pos++;
     }
-    int var = 0;
-    if (!(buffer[*pos] >= '0' && buffer[*pos] <= '9')) {
-        V1("Unexpected digit: %c (ascii: %d) in line %d char %zu\n",buffer[*pos],buffer[*pos],line_num,*pos);
-        abort();
+    abortif(in->pos >= in->end || ! qdimacs_is_digit(*in->pos),
+            "Unexpected character in line %d: %c (ascii: %d)", in->line_num, in->pos < in->end ? *in->pos : ' ', in->pos < in->end ? *in->pos : 0);
+    long var = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (in->end - in->pos >= 8) { // scan up to eight digits at once
+        uint64_t chunk;
+        memcpy(&chunk, in->pos, 8);
+        unsigned n = swar_count_leading_digits(chunk);
+        var = swar_parse_digits(chunk, n);
+        in->pos += n;
     }
-    while (buffer[*pos] >= '0' && buffer[*pos] <= '9') {
-        var = (var * 10) + (buffer[*pos] - '0');
-        (*pos)++;
+#endif
+    while (in->pos < in->end && qdimacs_is_digit(*in->pos)) {
+        var = (var * 10) + (*in->pos - '0');
+        abortif(var > INT_MAX, "Variable index too large in line %d.", in->line_num);
+        in->pos++;
     }
-    return create_lit(var, negated);
+    return negated ? - (int) var : (int) var;
 }
 
 // Has to be called with line being the header from the QDIMACS file.
@@ -76,12 +180,6 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
     size_t var_num;
     size_t clause_num;
     sscanf(header, "p cnf %zd %zd", &var_num, &clause_num);
-    int log_of_var_num = 0;
-    size_t var_num_copy = var_num;
-    while (var_num_copy >>= 1) log_of_var_num++;
-    int len = 10 + (log_of_var_num + 2) * (int)var_num; // assuming that literals don't repeat too often within a clause
-    assert(len >= 0);
-    char* line = malloc((size_t)len);
     
     V3("File indicates %zu variables and %zu clauses.\n", var_num, clause_num);
     
@@ -92,61 +190,65 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
     vector* dependency_sets = vector_init();
     int_vector* dependency_variables = int_vector_init();
     
+    QDIMACS_Input in;
+    qdimacs_input_init(&in, file, line_num);
+    
     // Parse the quantifier part
     unsigned qlvl = 0;
-    while (fgets(line, len, file)) {
-        line_num++;
-        size_t pos = 0;
+    while (in.pos < in.end) {
+        bool is_quantifier = true;
         bool is_dependency_quantifier = false;
         
-        switch (line[0]) {
+        switch (*in.pos) {
             case 'e':
                 if (qlvl%2 == 1) {
                     qlvl++;
                 } else if (qlvl != 0) {
-                    V0("Warning: Consecutive quantifiers of the same type are not allowed in the DIMACS/QDIMACS/DQDIMACS standard (line %d)\n", line_num);
+                    V0("Warning: Consecutive quantifiers of the same type are not allowed in the DIMACS/QDIMACS/DQDIMACS standard (line %d)\n", in.line_num + 1);
                 }
                 assert(qlvl%2 == 0);
-                pos++;
                 break;
             case 'a':
                 if (qlvl%2 == 0) {
                     qlvl++;
                 } else {
-                    V0("Warning: Consecutive quantifiers of the same type are not allowed in the DIMACS/QDIMACS/DQDIMACS standard (line %d).\n", line_num);
+                    V0("Warning: Consecutive quantifiers of the same type are not allowed in the DIMACS/QDIMACS/DQDIMACS standard (line %d).\n", in.line_num + 1);
                 }
-                pos++;
                 break;
             case 'd':
                 // qlvl++; or should we?
-                pos++;
                 is_dependency_quantifier = true;
                 break;
             case 'c':
-                V0("Comment in line %d is not conform in the DIMACS/QDIMACS/DQDIMACS standard.\n", line_num);
+                V0("Comment in line %d is not conform in the DIMACS/QDIMACS/DQDIMACS standard.\n", in.line_num + 1);
+                qdimacs_skip_line(&in);
                 continue;
-                break;
             default:
+                is_quantifier = false;
                 break;
         }
-        if (pos == 0) {
+        if (! is_quantifier) {
             // reached end of quantification
             break;
         }
+        in.pos++;
         
         bool num_vars_parsed_this_line = 0;
         if (is_dependency_quantifier) {
             vector_add(dependency_sets, int_vector_init());
         }
         
-        while (line[pos] != '\n' && line[pos] != '\r' && line[pos] != '\0') {
-            skip_space(line, &pos);
-            int next_lit = get_next_lit(line, &pos, line_num);
+        while (true) {
+            qdimacs_skip_space(&in);
+            if (in.pos >= in.end || *in.pos == '\n' || *in.pos == '\r') {
+                break;
+            }
+            int next_lit = qdimacs_read_lit(&in);
             if (next_lit == 0) {
                 break;
             }
             if (next_lit < 0) {
-                V0("Error: Quantifier introduces negative number as a variable name (line %d). Abort.\n", line_num);
+                V0("Error: Quantifier introduces negative number as a variable name (line %d). Abort.\n", in.line_num + 1);
                 abort();
             }
             
@@ -155,7 +257,7 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
                     int_vector_add(dependency_variables, next_lit);
                 } else {
                     if (!qcnf_var_exists(c2->qcnf, (unsigned) next_lit)) {
-                        V0("Error: Variable %d in line %d must be introduced as universal variable before it occurs in the scope of a dependency quantifier.\n",next_lit,line_num);
+                        V0("Error: Variable %d in line %d must be introduced as universal variable before it occurs in the scope of a dependency quantifier.\n",next_lit,in.line_num + 1);
                         abort();
                     }
                     int_vector_add(vector_get(dependency_sets, vector_count(dependency_sets) - 1), next_lit);
@@ -164,14 +266,14 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
                 bool is_universal = qlvl % 2 == 1;
                 
                 if (qcnf_var_exists(c2->qcnf, (unsigned) next_lit)) {
-                    V0("Error: line %d contains duplicate variable %d.\n", line_num, next_lit);
+                    V0("Error: line %d contains duplicate variable %d.\n", in.line_num + 1, next_lit);
                     abort();
                 }
                 c2_new_variable(c2, is_universal, qlvl / 2 + (is_universal ? 1 : 0), (unsigned) next_lit);
             }
             num_vars_parsed_this_line += 1;
-            skip_space(line, &pos);
         }
+        qdimacs_skip_line(&in);
     }
     
     if (qlvl % 2 == 1) {
@@ -213,32 +315,29 @@ C2* c2_from_qdimacs_and_header(Options* options, FILE* file, char* header, int l
         V4("Detected the following quantifier hierarchy:\n");
         qcnf_print_qdimacs_quantifiers(c2->qcnf, stdout);
     }
-    if (feof(file)) {
-        free(line);
-        return c2;
-    }
-    
     // Parse the matrix
-    do {
-        //printf("%s", line);
-        size_t pos = 0;
-        line_num++;
-        if (line[0] == 'c') {
+    while (true) {
+        while (in.pos < in.end && (*in.pos == ' ' || *in.pos == '\n' || *in.pos == '\r' || *in.pos == '\t')) {
+            if (*in.pos == '\n') {
+                in.line_num++;
+            }
+            in.pos++;
+        }
+        if (in.pos >= in.end) {
+            break;
+        }
+        if (*in.pos == 'c') {
+            qdimacs_skip_line(&in);
             continue;
         }
-        while (line[pos] != '\n' && line[pos] != '\r' && line[pos] != '\0') {
-            skip_space(line, &pos);
-            int next_lit = get_next_lit(line, &pos, line_num);
-            abortif(pos >= (size_t)len, "Clause was way too long. Cannot parse.\n");
-            if (next_lit != 0 && !qcnf_var_exists(c2->qcnf, lit_to_var(next_lit))) {
-                c2_new_variable(c2, 0, 0, lit_to_var(next_lit));
-            }
-            c2_add_lit(c2, next_lit);
-            skip_space(line, &pos);
+        int next_lit = qdimacs_read_lit(&in);
+        if (next_lit != 0 && !qcnf_var_exists(c2->qcnf, lit_to_var(next_lit))) {
+            c2_new_variable(c2, 0, 0, lit_to_var(next_lit));
         }
-    } while (fgets(line, len, file));
+        c2_add_lit(c2, next_lit);
+    }
     abortif(int_vector_count(c2->qcnf->new_clause) != 0, "Last clause was not closed by 0.");
-    free(line);
+    qdimacs_input_free(&in);
     return c2;
 }
 
@@ -496,6 +595,117 @@ C2* c2_from_qaiger(aiger* aig, Options* options) {
     return c2;
 }
 
+static size_t qcnf_binary_align(size_t offset) {
+    return (offset + 7) & ~ (size_t) 7;
+}
+
+// Whether lit refers to a variable that has been read already; var_ids are at most max_var_id
+static bool qcnf_binary_is_known_lit(QCNF* qcnf, Lit lit, uint32_t max_var_id) {
+    return lit != 0 && lit != INT_MIN && lit_to_var(lit) <= max_var_id && qcnf_var_exists(qcnf, lit_to_var(lit));
+}
+
+/* Recreates the C2 object from which qcnf_write_binary wrote the formula. Variables and clauses are
+ * introduced in the same order as by the parser, and only the clauses that were added through c2_add_lit
+ * are passed to the domains; clauses added by preprocessing are only registered in the QCNF.
+ */
+C2* c2_from_binary_file(const char* file_name, Options* options, unsigned* preprocessing) {
+    FILE* file = fopen(file_name, "rb");
+    abortif(!file, "Cannot open file \"%s\", does not exist?", file_name);
+    QDIMACS_Input in;
+    qdimacs_input_init(&in, file, 0);
+    fclose(file);
+    
+    abortif(in.size < sizeof(qcnf_binary_header), "Binary formula is truncated.");
+    const qcnf_binary_header* header = (const qcnf_binary_header*) in.data;
+    abortif(memcmp(header->magic, QCNF_BINARY_MAGIC, sizeof(header->magic)) != 0, "Not a binary formula.");
+    abortif(header->byte_order_mark != QCNF_BINARY_BYTE_ORDER_MARK, "Binary formula was written on a machine with different byte order.");
+    abortif(header->version != QCNF_BINARY_VERSION, "Binary formula has version %u, expected version %u.", header->version, QCNF_BINARY_VERSION);
+    
+    // Bounds the sizes of the sections before computing their offsets, so that these cannot overflow
+    abortif(header->var_num > in.size / sizeof(qcnf_binary_var)
+            || header->clause_num > in.size / sizeof(qcnf_binary_clause)
+            || header->lit_num > in.size / sizeof(Lit)
+            || header->names_size > in.size, "Binary formula is truncated.");
+    abortif(header->max_var_id >= INT_MAX || header->var_num > header->max_var_id, "Binary formula has an invalid number of variables.");
+    
+    size_t vars_offset = sizeof(qcnf_binary_header);
+    size_t clauses_offset = vars_offset + sizeof(qcnf_binary_var) * header->var_num;
+    size_t lits_offset = clauses_offset + sizeof(qcnf_binary_clause) * header->clause_num;
+    size_t names_offset = qcnf_binary_align(lits_offset + sizeof(Lit) * header->lit_num);
+    abortif(in.size < names_offset + header->names_size, "Binary formula is truncated.");
+    const qcnf_binary_var* vars = (const qcnf_binary_var*) (in.data + vars_offset);
+    const qcnf_binary_clause* clauses = (const qcnf_binary_clause*) (in.data + clauses_offset);
+    const Lit* lits = (const Lit*) (in.data + lits_offset);
+    
+    C2* c2 = c2_init(options);
+    QCNF* qcnf = c2->qcnf;
+    var_vector_resize(qcnf->vars, header->var_num + 1); // var_num is bounded by the file size, max_var_id is not
+    for (unsigned i = 0; i < header->var_num; i++) {
+        abortif(vars[i].var_id == 0 || vars[i].var_id > header->max_var_id, "Binary formula contains invalid variable %u.", vars[i].var_id);
+        abortif(vars[i].scope_id >= header->scope_num, "Binary formula contains invalid scope %u.", vars[i].scope_id);
+        c2_new_variable(c2, vars[i].is_universal, vars[i].scope_id, vars[i].var_id);
+        var_vector_get(qcnf->vars, vars[i].var_id)->original = (char) vars[i].original;
+    }
+    while (vector_count(qcnf->scopes) < header->scope_num) {
+        qcnf_scope_init(qcnf, int_vector_init());
+    }
+    qcnf->problem_type = (PROBLEM_TYPE) header->problem_type;
+    
+    uint64_t remaining_lits = header->lit_num;
+    for (unsigned i = 0; i < header->clause_num; i++) {
+        uint32_t flags = clauses[i].flags;
+        abortif(clauses[i].size > remaining_lits, "Binary formula is truncated.");
+        remaining_lits -= clauses[i].size;
+        for (unsigned j = 0; j < clauses[i].size; j++) {
+            abortif(! qcnf_binary_is_known_lit(qcnf, lits[j], header->max_var_id), "Binary formula contains invalid literal %d.", lits[j]);
+        }
+        Clause* c = qcnf_new_clause_from_sorted_literals(qcnf, lits, clauses[i].size);
+        lits += clauses[i].size;
+        c->original = (flags & QCNF_BINARY_CLAUSE_ORIGINAL) != 0;
+        c->consistent_with_originals = (flags & QCNF_BINARY_CLAUSE_CONSISTENT) != 0;
+        if (flags & QCNF_BINARY_CLAUSE_REGISTERED) {
+            qcnf_register_clause_unchecked(qcnf, c);
+            if (c->original) {
+                c2_new_clause(c2, c);
+                c2_rl_new_clause(c);
+            }
+        }
+        c->blocked = (flags & QCNF_BINARY_CLAUSE_BLOCKED) != 0;
+        c->is_cube = (flags & QCNF_BINARY_CLAUSE_IS_CUBE) != 0;
+        c->minimized = (flags & QCNF_BINARY_CLAUSE_MINIMIZED) != 0;
+    }
+    // Clauses removed by blocked clause elimination
+    for (unsigned i = 0; i < header->clause_num; i++) {
+        if ((clauses[i].flags & QCNF_BINARY_CLAUSE_REGISTERED) && ! (clauses[i].flags & QCNF_BINARY_CLAUSE_ACTIVE)) {
+            qcnf_unregister_clause(qcnf, vector_get(qcnf->all_clauses, i));
+        }
+    }
+    qcnf->universal_reductions = header->universal_reductions;
+    qcnf->blocked_clauses = header->blocked_clauses;
+    
+    const char* names = in.data + names_offset;
+    const char* names_end = names + header->names_size;
+    char* name = NULL;
+    while (names < names_end) {
+        uint32_t entry[2];
+        abortif(names + sizeof(entry) > names_end, "Binary formula is truncated.");
+        memcpy(entry, names, sizeof(entry));
+        names += sizeof(entry);
+        abortif(entry[0] == 0 || entry[0] > header->max_var_id, "Binary formula contains a name for invalid variable %u.", entry[0]);
+        abortif(entry[1] > (size_t) (names_end - names), "Binary formula is truncated.");
+        name = realloc(name, entry[1] + 1);
+        memcpy(name, names, entry[1]);
+        name[entry[1]] = 0;
+        names += entry[1];
+        qcnf_set_variable_name(qcnf, entry[0], name);
+    }
+    free(name);
+    
+    *preprocessing = header->preprocessing;
+    qdimacs_input_free(&in);
+    return c2;
+}
+
 C2* c2_from_file(FILE* file, Options* options) {
     if (!options) {options = default_options();}
     int len = 1000; // max 1kb for the first line
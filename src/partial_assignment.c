@@ -12,6 +12,7 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <limits.h>
 
 struct PA_UNDO_PAIR {
     unsigned var_id;
@@ -25,7 +26,11 @@ union PA_UNDO_PAIR_UNION {
 PartialAssignment* partial_assignment_init(QCNF* qcnf) {
     PartialAssignment* pa = malloc(sizeof(PartialAssignment));
     pa->qcnf = qcnf;
-    pa->clauses_to_check = worklist_init(qcnf_compare_clauses_by_size);
+    pa->watches = vector_init();
+    pa->watched_positions = int_vector_init();
+    pa->attached_clauses = 0; // clauses are attached lazily, see partial_assignment_attach_new_clauses
+    pa->propagation_queue = int_vector_init();
+    pa->propagation_queue_head = 0;
     pa->assigned_variables = 0;
     pa->conflicted_clause = NULL;
     pa->conflicted_var = 0;
@@ -38,18 +43,17 @@ PartialAssignment* partial_assignment_init(QCNF* qcnf) {
     
     pa->conflicts = 0;
     pa->propagations = 0;
-    
-    Clause_Iterator ci = qcnf_get_clause_iterator(qcnf); Clause* c = NULL;
-    while ((c = qcnf_next_clause(&ci)) != NULL) {
-        if (c->size == 1) {
-            worklist_push(pa->clauses_to_check, c);
-        }
-    }
     return pa;
 }
 
 void partial_assignment_free(PartialAssignment* pa) {
-    worklist_free(pa->clauses_to_check);
+    for (unsigned i = 0; i < vector_count(pa->watches); i++) {
+        int_vector* w = vector_get(pa->watches, i);
+        if (w) {int_vector_free(w);}
+    }
+    vector_free(pa->watches);
+    int_vector_free(pa->watched_positions);
+    int_vector_free(pa->propagation_queue);
     stack_free(pa->stack);
     val_vector_free(pa->vals);
 #ifdef DEBUG_PARTIAL_ASSIGNMENT
@@ -60,7 +64,6 @@ void partial_assignment_free(PartialAssignment* pa) {
 }
 
 void partial_assignment_pop(PartialAssignment* pa) {
-    worklist_reset(pa->clauses_to_check);
     pa->decision_lvl -= 1;
     stack_pop(pa->stack, pa);
 }
@@ -120,12 +123,37 @@ Lit partial_assignment_is_clause_satisfied(PartialAssignment* pa, Clause* c) {
     return 0;
 }
 
-void update_clause_worklist(PartialAssignment* pa, QCNF* qcnf, int unassigned_lit) {
-    Var* v = var_vector_get(qcnf->vars, lit_to_var(unassigned_lit));
-    vector* occs = unassigned_lit > 0 ? &v->neg_occs : &v->pos_occs;
-    for (unsigned i = 0; i < vector_count(occs); i++) {
-        worklist_push(pa->clauses_to_check, vector_get(occs, i));
+// Returns 1 if lit is assigned true, -1 if it is assigned false, and 0 otherwise
+static inline int partial_assignment_lit_val(PartialAssignment* pa, Lit lit) {
+    VAL v = partial_assignment_get_val(pa, lit_to_var(lit));
+    assert(v != bottom);
+    if (v == top) {
+        return 0;
+    }
+    return (v == tt) == (lit > 0) ? 1 : -1;
+}
+
+static inline unsigned lit_to_watch_idx(Lit lit) {
+    return 2 * lit_to_var(lit) + (lit < 0 ? 1 : 0);
+}
+
+int_vector* partial_assignment_get_watches(PartialAssignment* pa, Lit lit) {
+    unsigned idx = lit_to_watch_idx(lit);
+    while (vector_count(pa->watches) <= idx) {
+        vector_add(pa->watches, NULL);
+    }
+    int_vector* w = vector_get(pa->watches, idx);
+    if (w == NULL) {
+        w = int_vector_init();
+        vector_set(pa->watches, idx, w);
     }
+    return w;
+}
+
+void partial_assignment_add_watch(PartialAssignment* pa, Lit lit, Clause* c, Lit blocker) {
+    int_vector* w = partial_assignment_get_watches(pa, lit);
+    int_vector_add(w, (int) c->clause_idx);
+    int_vector_add(w, blocker);
 }
 
 void partial_assignment_go_into_conflict_state(PartialAssignment* pa, Clause* conflicted_clause, unsigned conflicted_var) {
@@ -158,7 +186,7 @@ void partial_assignment_assign_value(PartialAssignment* pa, Lit lit) {
     partial_assignment_set_dlvl(pa, var_id);
     
     pa->assigned_variables++;
-    update_clause_worklist(pa, pa->qcnf, lit);
+    int_vector_add(pa->propagation_queue, lit);
     
 //    if (val == oposite) {
 //        abortif(true, "This is the wrong place to handle conflicts");
@@ -166,55 +194,157 @@ void partial_assignment_assign_value(PartialAssignment* pa, Lit lit) {
 //    }
 }
 
-void partial_assignment_propagate_clause(PartialAssignment* pa, Clause* c) {
-    Lit unassigned_lit = 0;
-    bool contains_universals = false;
-    for (int i = 0; i < c->size; i++) {
-        VAL v = partial_assignment_get_val(pa, lit_to_var(c->occs[i]));
-        assert(v != bottom);
-        
-        if (v == (c->occs[i] > 0 ? tt : ff)) {
-            // this literal satisfies the clause
-            return;
+void partial_assignment_propagate_lit(PartialAssignment* pa, Lit lit, Clause* reason) {
+//    V4("Propagating variable %d.\n",lit);
+    pa->propagations++;
+    partial_assignment_assign_value(pa, lit);
+    
+    while (vector_count(pa->causes) <= lit_to_var(lit)) {
+        vector_add(pa->causes, NULL);
+    }
+    vector_set(pa->causes, lit_to_var(lit), reason);
+}
+
+/* Watches the two best literals of the clause: true literals first, then unassigned literals, then
+ * false literals of the highest decision level. Clauses are attached under the current assignment,
+ * so a clause may be unit or conflicted right away.
+ */
+void partial_assignment_attach_clause(PartialAssignment* pa, Clause* c) {
+    while (int_vector_count(pa->watched_positions) <= 2 * c->clause_idx + 1) {
+        int_vector_add(pa->watched_positions, -1);
+    }
+    if (! c->active || int_vector_get(pa->watched_positions, 2 * c->clause_idx) != -1) {
+        return;
+    }
+    if (c->size == 0) {
+        if (! partial_assignment_is_conflicted(pa)) {
+            partial_assignment_go_into_conflict_state(pa, c, 0);
         }
-        if (v == top) {
-            if (unassigned_lit != 0 || contains_universals) {
-                // two unassigned existentials; clause cannot propagate
-                return;
-            }
-            unassigned_lit = c->occs[i];
+        return;
+    }
+    
+    int best[2] = {-1, -1};
+    int best_rank[2] = {INT_MIN, INT_MIN};
+    for (int i = 0; i < c->size; i++) {
+        int val = partial_assignment_lit_val(pa, c->occs[i]);
+        int rank = val == 1 ? INT_MAX : (val == 0 ? INT_MAX - 1 : (int) partial_assignment_get_decision_lvl(pa, lit_to_var(c->occs[i])));
+        if (rank > best_rank[0]) {
+            best[1] = best[0]; best_rank[1] = best_rank[0];
+            best[0] = i; best_rank[0] = rank;
+        } else if (rank > best_rank[1]) {
+            best[1] = i; best_rank[1] = rank;
         }
     }
+    if (c->size == 1) {
+        best[1] = best[0];
+    }
+    int_vector_set(pa->watched_positions, 2 * c->clause_idx,     best[0]);
+    int_vector_set(pa->watched_positions, 2 * c->clause_idx + 1, best[1]);
+    Lit first = c->occs[best[0]];
+    Lit second = c->occs[best[1]];
+    partial_assignment_add_watch(pa, first, c, second);
+    if (best[1] != best[0]) {
+        partial_assignment_add_watch(pa, second, c, first);
+    }
     
-    if (unassigned_lit == 0) { // conflict
-        partial_assignment_go_into_conflict_state(pa,c,0); // leaving conflicted var 0, as no unique var can be determined
-    } else { // assign value
-        assert(! contains_universals);
-//        V4("Propagating variable %d.\n",unassigned_lit);
-        pa->propagations++;
-        partial_assignment_assign_value(pa, unassigned_lit);
+    int first_val = partial_assignment_lit_val(pa, first);
+    int second_val = best[1] != best[0] ? partial_assignment_lit_val(pa, second) : -1;
+    if (first_val == 0 && second_val == -1) {
+        partial_assignment_propagate_lit(pa, first, c);
+    } else if (first_val == -1 && ! partial_assignment_is_conflicted(pa)) {
+        partial_assignment_go_into_conflict_state(pa, c, 0); // leaving conflicted var 0, as no unique var can be determined
+    }
+}
+
+// Clauses are not announced to the partial assignment domain one by one; attach all clauses that are new in the QCNF.
+void partial_assignment_attach_new_clauses(PartialAssignment* pa) {
+    while (pa->attached_clauses < vector_count(pa->qcnf->all_clauses)) {
+        Clause* c = vector_get(pa->qcnf->all_clauses, pa->attached_clauses);
+        pa->attached_clauses++;
+        if (c != NULL) {
+            partial_assignment_attach_clause(pa, c);
+        }
+    }
+}
+
+// Visits the clauses watching -lit after lit was assigned. Stops at the first conflict.
+void partial_assignment_propagate_watches(PartialAssignment* pa, Lit lit) {
+    Lit false_lit = - lit;
+    int_vector* w = partial_assignment_get_watches(pa, false_lit);
+    unsigned j = 0; // entries before j are kept
+    unsigned i = 0;
+    while (i < int_vector_count(w)) {
+        unsigned clause_idx = (unsigned) int_vector_get(w, i);
+        Lit blocker = int_vector_get(w, i + 1);
+        i += 2;
+        if (partial_assignment_lit_val(pa, blocker) == 1) {
+            int_vector_set(w, j++, (int) clause_idx);
+            int_vector_set(w, j++, blocker);
+            continue;
+        }
+        Clause* c = vector_get(pa->qcnf->all_clauses, clause_idx);
+        if (c == NULL || ! c->active) {
+            continue; // drop the watch of the deleted clause
+        }
+        unsigned slot = c->occs[int_vector_get(pa->watched_positions, 2 * clause_idx)] == false_lit ? 0 : 1;
+        assert(c->occs[int_vector_get(pa->watched_positions, 2 * clause_idx + slot)] == false_lit);
+        int other_pos = int_vector_get(pa->watched_positions, 2 * clause_idx + (1 - slot));
+        Lit other = c->occs[other_pos];
+        int other_val = partial_assignment_lit_val(pa, other);
+        if (other_val == 1) {
+            int_vector_set(w, j++, (int) clause_idx);
+            int_vector_set(w, j++, other);
+            continue;
+        }
         
-        while (vector_count(pa->causes) <= lit_to_var(unassigned_lit)) {
-            vector_add(pa->causes, NULL);
+        // Search for a replacement of the false watch
+        int replacement = -1;
+        for (int k = 0; k < c->size; k++) {
+            if (k != other_pos
+                && c->occs[k] != false_lit
+                && partial_assignment_lit_val(pa, c->occs[k]) != -1) {
+                replacement = k;
+                break;
+            }
+        }
+        if (replacement != -1) {
+            int_vector_set(pa->watched_positions, 2 * clause_idx + slot, replacement);
+            partial_assignment_add_watch(pa, c->occs[replacement], c, other);
+            continue;
+        }
+        
+        // Clause is unit or conflicted; keep the watch
+        int_vector_set(w, j++, (int) clause_idx);
+        int_vector_set(w, j++, other);
+        if (other_val == 0 && c->size > 1) {
+            partial_assignment_propagate_lit(pa, other, c);
+        } else {
+            partial_assignment_go_into_conflict_state(pa, c, 0); // leaving conflicted var 0, as no unique var can be determined
+            break;
         }
-        vector_set(pa->causes, lit_to_var(unassigned_lit), c);
     }
+    while (i < int_vector_count(w)) {
+        int_vector_set(w, j++, int_vector_get(w, i++));
+    }
+    int_vector_reduce_count(w, j);
 }
 
 void partial_assignment_propagate(PartialAssignment* pa) {
     V4("Propagating partial assignments\n");
-    while (worklist_count(pa->clauses_to_check) > 0) {
+    partial_assignment_attach_new_clauses(pa);
+    while (pa->propagation_queue_head < int_vector_count(pa->propagation_queue)) {
         if (partial_assignment_is_conflicted(pa)) {
-            break;
+            return;
+        }
+        Lit lit = int_vector_get(pa->propagation_queue, pa->propagation_queue_head);
+        pa->propagation_queue_head++;
+        // Backtracking does not clean up the queue; skip literals that are not assigned true anymore
+        if (partial_assignment_lit_val(pa, lit) == 1) {
+            partial_assignment_propagate_watches(pa, lit);
         }
-        Clause* c = worklist_pop(pa->clauses_to_check);
-        partial_assignment_propagate_clause(pa, c);
-    }
-    if (partial_assignment_is_conflicted(pa)) {
-        worklist_free(pa->clauses_to_check);
-        pa->clauses_to_check = worklist_init(qcnf_compare_clauses_by_size);
-        return;
     }
+    int_vector_reset(pa->propagation_queue);
+    pa->propagation_queue_head = 0;
 }
 
 // INTERACTION WITH CONFLICT ANALYSIS
@@ -266,7 +396,7 @@ unsigned partial_assignment_get_decision_lvl(void* domain, unsigned var_id) {
 // Register new clauses
 
 void partial_assignment_new_clause(PartialAssignment* pa, Clause* c) {
-    worklist_push(pa->clauses_to_check, c);
+    partial_assignment_attach_clause(pa, c);
 }
 
 
@@ -302,7 +432,7 @@ void pa_print_debug_info(PartialAssignment* pa) {
         }
             
     }
-    V1("\n  Worklist count: %u\n", worklist_count(pa->clauses_to_check));
+    V1("\n  Propagation queue: %u\n", int_vector_count(pa->propagation_queue) - pa->propagation_queue_head);
 #endif
 }
 
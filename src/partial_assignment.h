@@ -29,7 +29,14 @@ typedef enum {
 
 struct PartialAssignment {
     QCNF* qcnf;
-    worklist* clauses_to_check; // stores Clause pointers
+    
+    // Two watched literals
+    vector* watches; // indexed by lit_to_watch_idx(lit); int_vector* of pairs (clause_idx, blocker lit) for the clauses watching lit
+    int_vector* watched_positions; // two entries per clause_idx: the positions of the watched literals in c->occs; -1 if not attached
+    unsigned attached_clauses; // prefix of qcnf->all_clauses that has been attached
+    int_vector* propagation_queue; // assigned literals whose watches have not been visited yet
+    unsigned propagation_queue_head;
+    
     val_vector* vals; // an array of VALs indexed by var_id. Length must be consistent with max_var_id of qcnf.
     vector* causes; // mapping var_id to Clause*. Indicates which clause propagated the variable
     
@@ -57,7 +64,7 @@ void partial_assignment_set_val(PartialAssignment* pa, unsigned var_id, VAL v);
 VAL partial_assignment_get_val(PartialAssignment* pa, unsigned var_id);
 
 void partial_assignment_assign_value(PartialAssignment*,Lit);
-void partial_assignment_propagate_clause(PartialAssignment*,Clause*); // returns the propagated Lit, or 0 if nothing was propagated
+void partial_assignment_attach_clause(PartialAssignment*,Clause*); // selects the watched literals and propagates the clause if it is unit
 
 void partial_assignment_go_into_conflict_state(PartialAssignment*, Clause* conflicted_clause, unsigned conflicted_var);
 
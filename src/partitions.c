@@ -36,7 +36,7 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
     // Connect all vars to the minimal pn in each clause.
     for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
         Clause* c = vector_get(c2->qcnf->all_clauses, i);
-        if (c->original) {
+        if (c && c->original) {
             unsigned minimal_pn = UINT_MAX;
             for (unsigned j = 0; j < c->size; j++) {
                 unsigned var_id = lit_to_var(c->occs[j]);
@@ -90,7 +90,7 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
 #ifdef DEBUG
     for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
         Clause* c = vector_get(c2->qcnf->all_clauses, i);
-        if (c->original) {
+        if (c && c->original) {
             unsigned clause_pn = 0;
             for (unsigned j = 0; j < c->size; j++) {
                 unsigned var_id = lit_to_var(c->occs[j]);
@@ -116,7 +116,7 @@ void c2_analysis_determine_number_of_partitions(C2* c2) {
     }
     for (unsigned i = 0; i < vector_count(c2->qcnf->all_clauses); i++) {
         Clause* c = vector_get(c2->qcnf->all_clauses, i);
-        if (c->original) {
+        if (c && c->original) {
             bool contains_deterministic = false;
             unsigned clause_partition_number = 0;
             for (unsigned j = 0; j < c->size; j++) {
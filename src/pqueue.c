@@ -16,6 +16,17 @@ pqueue* pqueue_init() {
     pqueue* h = calloc(1, sizeof(pqueue));
     h->unique_computation = false;
     h->elements = set_init();
+    h->dense_elements = NULL;
+    h->index = NULL;
+    return h;
+}
+
+pqueue* pqueue_init_dense(dense_index_function index) {
+    pqueue* h = calloc(1, sizeof(pqueue));
+    h->unique_computation = false;
+    h->elements = NULL;
+    h->dense_elements = bit_vector_init_growable();
+    h->index = index;
     return h;
 }
 
@@ -27,6 +38,8 @@ pqueue* pqueue_init_unique_computation() {
 
 void pqueue_free(pqueue* h) {
     free(h->nodes);
+    if (h->elements) {set_free(h->elements);}
+    if (h->dense_elements) {bit_vector_free(h->dense_elements);}
     free(h);
 }
 
@@ -34,7 +47,11 @@ void pqueue_reset(pqueue* h) {
     h->size = 0;
     h->len = 0;
     free(h->nodes);
-    set_reset(h->elements);
+    if (h->dense_elements) {
+        bit_vector_reset(h->dense_elements);
+    } else {
+        set_reset(h->elements);
+    }
     h->nodes = NULL;
 }
 
@@ -44,7 +61,13 @@ unsigned pqueue_count(pqueue* h) {
 }
 
 void pqueue_push(pqueue* h, int priority, void* data) {
-    if (set_contains(h->elements, data)) {
+    if (h->dense_elements) {
+        int index = h->index(data);
+        if (bit_vector_contains(h->dense_elements, index)) {
+            return;
+        }
+        bit_vector_add(h->dense_elements, index);
+    } else if (set_contains(h->elements, data)) {
         return;
     } else {
         set_add(h->elements, data);
@@ -93,7 +116,11 @@ void* pqueue_pop(pqueue* h) {
     }
     h->nodes[i] = h->nodes[h->len + 1];
     if (!h->unique_computation) {
-        set_remove(h->elements, data);
+        if (h->dense_elements) {
+            bit_vector_remove(h->dense_elements, h->index(data));
+        } else {
+            set_remove(h->elements, data);
+        }
     }
     return data;
 }
@@ -10,6 +10,7 @@
 #define pqueue_h
 
 #include "set.h"
+#include "bit_vector.h"
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -33,11 +34,14 @@ typedef struct {
     int len;
     int size;
     bool unique_computation;
-    set* elements;
+    set* elements; // membership, if elements have no dense index
+    bit_vector* dense_elements; // membership by dense index; NULL if the set is used
+    dense_index_function index;
 } pqueue;
 
 pqueue* pqueue_init();
 pqueue* pqueue_init_unique_computation();
+pqueue* pqueue_init_dense(dense_index_function);
 void pqueue_free(pqueue*);
 unsigned pqueue_count(pqueue*);
 void pqueue_push(pqueue*, int, void*);
@@ -73,16 +73,16 @@ bool qcnf_is_learnt_clause(Clause* c) {
 
 bool qcnf_is_learnt_clause_idx(QCNF* qcnf, unsigned clause_idx) {
     Clause* c = vector_get(qcnf->all_clauses, clause_idx);
-    return qcnf_is_learnt_clause(c);
+    return c != NULL && qcnf_is_learnt_clause(c);
 }
 
 bool qcnf_is_original_clause(QCNF* qcnf, unsigned clause_idx) {
     Clause* c = vector_get(qcnf->all_clauses, clause_idx);
-    return c->original;
+    return c != NULL && c->original;
 }
 bool qcnf_is_active(QCNF* qcnf, unsigned clause_idx) {
     Clause* c = vector_get(qcnf->all_clauses, clause_idx);
-    return c->active;
+    return c != NULL && c->active;
 }
 
 bool qcnf_is_duplicate(QCNF* qcnf, Clause* c) {
@@ -96,9 +96,14 @@ bool qcnf_is_duplicate(QCNF* qcnf, Clause* c) {
         }
         return false;
     }
-    Lit first = c->occs[0];
-    Var* v = var_vector_get(qcnf->vars, lit_to_var(first));
-    vector* occs = first > 0 ? &v->pos_occs : &v->neg_occs;
+    // A duplicate occurs in all occurrence lists of the literals of c; search the shortest one
+    vector* occs = qcnf_get_occs_of_lit(qcnf, c->occs[0]);
+    for (unsigned i = 1; i < c->size; i++) {
+        vector* lit_occs = qcnf_get_occs_of_lit(qcnf, c->occs[i]);
+        if (vector_count(lit_occs) < vector_count(occs)) {
+            occs = lit_occs;
+        }
+    }
     for (unsigned i = 0; i < vector_count(occs); i++) {
         Clause* other = vector_get(occs, i);
         if (c != other && c->size == other->size) {
@@ -206,7 +211,7 @@ int qcnf_compare_literals_by_var_id(const void * a, const void * b) {
     return ( abs((int)a) - abs((int)b) );
 }
 
-QCNF* static_qcnf_variable_for_sorting = NULL; // TODO: this prevents C2 from being concurrent
+_Thread_local QCNF* static_qcnf_variable_for_sorting = NULL; // thread-local, so that solvers in different threads can create clauses concurrently
 
 int qcnf_compare_scope_ids(QCNF* qcnf, unsigned scope_id1, unsigned scope_id2) {
     if (!qcnf_is_DQBF(qcnf)) {
@@ -245,6 +250,7 @@ QCNF* qcnf_init() {
     
     qcnf->active_clauses = vector_init();
     qcnf->all_clauses = vector_init();
+    qcnf->clause_arena = clause_arena_init();
     qcnf->clause_iterator_token = 0;
     
     qcnf->vars = var_vector_init();
@@ -271,22 +277,42 @@ QCNF* qcnf_init() {
     return qcnf;
 }
 
+// Copies variables, active clauses, and variable names. The flags of variables and clauses are preserved, clause_idxs are not.
 QCNF* qcnf_copy(QCNF* other) {
     QCNF* this = qcnf_init();
     for (unsigned i = 0; i < var_vector_count(other->vars); i++) {
         if (qcnf_var_exists(other, i)) {
             Var* v = var_vector_get(other->vars, i);
-            qcnf_new_var(this, v->is_universal, v->scope_id, v->var_id);
+            Var* new = qcnf_new_var(this, v->is_universal, v->scope_id, v->var_id);
+            new->original = v->original;
         }
     }
+    while (vector_count(this->scopes) < vector_count(other->scopes)) {
+        qcnf_scope_init(this, int_vector_init());
+    }
+    this->problem_type = other->problem_type;
     Clause_Iterator ci = qcnf_get_clause_iterator(other); Clause* c = NULL;
     while ((c = qcnf_next_clause(&ci)) != NULL) {
         for (unsigned j = 0; j < c->size; j++) {
             qcnf_add_lit(this, c->occs[j]);
         }
-        qcnf_close_clause(this);
+        Clause* new = qcnf_close_clause(this);
+        assert(new); // other does not contain duplicates
+        new->original = c->original;
+        new->consistent_with_originals = c->consistent_with_originals;
+        new->blocked = c->blocked;
+        new->is_cube = c->is_cube;
+        new->minimized = c->minimized;
     }
     assert(int_vector_count(this->universal_clauses) == int_vector_count(other->universal_clauses));
+    for (unsigned i = 0; i < vector_count(other->variable_names); i++) {
+        char* name = vector_get(other->variable_names, i);
+        if (name) {
+            qcnf_set_variable_name(this, i, name);
+        }
+    }
+    this->universal_reductions = other->universal_reductions;
+    this->blocked_clauses = other->blocked_clauses;
     return this;
 }
 
@@ -415,6 +441,29 @@ void qcnf_universal_reduction(QCNF* qcnf, Clause* clause) {
     }
 }
 
+static size_t qcnf_clause_bytes(unsigned size) {
+    assert(sizeof(Clause) == 3 * sizeof(Lit));
+    // Clause already contains space for one literal
+    return sizeof(Clause) + sizeof(Lit) * (size > 0 ? (size_t) size - 1 : 0);
+}
+
+// Allocates the clause in the clause arena and appends it to all_clauses; the literals are not initialized
+static Clause* qcnf_allocate_clause(QCNF* qcnf, unsigned size) {
+    Clause* c = clause_arena_alloc(qcnf->clause_arena, qcnf_clause_bytes(size));
+    vector_add(qcnf->all_clauses, c);
+    c->clause_idx = vector_count(qcnf->all_clauses) - 1;
+    c->original = true;
+    c->consistent_with_originals = true;
+    c->blocked = false;
+    c->universal_clause = true;
+    c->is_cube = false;
+    c->minimized = false;
+    c->active = false;
+    c->in_active_clause_vector = false;
+    c->size = size;
+    return c;
+}
+
 Clause* qcnf_new_clause(QCNF* qcnf, int_vector* literals) {
     assert(literals == qcnf->new_clause || int_vector_count(qcnf->new_clause) == 0);
     abortif(int_vector_count(literals) > 33554431, "Clause length is greater than 2^25. You're doing it wrong.");
@@ -430,22 +479,7 @@ Clause* qcnf_new_clause(QCNF* qcnf, int_vector* literals) {
         }
     }
     
-    assert(sizeof(Clause) == 3 * sizeof(Lit));
-    assert( sizeof(Clause) + (size_t) ( (int) sizeof(Lit) * ((int) int_vector_count(literals) - 1) ) == sizeof(int) * (int_vector_count(literals) + 2) );
-    size_t bytes_to_allocate_for_literals = sizeof(Lit) * (size_t) ((int) int_vector_count(literals) - 1);
-    
-    Clause* c = malloc( sizeof(Clause) + bytes_to_allocate_for_literals );
-    vector_add(qcnf->all_clauses, c);
-    c->clause_idx = vector_count(qcnf->all_clauses) - 1;
-    c->original = true;
-    c->consistent_with_originals = true;
-    c->blocked = false;
-    c->universal_clause = true;
-    c->is_cube = false;
-    c->minimized = false;
-    c->active = false;
-    c->in_active_clause_vector = false;
-    c->size = int_vector_count(literals);
+    Clause* c = qcnf_allocate_clause(qcnf, int_vector_count(literals));
     
     for (unsigned i = 0; i < c->size; i++) {
         int lit = int_vector_get(literals, i);
@@ -497,16 +531,27 @@ Clause* qcnf_close_clause(QCNF* qcnf) {
     return c;
 }
 
-void qcnf_free_clause(Clause* c) {
-    free(c);
-}
 
+Clause* qcnf_new_clause_from_sorted_literals(QCNF* qcnf, const Lit* literals, unsigned size) {
+    assert(int_vector_count(qcnf->new_clause) == 0);
+    Clause* c = qcnf_allocate_clause(qcnf, size);
+    for (unsigned i = 0; i < size; i++) {
+        assert(literals[i] != 0);
+        assert(qcnf_var_exists(qcnf, lit_to_var(literals[i])));
+        c->occs[i] = literals[i];
+    }
+    return c;
+}
 
 bool qcnf_register_clause(QCNF* qcnf, Clause* c) {
     if (qcnf_is_duplicate(qcnf,c)) {
         return false;
     }
-    
+    qcnf_register_clause_unchecked(qcnf, c);
+    return true;
+}
+
+void qcnf_register_clause_unchecked(QCNF* qcnf, Clause* c) {
     // Update the occurrence lists
     for (int i = 0; i < c->size; i++) {
         vector_add(qcnf_get_occs_of_lit(qcnf, c->occs[i]), c);
@@ -525,7 +570,6 @@ bool qcnf_register_clause(QCNF* qcnf, Clause* c) {
     }
     
     stack_push_op(qcnf->stack, QCNF_OP_NEW_CLAUSE, c);
-    return true;
 }
 
 void qcnf_unregister_clause(QCNF* qcnf, Clause* c) {
@@ -543,13 +587,15 @@ void qcnf_unregister_clause(QCNF* qcnf, Clause* c) {
     c2_rl_delete_clause(c);
 }
 
+// The caller must make sure that no domain refers to the clause anymore. Its clause_idx is not reused.
 void qcnf_delete_clause(QCNF* qcnf, Clause* c) {
-    abortif(true, "Don't delete clauses for now.");
     assert(c);
     assert(!c->active);
     assert(!c->in_active_clause_vector);
+    assert(vector_get(qcnf->all_clauses, c->clause_idx) == c);
+    vector_set(qcnf->all_clauses, c->clause_idx, NULL);
+    clause_arena_release(qcnf->clause_arena, c, qcnf_clause_bytes(c->size));
     qcnf->deleted_clauses += 1;
-    qcnf_free_clause(c);
 }
 
 void qcnf_free_var(Var* v) {
@@ -560,10 +606,7 @@ void qcnf_free_var(Var* v) {
 }
 
 void qcnf_free(QCNF* qcnf) {
-    for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
-        Clause* c = vector_get(qcnf->all_clauses, i);
-        qcnf_free_clause(c);
-    }
+    clause_arena_free(qcnf->clause_arena);
     vector_free(qcnf->all_clauses);
     vector_free(qcnf->active_clauses);
     stack_free(qcnf->stack);
@@ -778,6 +821,14 @@ void qcnf_print_statistics(QCNF* qcnf) {
     V0("  Clauses: %u\n", vector_count(qcnf->active_clauses));
     V0("  Universal reductions: %u\n", qcnf->universal_reductions);
     V0("  Deleted clauses: %u\n", qcnf->deleted_clauses);
+    size_t inactive_bytes = 0;
+    for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
+        Clause* c = vector_get(qcnf->all_clauses, i);
+        if (c && ! c->active) {
+            inactive_bytes += qcnf_clause_bytes(c->size);
+        }
+    }
+    V0("  Clause memory: %zu KB (%zu KB held by inactive clauses, %zu KB free for reuse)\n", qcnf->clause_arena->allocated_bytes / 1024, inactive_bytes / 1024, qcnf->clause_arena->released_bytes / 1024);
 }
 
 //////////// INVARIANTS ///////////
@@ -818,7 +869,9 @@ void qcnf_check_invariants_clause(QCNF* qcnf, Clause* c) {
 void qcnf_check_invariants(QCNF* qcnf) {
     for (unsigned i = 0; i < vector_count(qcnf->all_clauses); i++) {
         Clause* c = vector_get(qcnf->all_clauses, i);
-        qcnf_check_invariants_clause(qcnf, c);
+        if (c) {
+            qcnf_check_invariants_clause(qcnf, c);
+        }
     }
     for (unsigned i = 1; i < var_vector_count(qcnf->vars); i++) {
         Var* v = var_vector_get(qcnf->vars, i++);
@@ -14,6 +14,7 @@
 #include "var_vector.h"
 #include "map.h"
 #include "undo_stack.h"
+#include "clause_arena.h"
 
 #include <stdbool.h>
 #include <limits.h>
@@ -80,7 +81,8 @@ struct Scope {
 
 struct QCNF {
     var_vector* vars; // indexed by var_id
-    vector* all_clauses; // indexed by clause_idx
+    vector* all_clauses; // indexed by clause_idx; NULL for deleted clauses
+    clause_arena* clause_arena; // owns the memory of all clauses
     vector* active_clauses; // indexed by clause_idx
     size_t clause_iterator_token; // makes sure that only one clause iterator is active at any point
     vector* scopes; // vector of scope, indexed by scope_id.
@@ -143,6 +145,7 @@ vector* qcnf_get_occs_of_lit(QCNF* qcnf, Lit lit);
 void qcnf_add_lit(QCNF*, int lit);
 Clause* qcnf_close_clause(QCNF*);
 Clause* qcnf_new_clause(QCNF* qcnf, int_vector* literals);
+Clause* qcnf_new_clause_from_sorted_literals(QCNF*, const Lit* literals, unsigned size); // literals must already be in the order qcnf_new_clause produces; does not register the clause
 
 // Scopes
 unsigned qcnf_scope_init(QCNF*, int_vector* vars); // Attention: vars may be disallocated.
@@ -186,6 +189,7 @@ typedef enum {
 void qcnf_undo_op(void* qcnf,char,void*);
 
 bool qcnf_register_clause(QCNF*, Clause*);
+void qcnf_register_clause_unchecked(QCNF*, Clause*); // skips the duplicate check
 void qcnf_unregister_clause(QCNF*, Clause*);
 bool qcnf_remove_literal(QCNF*, Clause*, Lit);
 void qcnf_delete_clause(QCNF*, Clause*);
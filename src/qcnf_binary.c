@@ -0,0 +1,131 @@
+//
+//  qcnf_binary.c
+//  cadet
+//
+//  Writes the binary format described in qcnf_binary.h. The format is loaded by c2_from_binary_file.
+//
+
+#include "qcnf_binary.h"
+
+#include "log.h"
+#include "util.h"
+
+#include <string.h>
+#include <assert.h>
+
+bool qcnf_is_binary_file(const char* file_name) {
+    FILE* f = fopen(file_name, "rb");
+    if (!f) {
+        return false;
+    }
+    char magic[8];
+    bool is_binary = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+                  && memcmp(magic, QCNF_BINARY_MAGIC, sizeof(magic)) == 0;
+    fclose(f);
+    return is_binary;
+}
+
+// Scopes in increasing order, universals before existentials; this reproduces the order in which the QDIMACS parser creates variables
+static int qcnf_binary_compare_vars(const void* a, const void* b) {
+    const qcnf_binary_var* v1 = (const qcnf_binary_var*) a;
+    const qcnf_binary_var* v2 = (const qcnf_binary_var*) b;
+    if (v1->scope_id != v2->scope_id) {
+        return v1->scope_id < v2->scope_id ? -1 : 1;
+    }
+    if (v1->is_universal != v2->is_universal) {
+        return v1->is_universal ? -1 : 1;
+    }
+    return v1->var_id < v2->var_id ? -1 : (v1->var_id > v2->var_id ? 1 : 0);
+}
+
+// Scope ids are stored in 16 bits, like in Var; qcnf_new_var rejects larger ones
+_Static_assert(sizeof(((Var*) NULL)->scope_id) <= sizeof(((qcnf_binary_var*) NULL)->scope_id), "scope ids do not fit the binary format");
+
+static void qcnf_binary_write_section(const void* data, size_t size, size_t count, FILE* f) {
+    abortif(count > 0 && fwrite(data, size, count, f) != count, "Could not write binary formula.");
+}
+
+void qcnf_write_binary(QCNF* qcnf, unsigned preprocessing, const char* file_name) {
+    abortif(qcnf_is_DQBF(qcnf), "Binary formula format does not support DQBF.");
+    V1("Writing binary formula to %s\n", file_name);
+    FILE* f = fopen(file_name, "wb");
+    abortif(!f, "Could not open file \"%s\" for writing.", file_name);
+
+    qcnf_binary_var* vars = malloc(sizeof(qcnf_binary_var) * var_vector_count(qcnf->vars));
+    uint32_t var_num = 0;
+    for (unsigned i = 1; i < var_vector_count(qcnf->vars); i++) {
+        if (qcnf_var_exists(qcnf, i)) {
+            Var* v = var_vector_get(qcnf->vars, i);
+            vars[var_num].var_id = v->var_id;
+            vars[var_num].scope_id = v->scope_id;
+            vars[var_num].is_universal = (uint8_t) v->is_universal;
+            vars[var_num].original = (uint8_t) v->original;
+            var_num++;
+        }
+    }
+    qsort(vars, var_num, sizeof(qcnf_binary_var), qcnf_binary_compare_vars);
+
+    uint32_t clause_num = vector_count(qcnf->all_clauses);
+    qcnf_binary_clause* clauses = malloc(sizeof(qcnf_binary_clause) * (clause_num + 1));
+    uint64_t lit_num = 0;
+    for (unsigned i = 0; i < clause_num; i++) {
+        Clause* c = vector_get(qcnf->all_clauses, i);
+        clauses[i].size = c->size;
+        clauses[i].flags = (c->original                  ? QCNF_BINARY_CLAUSE_ORIGINAL : 0)
+                         | (c->consistent_with_originals ? QCNF_BINARY_CLAUSE_CONSISTENT : 0)
+                         | (c->blocked                   ? QCNF_BINARY_CLAUSE_BLOCKED : 0)
+                         | (c->is_cube                   ? QCNF_BINARY_CLAUSE_IS_CUBE : 0)
+                         | (c->minimized                 ? QCNF_BINARY_CLAUSE_MINIMIZED : 0)
+                         | (c->active                    ? QCNF_BINARY_CLAUSE_ACTIVE : 0)
+                         | (c->in_active_clause_vector   ? QCNF_BINARY_CLAUSE_REGISTERED : 0);
+        lit_num += c->size;
+    }
+
+    uint64_t names_size = 0;
+    for (unsigned i = 0; i < vector_count(qcnf->variable_names); i++) {
+        char* name = vector_get(qcnf->variable_names, i);
+        if (name) {
+            names_size += 2 * sizeof(uint32_t) + strlen(name);
+        }
+    }
+
+    qcnf_binary_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, QCNF_BINARY_MAGIC, sizeof(header.magic));
+    header.version = QCNF_BINARY_VERSION;
+    header.byte_order_mark = QCNF_BINARY_BYTE_ORDER_MARK;
+    header.problem_type = (uint32_t) qcnf->problem_type;
+    header.preprocessing = preprocessing;
+    header.var_num = var_num;
+    header.max_var_id = var_vector_count(qcnf->vars) - 1;
+    header.scope_num = vector_count(qcnf->scopes);
+    header.clause_num = clause_num;
+    header.lit_num = lit_num;
+    header.names_size = names_size;
+    header.universal_reductions = qcnf->universal_reductions;
+    header.blocked_clauses = qcnf->blocked_clauses;
+
+    qcnf_binary_write_section(&header, sizeof(header), 1, f);
+    qcnf_binary_write_section(vars, sizeof(qcnf_binary_var), var_num, f);
+    qcnf_binary_write_section(clauses, sizeof(qcnf_binary_clause), clause_num, f);
+    for (unsigned i = 0; i < clause_num; i++) {
+        Clause* c = vector_get(qcnf->all_clauses, i);
+        qcnf_binary_write_section(c->occs, sizeof(Lit), c->size, f);
+    }
+    if (lit_num % 2 == 1) {
+        Lit padding = 0;
+        qcnf_binary_write_section(&padding, sizeof(Lit), 1, f);
+    }
+    for (unsigned i = 0; i < vector_count(qcnf->variable_names); i++) {
+        char* name = vector_get(qcnf->variable_names, i);
+        if (name) {
+            uint32_t entry[2] = {i, (uint32_t) strlen(name)};
+            qcnf_binary_write_section(entry, sizeof(uint32_t), 2, f);
+            qcnf_binary_write_section(name, 1, entry[1], f);
+        }
+    }
+
+    abortif(fclose(f) != 0, "Could not write binary formula.");
+    free(vars);
+    free(clauses);
+}
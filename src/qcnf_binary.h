@@ -0,0 +1,71 @@
+//
+//  qcnf_binary.h
+//  cadet
+//
+//  Binary serialization of a parsed and preprocessed QCNF. Loading it skips parsing, duplicate
+//  detection, and preprocessing, and reads the file through mmap.
+//
+
+#ifndef qcnf_binary_h
+#define qcnf_binary_h
+
+#include "qcnf.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define QCNF_BINARY_MAGIC "CADETQB\n"
+#define QCNF_BINARY_VERSION 1
+#define QCNF_BINARY_BYTE_ORDER_MARK 0x01020304u // files are written in native byte order; refuse to load them on other machines
+
+// Preprocessing steps that have been applied to the serialized formula
+#define QCNF_BINARY_PLAISTED_GREENBAUM 1u
+#define QCNF_BINARY_QBCE 2u
+
+/* Layout of the file; all sections start at offsets that are multiples of 8:
+ *   qcnf_binary_header
+ *   qcnf_binary_var[var_num]         variables in creation order
+ *   qcnf_binary_clause[clause_num]   all clauses in clause_idx order, including inactive ones
+ *   Lit[lit_num]                     the literals of all clauses, concatenated (the clause arena); padded to 8 bytes
+ *   names                            for each variable name: uint32 var_id, uint32 length, the characters (no terminating 0)
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t problem_type;
+    uint32_t preprocessing;
+    uint32_t var_num;
+    uint32_t max_var_id;
+    uint32_t scope_num;
+    uint32_t clause_num;
+    uint64_t lit_num;
+    uint64_t names_size;
+    uint32_t universal_reductions;
+    uint32_t blocked_clauses;
+} qcnf_binary_header;
+
+typedef struct {
+    uint32_t var_id;
+    uint16_t scope_id;
+    uint8_t is_universal;
+    uint8_t original;
+} qcnf_binary_var;
+
+#define QCNF_BINARY_CLAUSE_ORIGINAL         1u
+#define QCNF_BINARY_CLAUSE_CONSISTENT       2u
+#define QCNF_BINARY_CLAUSE_BLOCKED          4u
+#define QCNF_BINARY_CLAUSE_IS_CUBE          8u
+#define QCNF_BINARY_CLAUSE_MINIMIZED       16u
+#define QCNF_BINARY_CLAUSE_ACTIVE          32u
+#define QCNF_BINARY_CLAUSE_REGISTERED      64u // was registered at some point; i.e. it is in the active clause vector
+
+typedef struct {
+    uint32_t size;
+    uint32_t flags;
+} qcnf_binary_clause;
+
+bool qcnf_is_binary_file(const char* file_name);
+void qcnf_write_binary(QCNF*, unsigned preprocessing, const char* file_name);
+
+#endif /* qcnf_binary_h */
@@ -68,17 +68,17 @@ int qipasir_val (void * solver, int lit) {
     return c2_val(c2,lit);
 }
 
-//void qipasir_assume (void * solver, int lit) {
-//    V0("Not implemented");
-//    abort();
-//}
+void qipasir_assume (void * solver, int lit) {
+    assert(lit != 0);
+    c2_assume(solver, lit);
+}
 
-//int qipasir_failed (void * solver, int lit) {
-//    V0("Not implemented");
-//    abort();
-//}
+int qipasir_failed (void * solver, int lit) {
+    C2* c2 = (C2*) solver;
+    abortif(c2_result(c2) != CADET_RESULT_UNSAT, "qipasir_failed requires the solver to be in state UNSAT.");
+    return c2_is_core(c2, lit) ? 1 : 0;
+}
 
-//void qipasir_set_terminate (void * solver, void * state, int (*terminate)(void * state)) {
-//    V0("Not implemented");
-//    abort();
-//}
+void qipasir_set_terminate (void * solver, void * state, int (*terminate)(void * state)) {
+    c2_set_terminate(solver, state, terminate);
+}
@@ -49,6 +49,7 @@ void satsolver_set_max_var(SATSolver*, int new_max);
 int satsolver_get_max_var(SATSolver*);
 void satsolver_add(SATSolver*, int lit);
 void satsolver_add_all(SATSolver* solver, int_vector* lits);
+void satsolver_add_clause(SATSolver*, const int* lits, unsigned n); // adds the literals and finishes the clause
 void satsolver_assume(SATSolver*, int lit);
 void satsolver_clear_assumptions(SATSolver*);
 bool satsolver_inconsistent(SATSolver*);
@@ -71,6 +72,9 @@ const int* satsolver_next_maximal_satisfiable_subset_of_assumptions(SATSolver* s
 void satsolver_set_global_default_phase(SATSolver* s, int phase);
 void satsolver_set_default_phase_lit (SATSolver* s, int lit, int phase);
 
+// The callback is polled during satsolver_sat; if it returns a nonzero value, the call returns SATSOLVER_UNKNOWN
+void satsolver_set_interrupt(SATSolver*, void* state, int (*interrupt)(void* state));
+
 void satsolver_print(SATSolver*);
 void satsolver_print_translation_table(SATSolver*);
 void satsolver_print_statistics(SATSolver*);
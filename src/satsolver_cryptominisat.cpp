@@ -106,6 +106,13 @@ void satsolver_add(SATSolver* solver, int lit) {
     }
 }
 
+void satsolver_add_clause(SATSolver* solver, const int* lits, unsigned n) {
+    for (unsigned i = 0; i < n; i++) {
+        satsolver_add(solver, lits[i]);
+    }
+    satsolver_add(solver, 0);
+}
+
 // Currently doesn't work together with push-pop semantics
 void satsolver_assume(SATSolver* solver, int lit) {
     NOT_IMPLEMENTED();
@@ -161,6 +168,10 @@ void satsolver_set_default_phase_lit (SATSolver* solver, int lit, int phase) {
      return; // TODO*/
 }
 
+void satsolver_set_interrupt(SATSolver*, void*, int (*)(void*)) {
+    // CryptoMiniSat offers no callback; the caller has to check for interrupts between SAT calls
+}
+
 void satsolver_print(SATSolver*) {
     NOT_IMPLEMENTED();
 }
@@ -173,6 +173,13 @@ void satsolver_add(SATSolver* solver, int lit) {
 #endif
 }
 
+void satsolver_add_clause(SATSolver* solver, const int* lits, unsigned n) {
+    for (unsigned i = 0; i < n; i++) {
+        satsolver_add(solver, lits[i]);
+    }
+    satsolver_clause_finished(solver);
+}
+
 void satsolver_clause_finished(SATSolver* solver) {
     satsolver_clause_finished_for_context(solver, int_vector_count(solver->max_var_stack)); // int_vector_count(solver->max_var_stack) used as proxy for push_count
 }
@@ -373,6 +380,10 @@ void satsolver_set_default_phase_lit(SATSolver* solver, int lit, int phase) {
 #endif
 }
 
+void satsolver_set_interrupt(SATSolver* solver, void* state, int (*interrupt)(void* state)) {
+    picosat_set_interrupt(solver->ps, state, interrupt);
+}
+
 void satsolver_print_translation_table(SATSolver* solver) {
     V3("Translation table (outer -> inner):\n");
     for (int i = 1; i <= solver->max_var; i++) {
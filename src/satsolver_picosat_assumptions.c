@@ -17,27 +17,46 @@
 #include <stdint.h>
 #include "log.h"
 #include "picosat.h"
-#include "map.h"
 
 #define PICOSAT_DECISION_LIMIT -1
 
 struct SATSolver {
     PicoSAT* ps;
-    map* var_mapping;
+    int_vector* var_mapping; // indexed by var; contains the PicoSAT var, or 0 if the var was not used yet
     int max_var;
     int_vector* max_var_stack; // for undo
     int_vector* assumptions;
     bool assumptions_used_in_sat_call;
     int_vector* context_literals;
     
-    map* reverse_var_mapping;
-    bool maintain_reverse_mapping;
+    int_vector* reverse_var_mapping; // indexed by PicoSAT var; contains the var, or 0 for context literals
     
 #ifdef SATSOLVER_TRACE
     bool trace_solver_commands;
 #endif
 };
 
+// Creates a new PicoSAT variable; var is 0 for context literals
+static int satsolver_new_picosat_var(SATSolver* solver, int var) {
+    int nvar = picosat_inc_max_var(solver->ps);
+#ifdef SATSOLVER_TRACE
+    if (solver->trace_solver_commands) {
+        LOG_PRINTF("assert(picosat_inc_max_var(s) == %d);\n", nvar);
+    }
+#endif
+    if (var != 0) {
+        while (int_vector_count(solver->var_mapping) <= (unsigned) var) {
+            int_vector_add(solver->var_mapping, 0);
+        }
+        int_vector_set(solver->var_mapping, (unsigned) var, nvar);
+    }
+    while (int_vector_count(solver->reverse_var_mapping) <= (unsigned) nvar) {
+        int_vector_add(solver->reverse_var_mapping, 0);
+    }
+    int_vector_set(solver->reverse_var_mapping, (unsigned) nvar, var);
+    return nvar;
+}
+
 static inline int lit_from_int(SATSolver* solver, int lit) {
     bool neg = lit < 0;
     int var = neg ? -lit : lit;
@@ -49,39 +68,33 @@ static inline int lit_from_int(SATSolver* solver, int lit) {
     }
     
     // lookup variable
-    int nvar;
-    if (!map_contains(solver->var_mapping, var)) {
-        nvar = picosat_inc_max_var(solver->ps);
-#ifdef SATSOLVER_TRACE
-        if (solver->trace_solver_commands) {
-            LOG_PRINTF("assert(picosat_inc_max_var(s) == %d);\n", nvar);
-        }
-#endif
-        map_add(solver->var_mapping, var, (void *)(intptr_t)nvar);
-        if (solver->maintain_reverse_mapping) {
-            map_add(solver->reverse_var_mapping, nvar, (void *)(intptr_t)var);
-        }
-    } else {
-        nvar = (int) map_get(solver->var_mapping, var);
+    int nvar = (unsigned) var < int_vector_count(solver->var_mapping) ? int_vector_get(solver->var_mapping, (unsigned) var) : 0;
+    if (nvar == 0) {
+        nvar = satsolver_new_picosat_var(solver, var);
     }
     return neg ? -nvar : nvar;
 }
 
+static inline int int_from_lit(SATSolver* solver, int pico_lit) {
+    int nvar = pico_lit < 0 ? -pico_lit : pico_lit;
+    assert((unsigned) nvar < int_vector_count(solver->reverse_var_mapping));
+    int var = int_vector_get(solver->reverse_var_mapping, (unsigned) nvar);
+    return pico_lit < 0 ? -var : var;
+}
+
 SATSolver* satsolver_init() {
     SATSolver* solver = malloc(sizeof(SATSolver));
     solver->ps = picosat_init();
-    solver->var_mapping = map_init();
+    solver->var_mapping = int_vector_init();
+    int_vector_add(solver->var_mapping, 0); // var 0 is never used
     solver->max_var = 0;
     solver->max_var_stack = int_vector_init();
     solver->assumptions = int_vector_init();
     solver->assumptions_used_in_sat_call = false;
     solver->context_literals = int_vector_init();
     
-    solver->maintain_reverse_mapping = false;
-    solver->reverse_var_mapping = NULL;
-    if (solver->maintain_reverse_mapping) {
-        solver->reverse_var_mapping = map_init();
-    }
+    solver->reverse_var_mapping = int_vector_init();
+    int_vector_add(solver->reverse_var_mapping, 0);
     
 #ifdef SATSOLVER_TRACE
     solver->trace_solver_commands = false;
@@ -97,13 +110,11 @@ void satsolver_free(SATSolver* solver) {
 #endif
     
     picosat_reset(solver->ps);
-    map_free(solver->var_mapping);
+    int_vector_free(solver->var_mapping);
+    int_vector_free(solver->reverse_var_mapping);
+    int_vector_free(solver->max_var_stack);
     int_vector_free(solver->assumptions);
     int_vector_free(solver->context_literals);
-    
-    if (solver->maintain_reverse_mapping) {
-        map_free(solver->reverse_var_mapping);
-    }
     free(solver);
 }
 
@@ -185,6 +196,24 @@ void satsolver_add_all(SATSolver* solver, int_vector* lits) {
     }
 }
 
+void satsolver_add_clause(SATSolver* solver, const int* lits, unsigned n) {
+    if (solver->assumptions_used_in_sat_call) {
+        solver->assumptions_used_in_sat_call = false;
+        int_vector_reset(solver->assumptions);
+    }
+    for (unsigned i = 0; i < n; i++) {
+        assert(lits[i] != 0);
+        int pico_lit = lit_from_int(solver, lits[i]);
+        picosat_add(solver->ps, pico_lit);
+#ifdef SATSOLVER_TRACE
+        if (solver->trace_solver_commands) {
+            LOG_PRINTF("picosat_add(s,%d); // was lit %d \n", pico_lit, lits[i]);
+        }
+#endif
+    }
+    satsolver_clause_finished(solver);
+}
+
 void satsolver_clause_finished(SATSolver* solver) {
     satsolver_clause_finished_for_context(solver, int_vector_count(solver->context_literals)); // used as proxy for push_count
 }
@@ -412,12 +441,17 @@ void satsolver_set_default_phase_lit(SATSolver* solver, int lit, int phase) {
 #endif
 }
 
+void satsolver_set_interrupt(SATSolver* solver, void* state, int (*interrupt)(void* state)) {
+    picosat_set_interrupt(solver->ps, state, interrupt);
+}
+
 void satsolver_print_translation_table(SATSolver* solver) {
     V3("Translation table (outer -> inner):\n");
-    for (int i = 1; i <= solver->max_var; i++) {
-        if (map_contains(solver->var_mapping, i)) {
-            int a = (int)map_get(solver->var_mapping, i);
-            V3("%d -> %d\n", i, a);
+    for (unsigned i = 1; i < int_vector_count(solver->var_mapping); i++) {
+        int a = int_vector_get(solver->var_mapping, i);
+        if (a != 0) {
+            assert(int_from_lit(solver, a) == (int) i);
+            V3("%u -> %d\n", i, a);
         }
     }
 }
@@ -428,11 +462,11 @@ void satsolver_print(SATSolver* solver) {
 
 void satsolver_push(SATSolver* solver) {
     int_vector_add(solver->max_var_stack, solver->max_var);
-    int new_context_lit = picosat_inc_max_var(solver->ps);
+    int new_context_lit = satsolver_new_picosat_var(solver, 0);
     int_vector_add(solver->context_literals,new_context_lit);
 #ifdef SATSOLVER_TRACE
     if (solver->trace_solver_commands) {
-        LOG_PRINTF("assert(picosat_inc_max_var(s) == %d); // push context %d\n", new_context_lit, int_vector_count(solver->context_literals));
+        LOG_PRINTF("// push context %d\n", int_vector_count(solver->context_literals));
     }
 #endif
 }
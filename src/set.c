@@ -11,40 +11,16 @@
 #include "util.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 
 #define INITIAL_SET_SIZE 8
+#define SET_MAX_DIST 255 // the distance array uses one byte per slot; longer probe sequences trigger a resize
+#define SET_NOT_FOUND ((size_t) -1)
 
-// From https://gist.github.com/badboy/6267743
-//int hash32shiftmult(int key) {
-//    int c2 = 0x27d4eb2d; // a prime or an odd constant
-//    key = (key ^ 61) ^ (key >> 16);
-//    key = key + (key << 3);
-//    key = key ^ (key >> 4);
-//    key = key * c2;
-//    key = key ^ (key >> 15);
-//    return key;
-//}
-
-//long hash64shift(void* k) {
-//    assert(sizeof(long) == 4);
-//    assert(sizeof(long long) == 8);
-//    assert(sizeof(void*) == 8);
-//    long long key = (long long) k;
-//    key = (~key) + (key << 21); // key = (key << 21) - key - 1;
-//    key = key ^ (key >> 24);
-//    key = (key + (key << 3)) + (key << 8); // key * 265
-//    key = key ^ (key >> 14);
-//    key = (key + (key << 2)) + (key << 4); // key * 21
-//    key = key ^ (key >> 28);
-//    key = key + (key << 31);
-//    return key;
-//}
-
-
-int set_hash_function(void* key, size_t size) {
-    return abs(hash6432shift(key)) % (int) size;
+static inline size_t set_home_slot(set* container, void* key) {
+    return (size_t) (unsigned) hash6432shift(key) & (container->size - 1);
 }
 
 set* set_init() {
@@ -52,111 +28,123 @@ set* set_init() {
 }
 
 set* set_init_size(size_t size) {
+    size_t slots = INITIAL_SET_SIZE;
+    while (slots < size) {
+        slots *= 2;
+    }
     set* container = malloc(sizeof(set));
-    container->data = calloc(sizeof(set_entry*), size);
+    container->keys = malloc(sizeof(void*) * slots);
+    container->dist = calloc(sizeof(uint8_t), slots);
     container->count = 0;
-    container->size = size;
+    container->size = slots;
     return container;
 }
 
-set_entry* set_get_entry(set* container, void* key) {
-    int hash = set_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    set_entry* entry = container->data[hash];
-    while (entry != NULL && entry->key != key) {
-        entry = entry->next;
+static size_t set_find(set* container, void* key) {
+    size_t mask = container->size - 1;
+    size_t i = set_home_slot(container, key);
+    for (unsigned d = 1; d <= container->dist[i]; d++) { // Robin Hood: key cannot be behind a slot closer to its home
+        if (container->dist[i] == d && container->keys[i] == key) {
+            return i;
+        }
+        i = (i + 1) & mask;
     }
-    return entry;
+    return SET_NOT_FOUND;
 }
 
 bool set_contains(set* container, void* key) {
-    return set_get_entry(container, key) != NULL;
+    return set_find(container, key) != SET_NOT_FOUND;
+}
+
+// Places the key without checking the load factor
+static void set_insert(set* container, void* key) {
+    size_t mask = container->size - 1;
+    size_t i = set_home_slot(container, key);
+    unsigned d = 1;
+    while (container->dist[i] != 0) {
+        if (container->dist[i] < d) { // take the slot from the richer key, continue with that one
+            void* displaced_key = container->keys[i];
+            unsigned displaced_dist = container->dist[i];
+            container->keys[i] = key;
+            container->dist[i] = (uint8_t) d;
+            key = displaced_key;
+            d = displaced_dist;
+        }
+        i = (i + 1) & mask;
+        d++;
+        if (d == SET_MAX_DIST) {
+            set_resize(container, 2 * container->size);
+            set_insert(container, key);
+            return;
+        }
+    }
+    container->keys[i] = key;
+    container->dist[i] = (uint8_t) d;
 }
 
 void set_add(set* container, void* key) {
     assert(!set_contains(container, key));
-    int hash = set_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    set_entry* new_entry = malloc(sizeof(set_entry));
-    new_entry->key = key;
-    new_entry->next = container->data[hash];
-    container->data[hash] = new_entry;
-    
     container->count++;
-    
-    if (container->count > container->size + container->size / 2) {
+    if (4 * container->count > 3 * container->size) {
         set_resize(container, 2 * container->size);
     }
+    set_insert(container, key);
 }
 
 void set_resize(set* container, size_t new_size) {
 //    V4("Resizing container to size %zu\n", new_size);
     size_t old_size = container->size;
-    set_entry** old_data = container->data;
+    void** old_keys = container->keys;
+    uint8_t* old_dist = container->dist;
     
-    container->size = new_size;
-    container->data = calloc(sizeof(set_entry*), new_size);
+    size_t slots = INITIAL_SET_SIZE;
+    while (slots < new_size || 4 * container->count > 3 * slots) {
+        slots *= 2;
+    }
+    container->size = slots;
+    container->keys = malloc(sizeof(void*) * slots);
+    container->dist = calloc(sizeof(uint8_t), slots);
     
     for (size_t i = 0; i < old_size; i++) {
-        set_entry* entry = old_data[i];
-        while (entry != NULL) {
-            set_entry* next = entry->next;
-            int new_hash = set_hash_function(entry->key, container->size);
-            assert(new_hash >= 0 && new_hash < (int) container->size);
-            
-            entry->next = container->data[new_hash];
-            container->data[new_hash] = entry;
-            
-            entry = next;
+        if (old_dist[i] != 0) {
+            set_insert(container, old_keys[i]);
         }
     }
     
-    free(old_data);
+    free(old_keys);
+    free(old_dist);
 }
 
 void set_remove(set* container, void* key) {
-    int hash = set_hash_function(key, container->size);
-    assert(hash >= 0 && hash < (int) container->size);
-    
-    set_entry* entry = container->data[hash];
-    set_entry* prev = NULL;
-    while (entry != NULL && entry->key != key) {
-        prev = entry;
-        entry = entry->next;
-    }
-    if (entry == NULL) {
+    size_t i = set_find(container, key);
+    if (i == SET_NOT_FOUND) {
         V4("Warning: trying to remove non-existent set element.\n");
         return;
     }
     container->count--;
-    if (prev == NULL) {
-        container->data[hash] = entry->next;
-    } else {
-        prev->next = entry->next;
+    // Backward shift deletion: move the following displaced keys one slot closer to their home
+    size_t mask = container->size - 1;
+    size_t next = (i + 1) & mask;
+    while (container->dist[next] > 1) {
+        container->keys[i] = container->keys[next];
+        container->dist[i] = (uint8_t) (container->dist[next] - 1);
+        i = next;
+        next = (next + 1) & mask;
     }
-    free(entry);
+    container->dist[i] = 0;
 }
 
 void set_reset(set* container) {
     if (set_count(container) == 0) {
         return;
     }
-    for (size_t i = 0; i < container->size; i++) {
-        set_entry* next_e;
-        for (set_entry* e = container->data[i]; e != NULL; e = next_e) {
-            next_e = e->next;
-            free(e);
-        }
-        container->data[i] = 0;
-    }
+    memset(container->dist, 0, sizeof(uint8_t) * container->size);
     container->count = 0;
 }
 
 void set_free(set* container) {
-    set_reset(container);
-    free(container->data);
+    free(container->keys);
+    free(container->dist);
     free(container);
 }
 
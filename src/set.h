@@ -13,19 +13,15 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-struct set_entry;
-typedef struct set_entry set_entry;
-
-struct set_entry {
-    void*      key;
-    set_entry* next;
-};
-
+// Open addressing with linear probing and Robin Hood displacement. Slots are kept in two arrays,
+// so that probing scans the small distance array and only touches the keys that may match.
 struct set {
-    set_entry** data;
-    size_t      size;
-    size_t      count;
+    void**   keys;
+    uint8_t* dist;  // 1 + distance of the key from its home slot; 0 for empty slots
+    size_t   size;  // number of slots, always a power of two
+    size_t   count;
 };
 
 typedef struct set set;
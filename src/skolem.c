@@ -21,6 +21,10 @@
 #include <sys/time.h>
 
 Skolem* skolem_init(QCNF* qcnf, Options* o) {
+    return skolem_init_with_universal_assumptions(qcnf, o, NULL);
+}
+
+Skolem* skolem_init_with_universal_assumptions(QCNF* qcnf, Options* o, int_vector* universal_assumptions) {
     Skolem* s = malloc(sizeof(Skolem));
     s->options = o;
     s->qcnf = qcnf;
@@ -37,6 +41,15 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     satsolver_clause_finished(s->skolem);
     s->dependency_choice_sat_lit = satsolver_inc_max_var(s->skolem);
     
+    s->local_checker = NULL; // created lazily on the first local check
+    s->local_checks_since_recycle = 0;
+    s->local_checker_var_map = int_vector_init();
+    s->local_checker_touched = int_vector_init();
+    s->local_determinicity_antecedents = int_vector_init();
+    s->syntactic_check_assignment = int_vector_init();
+    s->clause_satlits = int_vector_init();
+    s->decision_heap = NULL;
+    
     s->infos = skolem_var_vector_init_with_size(var_vector_count(qcnf->vars) + var_vector_count(qcnf->vars) / 2); // should usually prevent any resizing of the skolem_var_vector
     s->conflict_var_id = 0;
     s->conflicted_clause = NULL;
@@ -50,14 +63,21 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
         s->empty_dependencies.dependence_lvl = 0;
     }
     
-    s->determinicity_queue = pqueue_init(); // worklist_init(qcnf_compare_variables_by_occ_num);
-    s->pure_var_queue = pqueue_init();
+    s->determinicity_queue = pqueue_init_dense(bit_vector_index_of_var); // worklist_init(qcnf_compare_variables_by_occ_num);
+    s->pure_var_queue = pqueue_init_dense(bit_vector_index_of_var);
     s->potential_conflicts_satlits = int_vector_init();
     s->potentially_conflicted_variables = int_vector_init();
     s->unique_consequence = int_vector_init();
     s->stack = stack_init(skolem_undo);
+    s->var_trail_size = 64;
+    s->var_trail = malloc(sizeof(skolem_var_snapshot) * s->var_trail_size);
+    s->var_trail_count = 0;
+    s->unique_consequence_trail = int_vector_init();
+    s->trail_levels = int_vector_init();
     
     s->clauses_to_check = vector_init();
+    s->watches = vector_init();
+    s->watched_lits = int_vector_init();
     
     s->decision_satlits = int_vector_init();
     s->decisions = int_vector_init();
@@ -68,14 +88,21 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     s->statistics.propagations = 0;
     s->statistics.explicit_propagations = 0;
     s->statistics.explicit_propagation_conflicts = 0;
+    s->statistics.explicit_propagation_clause_checks = 0;
     s->statistics.local_determinicity_checks = 0;
     s->statistics.local_conflict_checks = 0;
     s->statistics.global_conflict_checks = 0;
     s->statistics.pure_vars = 0;
     s->statistics.pure_constants = 0;
+    s->statistics.local_determinicity_checks_syntactic = 0;
+    s->statistics.local_determinicity_checks_sat = 0;
+    s->statistics.local_checker_reuses = 0;
+    s->statistics.local_checker_recycles = 0;
     
     s->statistics.global_conflict_checks_sat = statistics_init(10000);
     s->statistics.global_conflict_checks_unsat = statistics_init(10000);
+    s->statistics.local_determinicity_checks_time = statistics_init(10000);
+    s->statistics.local_conflict_checks_time = statistics_init(10000);
     
     // Magic constants
     s->magic.initial_conflict_potential = 0.3f; // [0..1]
@@ -83,6 +110,9 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
     s->magic.conflict_potential_threshold = 0.8f; // (0..1)
     s->magic.conflict_potential_offset = 0.00f;
     s->magic.blocked_clause_occurrence_cutoff = 20;
+    s->magic.local_checker_recycle_frequency = 100;
+    s->magic.syntactic_determinicity_check_max_literals = 64;
+    s->magic.syntactic_determinicity_check_branching_max_literals = 16;
     
     // initialize the initially deterministic variables; these are usually the universals
     for (unsigned i = 1; i < var_vector_count(qcnf->vars); i++) {
@@ -90,6 +120,13 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
             skolem_new_variable(s, i);
         }
     }
+    // universal clauses and learnt clauses over universals may be satisfied by the assumptions
+    for (unsigned i = 0; universal_assumptions != NULL && i < int_vector_count(universal_assumptions); i++) {
+        Lit lit = int_vector_get(universal_assumptions, i);
+        if (skolem_get_constant_value(s, lit) == 0) { // contradicting assumptions are left to the caller
+            skolem_make_universal_assumption(s, lit);
+        }
+    }
     // search for unit clauses and clauses with unique consequence
     Clause_Iterator ci = qcnf_get_clause_iterator(qcnf); Clause* c = NULL;
     while ((c = qcnf_next_clause(&ci)) != NULL) {
@@ -100,10 +137,24 @@ Skolem* skolem_init(QCNF* qcnf, Options* o) {
 
 void skolem_free(Skolem* s) {
     if(s->skolem) {satsolver_free(s->skolem);}
+    if(s->local_checker) {satsolver_free(s->local_checker);}
+    int_vector_free(s->local_checker_var_map);
+    int_vector_free(s->local_checker_touched);
+    int_vector_free(s->local_determinicity_antecedents);
+    int_vector_free(s->syntactic_check_assignment);
+    int_vector_free(s->clause_satlits);
+    statistics_free(s->statistics.local_determinicity_checks_time);
+    statistics_free(s->statistics.local_conflict_checks_time);
     skolem_var_vector_free(s->infos);
     pqueue_free(s->determinicity_queue);
     pqueue_free(s->pure_var_queue);
     vector_free(s->clauses_to_check);
+    for (unsigned i = 0; i < vector_count(s->watches); i++) {
+        vector* w = vector_get(s->watches, i);
+        if (w) {vector_free(w);}
+    }
+    vector_free(s->watches);
+    int_vector_free(s->watched_lits);
     int_vector_free(s->potential_conflicts_satlits);
     int_vector_free(s->potentially_conflicted_variables);
     int_vector_free(s->unique_consequence);
@@ -111,6 +162,9 @@ void skolem_free(Skolem* s) {
     int_vector_free(s->universals_assumptions);
     int_vector_free(s->decision_satlits);
     stack_free(s->stack);
+    free(s->var_trail);
+    int_vector_free(s->unique_consequence_trail);
+    int_vector_free(s->trail_levels);
     free(s);
 }
 
@@ -144,6 +198,8 @@ void skolem_new_clause(Skolem* s, Clause* c) {
     abortif(c == NULL, "Clause pointer is NULL in skolem_new_clause.\n");
     assert(skolem_get_unique_consequence(s, c) == 0);
     
+    skolem_watch_clause(s, c); // also satisfied clauses, as backtracking may unsatisfy them
+    
     if (skolem_clause_satisfied(s, c)) {
         return;
     }
@@ -170,6 +226,7 @@ void skolem_new_clause(Skolem* s, Clause* c) {
             satsolver_clause_finished_for_context(s->skolem, 0);
         } else {
             V2("Added deterministic clause.\n");
+            satsolver_push(s->skolem); // popped when the conflict is undone, as in skolem_global_conflict_check
             for (unsigned i = 0; i < c->size; i++) {
                 satsolver_assume(s->skolem, skolem_get_satsolver_lit(s, - c->occs[i]));
             }
@@ -182,6 +239,7 @@ void skolem_new_clause(Skolem* s, Clause* c) {
                 s->conflict_var_id = lit_to_var(lastlit);
                 stack_push_op(s->stack, SKOLEM_OP_SKOLEM_CONFLICT, NULL);
             } else {
+                satsolver_pop(s->skolem);
                 V2("Deterministic clause that was added is consistent.\n");
                 if (debug_verbosity >= VERBOSITY_MEDIUM) {
                     qcnf_print_clause(c, stdout);
@@ -196,11 +254,25 @@ void skolem_new_clause(Skolem* s, Clause* c) {
     }
 }
 
+// Drops the watches eagerly, so that the memory of the clause can be reused
 void skolem_forget_clause(Skolem* s, Clause* c) {
     assert(s->conflicted_clause != c);
+    assert(! vector_contains(s->clauses_to_check, c));
     if (skolem_has_unique_consequence(s, c)) {
         skolem_set_unique_consequence(s, c, 0);
     }
+    if (int_vector_count(s->watched_lits) > 2 * c->clause_idx + 1) {
+        Lit first = int_vector_get(s->watched_lits, 2 * c->clause_idx);
+        Lit second = int_vector_get(s->watched_lits, 2 * c->clause_idx + 1);
+        if (first != 0) {
+            vector_remove_unsorted(skolem_get_watches(s, first), c);
+        }
+        if (second != 0 && second != first) {
+            vector_remove_unsorted(skolem_get_watches(s, second), c);
+        }
+        int_vector_set(s->watched_lits, 2 * c->clause_idx, 0);
+        int_vector_set(s->watched_lits, 2 * c->clause_idx + 1, 0);
+    }
 }
 
 void skolem_new_variable(Skolem* s, unsigned var_id) {
@@ -225,6 +297,9 @@ void skolem_new_variable(Skolem* s, unsigned var_id) {
         skolem_update_dependencies(s, var_id, dep);
     }
     if (qcnf_is_existential(s->qcnf, var_id)) {
+        if (s->decision_heap && ! skolem_is_deterministic(s, var_id) && ! var_heap_contains(s->decision_heap, var_id)) {
+            var_heap_insert(s->decision_heap, var_id);
+        }
         // to make sure we don't miss pure variables
         unsigned pos_count = vector_count(qcnf_get_occs_of_lit(s->qcnf,   (Lit) var_id));
         unsigned neg_count = vector_count(qcnf_get_occs_of_lit(s->qcnf, - (Lit) var_id));
@@ -340,30 +415,15 @@ int skolem_get_depends_on_decision_satlit(Skolem* s, unsigned var_id) {
     return si.depends_on_decision_satlit;
 }
 
-struct UNIQUE_CONSEQUENCE_UNDO_INFO;
-typedef struct UNIQUE_CONSEQUENCE_UNDO_INFO UNIQUE_CONSEQUENCE_UNDO_INFO;
-
-// The union is needed for casting between int64 and the decision_struct
-typedef union {
-    struct {
-        unsigned clause_id;
-        Lit lit;
-    } components;
-    int64_t data;
-} UNIQUE_CONSEQUENCE_UNDO_INFO_UNION;
-
 void skolem_set_unique_consequence(Skolem* s, Clause* c, Lit lit) {
     V3("  Assigning clause %d unique consequence %d\n", c->clause_idx, lit);
     while (int_vector_count(s->unique_consequence) <= c->clause_idx) {
         int_vector_add(s->unique_consequence, 0);
     }
-    UNIQUE_CONSEQUENCE_UNDO_INFO_UNION ucui;
-    ucui.components.clause_id = c->clause_idx;
-    ucui.components.lit = int_vector_get(s->unique_consequence, c->clause_idx);
+    Lit previous = int_vector_get(s->unique_consequence, c->clause_idx);
+    assert(previous != lit);
     
-    assert(ucui.components.lit != lit);
-    
-    stack_push_op(s->stack, SKOLEM_OP_UNIQUE_CONSEQUENCE, (void*) (uint64_t) ucui.data); // (uint64_t) c->clause_id
+    skolem_save_unique_consequence(s, c->clause_idx, previous);
     int_vector_set(s->unique_consequence, c->clause_idx, lit);
     
     c2_rl_update_unique_consequence(c->clause_idx, lit);
@@ -419,15 +479,11 @@ void skolem_check_for_unique_consequence(Skolem* s, Clause* c) {
 }
 
 /*
- * This function extends the definition of variable v by a configurable selection of clauses.
- * Only clauses with unique consequence var_id or -var_id are admitted.
- *
- * The flag skip_v_occurrences allows to suppress adding the occurrences of var_id and -var_id,
- * which is used for determinicity checks.
+ * Collects the antecedents of the clauses with unique consequence var_id or -var_id in
+ * s->local_determinicity_antecedents, each terminated by 0. Literals that are constantly
+ * false are dropped. The variable is locally deterministic iff these clauses are unsatisfiable.
  */
-bool skolem_add_occurrences_for_determinicity_check(Skolem* s, SATSolver* sat,
-                                           unsigned var_id, vector* occs) {
-    bool case_exists = false;
+void skolem_collect_antecedents_for_determinicity_check(Skolem* s, unsigned var_id, vector* occs) {
     for (unsigned i = 0; i < vector_count(occs); i++) {
         Clause* c = vector_get(occs, i);
         Lit uc = skolem_get_unique_consequence(s, c);
@@ -437,14 +493,12 @@ bool skolem_add_occurrences_for_determinicity_check(Skolem* s, SATSolver* sat,
             
             for (unsigned i = 0; i < c->size; i++) {
                 if (lit_to_var(c->occs[i]) != var_id && ! skolem_lit_satisfied(s, - c->occs[i])) {
-                    satsolver_add(sat, c->occs[i]);
+                    int_vector_add(s->local_determinicity_antecedents, c->occs[i]);
                 }
             }
-            satsolver_clause_finished(sat);
-            case_exists = true;
+            int_vector_add(s->local_determinicity_antecedents, 0);
         }
     }
-    return case_exists;
 }
 
 void skolem_add_clauses_using_existing_satlits(Skolem* s, unsigned var_id, vector* occs) {
@@ -457,13 +511,140 @@ void skolem_add_clauses_using_existing_satlits(Skolem* s, unsigned var_id, vecto
             && ! skolem_has_illegal_dependence(s,c)
             /*&& ! skolem_clause_satisfied(s, c)*/) {
             
+            int_vector_reset(s->clause_satlits);
             for (unsigned i = 0; i < c->size; i++) {
-                int sat_lit = skolem_get_satsolver_lit(s, c->occs[i]);
-                satsolver_add(s->skolem, sat_lit);
+                int_vector_add(s->clause_satlits, skolem_get_satsolver_lit(s, c->occs[i]));
+            }
+            satsolver_add_clause(s->skolem, int_vector_get_data(s->clause_satlits), int_vector_count(s->clause_satlits));
+        }
+    }
+}
+
+/* Local checks are many small SAT calls that are independent of each other. Instead of constructing
+ * a fresh SATSolver for every check, all local checks share one solver and each check lives in its own
+ * push/pop context (the SATSolver realizes contexts by activation literals).
+ *
+ * The SAT solver assigns all variables it knows in every call, so the variables of each check are
+ * renumbered densely, starting from 1 (see skolem_local_check_lit). Consecutive checks thereby reuse
+ * the same solver variables. Every context leaves a dead activation literal behind, so the solver is
+ * replaced every local_checker_recycle_frequency checks.
+ */
+SATSolver* skolem_local_check_begin(Skolem* s) {
+    assert(int_vector_count(s->local_checker_touched) == 0);
+    if (s->local_checker == NULL || s->local_checks_since_recycle >= s->magic.local_checker_recycle_frequency) {
+        if (s->local_checker) {
+            satsolver_free(s->local_checker);
+            s->statistics.local_checker_recycles++;
+        }
+        s->local_checker = satsolver_init();
+        s->local_checks_since_recycle = 0;
+    } else {
+        s->statistics.local_checker_reuses++;
+    }
+    s->local_checks_since_recycle++;
+    satsolver_push(s->local_checker);
+    return s->local_checker;
+}
+
+// Translates a literal of the current check (lit over var_ids or skolem satlits) into a literal of the local checker
+int skolem_local_check_lit(Skolem* s, int lit) {
+    assert(lit != 0);
+    unsigned var = lit_to_var(lit);
+    while (int_vector_count(s->local_checker_var_map) <= var) {
+        int_vector_add(s->local_checker_var_map, 0);
+    }
+    int local_var = int_vector_get(s->local_checker_var_map, var);
+    if (local_var == 0) {
+        local_var = satsolver_inc_max_var(s->local_checker);
+        int_vector_set(s->local_checker_var_map, var, local_var);
+        int_vector_add(s->local_checker_touched, (int) var);
+    }
+    return lit > 0 ? local_var : - local_var;
+}
+
+void skolem_local_check_end(Skolem* s) {
+    satsolver_pop(s->local_checker);
+    for (unsigned i = 0; i < int_vector_count(s->local_checker_touched); i++) {
+        int_vector_set(s->local_checker_var_map, (unsigned) int_vector_get(s->local_checker_touched, i), 0);
+    }
+    int_vector_reset(s->local_checker_touched);
+}
+
+// Unit propagation over the collected antecedents, starting from s->syntactic_check_assignment. Returns true on conflict.
+bool skolem_syntactic_check_propagate(Skolem* s) {
+    int_vector* clauses = s->local_determinicity_antecedents;
+    int_vector* assignment = s->syntactic_check_assignment;
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        unsigned i = 0;
+        while (i < int_vector_count(clauses)) {
+            bool satisfied = false;
+            unsigned num_unassigned = 0;
+            int unassigned = 0;
+            for (int lit = int_vector_get(clauses, i); lit != 0; lit = int_vector_get(clauses, ++i)) {
+                if (satisfied || int_vector_contains(assignment, - lit)) {
+                    continue;
+                }
+                if (int_vector_contains(assignment, lit)) {
+                    satisfied = true;
+                } else if (unassigned != lit) {
+                    num_unassigned++;
+                    unassigned = lit;
+                }
+            }
+            i++; // skip the terminating 0
+            if (satisfied) {
+                continue;
+            }
+            if (num_unassigned == 0) {
+                return true;
+            }
+            if (num_unassigned == 1) {
+                int_vector_add(assignment, unassigned);
+                progress = true;
             }
-            satsolver_clause_finished(s->skolem);
         }
     }
+    return false;
+}
+
+bool skolem_syntactic_check_refutes(Skolem* s, int assumption) {
+    int_vector_reset(s->syntactic_check_assignment);
+    if (assumption != 0) {
+        int_vector_add(s->syntactic_check_assignment, assumption);
+    }
+    return skolem_syntactic_check_propagate(s);
+}
+
+/* Fast path for local determinicity checks. The antecedents of typical gate definitions are refuted
+ * by unit propagation (complementary antecedents, AND, OR), or by unit propagation after a case
+ * distinction on one of their variables (XOR, ITE). Returns true only if the variable is locally
+ * deterministic; false means that the SAT solver has to decide.
+ */
+bool skolem_check_for_local_determinicity_syntactically(Skolem* s) {
+    int_vector* clauses = s->local_determinicity_antecedents;
+    unsigned literal_num = int_vector_count(clauses);
+    if (literal_num > s->magic.syntactic_determinicity_check_max_literals) {
+        return false;
+    }
+    if (skolem_syntactic_check_refutes(s, 0)) {
+        return true;
+    }
+    if (literal_num > s->magic.syntactic_determinicity_check_branching_max_literals) {
+        return false;
+    }
+    for (unsigned i = 0; i < literal_num; i++) {
+        int var = abs(int_vector_get(clauses, i));
+        bool seen_before = var == 0;
+        for (unsigned j = 0; j < i && ! seen_before; j++) {
+            seen_before = abs(int_vector_get(clauses, j)) == var;
+        }
+        if (! seen_before && skolem_syntactic_check_refutes(s, var) && skolem_syntactic_check_refutes(s, - var)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool skolem_check_for_local_determinicity(Skolem* s, Var* v) {
@@ -472,20 +653,38 @@ bool skolem_check_for_local_determinicity(Skolem* s, Var* v) {
     
     V3("Checking local determinicity of var %d: ", v->var_id);
     s->statistics.local_determinicity_checks++;
+    statistics_start_timer(s->statistics.local_determinicity_checks_time);
     
-    SATSolver* sat = satsolver_init();
-    satsolver_set_max_var(sat, (int) var_vector_count(s->qcnf->vars));
-    skolem_add_occurrences_for_determinicity_check(s, sat, v->var_id, &v->pos_occs);
-    skolem_add_occurrences_for_determinicity_check(s, sat, v->var_id, &v->neg_occs);
-    int result = satsolver_sat(sat);
-    satsolver_free(sat);
+    int_vector_reset(s->local_determinicity_antecedents);
+    skolem_collect_antecedents_for_determinicity_check(s, v->var_id, &v->pos_occs);
+    skolem_collect_antecedents_for_determinicity_check(s, v->var_id, &v->neg_occs);
     
-    if (result == SATSOLVER_SAT) {
-        V3("not deterministic\n");
+    bool deterministic;
+    if (skolem_check_for_local_determinicity_syntactically(s)) {
+        s->statistics.local_determinicity_checks_syntactic++;
+        deterministic = true;
     } else {
+        s->statistics.local_determinicity_checks_sat++;
+        SATSolver* sat = skolem_local_check_begin(s);
+        for (unsigned i = 0; i < int_vector_count(s->local_determinicity_antecedents); i++) {
+            int lit = int_vector_get(s->local_determinicity_antecedents, i);
+            if (lit == 0) {
+                satsolver_clause_finished(sat);
+            } else {
+                satsolver_add(sat, skolem_local_check_lit(s, lit));
+            }
+        }
+        deterministic = satsolver_sat(sat) != SATSOLVER_SAT;
+        skolem_local_check_end(s);
+    }
+    statistics_stop_and_record_timer(s->statistics.local_determinicity_checks_time);
+    
+    if (deterministic) {
         V3("deterministic\n");
+    } else {
+        V3("not deterministic\n");
     }
-    return result != SATSOLVER_SAT;
+    return deterministic;
 }
 
 // Check if literal is blocking for all clauses where it is a unique consequence. See blocked clause elimination.
@@ -613,7 +812,7 @@ void skolem_add_unique_antecedents_of_v_local_conflict_check(Skolem* s, SATSolve
                                 break; // this antecedent can never be true.
                             } else {
                                 assert(skolem_is_deterministic(s, lit_to_var(inner)));
-                                satsolver_add(sat, skolem_get_satsolver_lit(s, - inner));
+                                satsolver_add(sat, skolem_local_check_lit(s, skolem_get_satsolver_lit(s, - inner)));
                                 satsolver_add(sat, conjunction_var);
                                 satsolver_clause_finished(sat);
                             }
@@ -638,10 +837,10 @@ bool skolem_is_locally_conflicted(Skolem* s, unsigned var_id) {
     
     V3("Checking for conflicts for var %d:", var_id);
     s->statistics.local_conflict_checks++;
+    statistics_start_timer(s->statistics.local_conflict_checks_time);
     
-    SATSolver* sat = satsolver_init();
-    satsolver_set_max_var(sat, satsolver_get_max_var(s->skolem));
-    satsolver_add(sat, s->satlit_true);
+    SATSolver* sat = skolem_local_check_begin(s);
+    satsolver_add(sat, skolem_local_check_lit(s, s->satlit_true));
     satsolver_clause_finished(sat);
     skolem_add_unique_antecedents_of_v_local_conflict_check(s, sat,   (Lit) var_id);
     skolem_add_unique_antecedents_of_v_local_conflict_check(s, sat, - (Lit) var_id);
@@ -649,7 +848,8 @@ bool skolem_is_locally_conflicted(Skolem* s, unsigned var_id) {
     //        satsolver_print(sat);
     //    }
     sat_res result = satsolver_sat(sat);
-    satsolver_free(sat);
+    skolem_local_check_end(s);
+    statistics_stop_and_record_timer(s->statistics.local_conflict_checks_time);
     if (result == SATSOLVER_SAT) {
         V3(" locally conflicted\n");
     } else {
@@ -909,16 +1109,17 @@ void skolem_propagate_partial_over_clause_for_lit(Skolem* s, Clause* c, Lit lit,
         satsolver_clause_finished(s->skolem);
         
         // second clause
+        int_vector_reset(s->clause_satlits);
         for (unsigned i = 0; i < c->size; i++) {
             if (lit == c->occs[i]) {continue;}
             bool is_legal = skolem_may_depend_on(s, lit_to_var(lit), lit_to_var(c->occs[i]));
             if (is_legal) {
                 assert(skolem_is_deterministic(s, lit_to_var(c->occs[i])));
-                satsolver_add(s->skolem, skolem_get_satsolver_lit(s, c->occs[i]));
+                int_vector_add(s->clause_satlits, skolem_get_satsolver_lit(s, c->occs[i]));
             }
         }
-        satsolver_add(s->skolem, newlit);
-        satsolver_clause_finished(s->skolem);
+        int_vector_add(s->clause_satlits, newlit);
+        satsolver_add_clause(s->skolem, int_vector_get_data(s->clause_satlits), int_vector_count(s->clause_satlits));
     }
     
 //    assert(!add_guarded_illegal_dependencies || prev->deterministic); // not true in case of conflicted decision vars
@@ -933,10 +1134,7 @@ void skolem_propagate_partial_over_clause_for_lit(Skolem* s, Clause* c, Lit lit,
 void skolem_encode_global_conflict_check(Skolem* s) {
     assert(int_vector_count(s->potentially_conflicted_variables) == int_vector_count(s->potential_conflicts_satlits));
     
-    for (unsigned i = 0; i < int_vector_count(s->potential_conflicts_satlits); i++) {
-        satsolver_add(s->skolem, int_vector_get(s->potential_conflicts_satlits, i));
-    }
-    satsolver_clause_finished(s->skolem);
+    satsolver_add_clause(s->skolem, int_vector_get_data(s->potential_conflicts_satlits), int_vector_count(s->potential_conflicts_satlits));
 }
 
 unsigned skolem_global_conflict_check(Skolem* s, unsigned var_id) {
@@ -1003,72 +1201,12 @@ unsigned skolem_global_conflict_check(Skolem* s, unsigned var_id) {
 
 void skolem_undo(void* parent, char type, void* obj) {
     Skolem* s = (Skolem*) parent;
-    union skolem_undo_union suu;
-    suu.ptr = obj;
-    skolem_var* si;
     
     switch (type) {
 
-        case SKOLEM_OP_UPDATE_INFO_POS_LIT:
-            si = skolem_var_vector_get(s->infos, suu.sus.var_id);
-            if (si->pos_lit == s->satlit_true && suu.sus.val != s->satlit_true) {
-                c2_rl_update_constant_value(suu.sus.var_id, 0);
-            }
-            si->pos_lit = suu.sus.val;
-            break;
-            
-        case SKOLEM_OP_UPDATE_INFO_NEG_LIT:
-            si = skolem_var_vector_get(s->infos, suu.sus.var_id);
-            if (si->neg_lit == s->satlit_true && suu.sus.val != s->satlit_true) {
-                c2_rl_update_constant_value(suu.sus.var_id, 0);
-            }
-            si->neg_lit = suu.sus.val;
-            break;
-            
-        case SKOLEM_OP_UPDATE_INFO_DETERMINISTIC:
-            si = skolem_var_vector_get(s->infos, suu.sus.var_id);
-            if (si->deterministic && (unsigned) suu.sus.val == 0) {
-                int_vector_pop(s->determinization_order);
-                c2_rl_update_D(suu.sus.var_id, false);
-            }
-            si->deterministic = (unsigned) suu.sus.val;
-            break;
-            
-        case SKOLEM_OP_UPDATE_INFO_PURE_POS:
-            si = skolem_var_vector_get(s->infos, suu.sus.var_id);
-            si->pure_pos = (unsigned) suu.sus.val;
-            break;
-            
-        case SKOLEM_OP_UPDATE_INFO_PURE_NEG:
-            si = skolem_var_vector_get(s->infos, suu.sus.var_id);
-            si->pure_neg = (unsigned) suu.sus.val;
-            break;
-            
-        case SKOLEM_OP_UPDATE_INFO_DEPENDENCIES:
-            skolem_undo_dependencies(s, obj);
-            break;
-            
-        case SKOLEM_OP_UPDATE_INFO_DECISION_LVL:
-            skolem_undo_decision_lvl(s, obj);
-            break;
-            
-        case SKOLEM_OP_UPDATE_INFO_REASON_FOR_CONSTANT:
-            skolem_undo_reason_for_constant(s, obj);
-            break;
-            
-        case SKOLEM_OP_UNIQUE_CONSEQUENCE:
-            assert(int_vector_count(s->unique_consequence) > (unsigned) obj);
-            assert(int_vector_get(s->unique_consequence, (unsigned) obj) != 0);
-            UNIQUE_CONSEQUENCE_UNDO_INFO_UNION ucui;
-            ucui.data = (int64_t) obj;
-            Clause* c = vector_get(s->qcnf->all_clauses, ucui.components.clause_id);
-            if (c->active) {
-                int_vector_set(s->unique_consequence, ucui.components.clause_id, ucui.components.lit);
-                c2_rl_update_unique_consequence(ucui.components.clause_id, ucui.components.lit);
-            } else {
-                // Clause was deleted
-                assert(int_vector_get(s->unique_consequence, ucui.components.clause_id) == 0);
-            }
+        case SKOLEM_OP_TRAIL_LEVEL:
+            assert(obj == NULL);
+            skolem_undo_trail_level(s);
             break;
             
         case SKOLEM_OP_PROPAGATION_CONFLICT:
@@ -1112,12 +1250,7 @@ void skolem_undo(void* parent, char type, void* obj) {
             break;
             
         case SKOLEM_OP_DECISION:
-            int_vector_pop(s->decisions);
-            
-            si = skolem_var_vector_get(s->infos, (unsigned) obj);
-            assert(si->decision_pos || si->decision_neg);
-            si->decision_pos = 0;
-            si->decision_neg = 0;
+            int_vector_pop(s->decisions); // decision_pos and decision_neg are restored with the trail level
             
             if (s->options->functional_synthesis) {
                 int_vector_pop(s->decision_satlits);
@@ -1144,19 +1277,28 @@ void skolem_increase_decision_lvl(Skolem* s) {
 
 void skolem_print_statistics(Skolem* s) {
     V0("Skolem statistics:\n");
-    V0("  Local determinicity checks: %zu\n",s->statistics.local_determinicity_checks);
+    V0("  Local determinicity checks: %zu (syntactic %zu, SAT %zu)\n",
+       s->statistics.local_determinicity_checks,
+       s->statistics.local_determinicity_checks_syntactic,
+       s->statistics.local_determinicity_checks_sat);
     V0("  Local conflict checks: %zu\n",s->statistics.local_conflict_checks);
     V0("  Global conflict checks: %zu\n",s->statistics.global_conflict_checks);
     V0("  Propagations: %zu\n", s->statistics.propagations);
     V0("  Pure variables: %zu\n", s->statistics.pure_vars);
     V0("    of which are constants: %zu\n", s->statistics.pure_constants);
-    V0("  Propagations of constants: %zu\n", s->statistics.explicit_propagations);
+    V0("  Propagations of constants: %zu (clauses checked: %zu)\n", s->statistics.explicit_propagations, s->statistics.explicit_propagation_clause_checks);
     V0("  Currently deterministic vars: %u\n", int_vector_count(s->determinization_order));
     satsolver_print_statistics(s->skolem);
     V0("  Histograms for SAT global conflict checks:\n");
     statistics_print(s->statistics.global_conflict_checks_sat);
     V0("  Histograms for UNSAT global conflict checks:\n");
     statistics_print(s->statistics.global_conflict_checks_unsat);
+    V0("  Local checks reusing the local checker: %zu (recycled %zu times)\n",
+       s->statistics.local_checker_reuses, s->statistics.local_checker_recycles);
+    V0("  Histograms for local determinicity checks:\n");
+    statistics_print(s->statistics.local_determinicity_checks_time);
+    V0("  Histograms for local conflict checks:\n");
+    statistics_print(s->statistics.local_conflict_checks_time);
 }
 
 void skolem_print_debug_info(Skolem* s) {
@@ -1317,11 +1459,7 @@ void skolem_assign_constant_value(Skolem* s, Lit lit, union Dependencies propaga
     skolem_update_dependencies(s, var_id, propagation_deps);
     
     // Queue potentially new constants
-    vector* opp_occs = qcnf_get_occs_of_lit(s->qcnf, - lit);
-    for (unsigned i = 0; i < vector_count(opp_occs); i++) {
-        Clause* c = (Clause*) vector_get(opp_occs, i);
-        vector_add(s->clauses_to_check, c);
-    }
+    skolem_update_watches(s, lit);
     
     // Queue potentially new pure variables
     vector* this_occs = qcnf_get_occs_of_lit(s->qcnf, lit);
@@ -1346,7 +1484,94 @@ void skolem_assign_constant_value(Skolem* s, Lit lit, union Dependencies propaga
     }
 }
 
+vector* skolem_get_watches(Skolem* s, Lit lit) {
+    unsigned idx = 2 * lit_to_var(lit) + (lit < 0 ? 1 : 0);
+    while (vector_count(s->watches) <= idx) {
+        vector_add(s->watches, NULL);
+    }
+    vector* w = vector_get(s->watches, idx);
+    if (w == NULL) {
+        w = vector_init();
+        vector_set(s->watches, idx, w);
+    }
+    return w;
+}
+
+/* Watches two literals that are not false, preferring true literals. If there are not enough of them,
+ * the false literals with the highest decision levels are watched; the clause is then unit or conflicted
+ * and skolem_new_clause takes care of it.
+ */
+void skolem_watch_clause(Skolem* s, Clause* c) {
+    while (int_vector_count(s->watched_lits) <= 2 * c->clause_idx + 1) {
+        int_vector_add(s->watched_lits, 0);
+    }
+    if (c->size == 0 || int_vector_get(s->watched_lits, 2 * c->clause_idx) != 0) {
+        return;
+    }
+    Lit best[2] = {0, 0};
+    int best_rank[2] = {-1, -1};
+    for (int i = 0; i < c->size; i++) {
+        Lit lit = c->occs[i];
+        int val = skolem_get_constant_value(s, lit);
+        int rank = val == 1 ? INT_MAX : (val == 0 ? INT_MAX - 1 : (int) skolem_get_dlvl_for_constant(s, lit_to_var(lit)));
+        if (rank > best_rank[0]) {
+            best[1] = best[0]; best_rank[1] = best_rank[0];
+            best[0] = lit;     best_rank[0] = rank;
+        } else if (rank > best_rank[1]) {
+            best[1] = lit;     best_rank[1] = rank;
+        }
+    }
+    if (c->size == 1) {
+        best[1] = best[0];
+    }
+    int_vector_set(s->watched_lits, 2 * c->clause_idx,     best[0]);
+    int_vector_set(s->watched_lits, 2 * c->clause_idx + 1, best[1]);
+    vector_add(skolem_get_watches(s, best[0]), c);
+    if (best[1] != best[0]) {
+        vector_add(skolem_get_watches(s, best[1]), c);
+    }
+}
+
+/* Watches only move from false literals to literals that are not false, so they stay valid when
+ * backtracking undoes constants and need no undo operations.
+ */
+void skolem_update_watches(Skolem* s, Lit lit) {
+    Lit false_lit = - lit;
+    vector* w = skolem_get_watches(s, false_lit);
+    unsigned j = 0; // clauses before j keep watching false_lit
+    for (unsigned i = 0; i < vector_count(w); i++) {
+        Clause* c = vector_get(w, i);
+        if (! c->active) {
+            continue; // drop the watch of the deleted clause
+        }
+        unsigned slot = int_vector_get(s->watched_lits, 2 * c->clause_idx) == false_lit ? 0 : 1;
+        assert(int_vector_get(s->watched_lits, 2 * c->clause_idx + slot) == false_lit);
+        Lit other = int_vector_get(s->watched_lits, 2 * c->clause_idx + 1 - slot);
+        if (skolem_get_constant_value(s, other) == 1) {
+            vector_set(w, j++, c);
+            continue;
+        }
+        Lit replacement = 0;
+        for (int k = 0; k < c->size; k++) {
+            Lit l = c->occs[k];
+            if (l != false_lit && l != other && skolem_get_constant_value(s, l) != -1) {
+                replacement = l;
+                break;
+            }
+        }
+        if (replacement != 0) {
+            int_vector_set(s->watched_lits, 2 * c->clause_idx + slot, replacement);
+            vector_add(skolem_get_watches(s, replacement), c);
+        } else {
+            vector_set(w, j++, c);
+            vector_add(s->clauses_to_check, c); // unit or conflicted
+        }
+    }
+    vector_reduce_count(w, j);
+}
+
 void skolem_propagate_constants_over_clause(Skolem* s, Clause* c) {
+    s->statistics.explicit_propagation_clause_checks += 1;
     Lit unassigned_lit = 0;
     union Dependencies maximal_deps = skolem_create_fresh_empty_dep(s);
 //    union Dependencies universals_max_deps = s->empty_dependencies; // all other dependencies should be larger
@@ -1568,6 +1793,13 @@ bool skolem_is_universal_assumption_vacuous(Skolem* s, Lit lit) {
     return satsolver_sat(s->skolem) != SATSOLVER_SAT;
 }
 
+// Whether the Skolem function of the deterministic variable can assign lit for some assignment in the domain
+bool skolem_can_take_value(Skolem* s, Lit lit) {
+    assert(skolem_is_deterministic(s, lit_to_var(lit)));
+    satsolver_assume(s->skolem, skolem_get_satsolver_lit(s, lit));
+    return satsolver_sat(s->skolem) == SATSOLVER_SAT;
+}
+
 bool skolem_check_if_domain_is_empty(Skolem* s) {
     if (s->state != SKOLEM_STATE_EMPTY_DOMAIN && satsolver_sat(s->skolem) == SATSOLVER_UNSAT) {
         skolem_update_state(s, SKOLEM_STATE_EMPTY_DOMAIN);
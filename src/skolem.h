@@ -21,6 +21,7 @@
 #include "skolem_var.h"
 #include "options.h"
 #include "statistics.h"
+#include "var_heap.h"
 
 #include <stdio.h>
 
@@ -42,16 +43,24 @@ struct Skolem_Statistics {
     size_t pure_vars;
     size_t pure_constants;
     size_t local_determinicity_checks;
+    size_t local_determinicity_checks_syntactic; // resolved by unit propagation on the antecedents, without a SAT call
+    size_t local_determinicity_checks_sat;
     size_t local_conflict_checks;
     size_t global_conflict_checks;
     
     size_t explicit_propagations;
     size_t explicit_propagation_conflicts;
+    size_t explicit_propagation_clause_checks;
     
     size_t decisions;
     
+    size_t local_checker_reuses; // local checks that did not need to construct a SATSolver
+    size_t local_checker_recycles;
+    
     Stats* global_conflict_checks_sat;
     Stats* global_conflict_checks_unsat;
+    Stats* local_determinicity_checks_time;
+    Stats* local_conflict_checks_time;
 };
 
 struct Skolem_Magic_Values {
@@ -61,6 +70,9 @@ struct Skolem_Magic_Values {
     float conflict_potential_threshold;
     float conflict_potential_offset;
     unsigned blocked_clause_occurrence_cutoff;
+    unsigned local_checker_recycle_frequency; // number of local checks after which the local checker is replaced
+    unsigned syntactic_determinicity_check_max_literals; // larger local determinicity checks go directly to the SAT solver
+    unsigned syntactic_determinicity_check_branching_max_literals; // try case distinctions only for very small checks (XOR, ITE)
 };
 
 struct Skolem {
@@ -70,6 +82,14 @@ struct Skolem {
     
     // Dependent objects
     SATSolver* skolem;
+    SATSolver* local_checker; // reused for local determinicity and local conflict checks; each check lives in its own push/pop context
+    unsigned local_checks_since_recycle;
+    int_vector* local_checker_var_map; // maps variables of the current local check to dense variables of the local checker
+    int_vector* local_checker_touched; // variables mapped in the current local check
+    int_vector* local_determinicity_antecedents; // clauses of the current local determinicity check, each terminated by 0
+    int_vector* syntactic_check_assignment; // literals assigned by the syntactic local determinicity check
+    int_vector* clause_satlits; // satlits of the clause currently encoded into the Skolem SAT solver
+    var_heap* decision_heap; // if set, contains exactly the nondeterministic existentials; not owned by the Skolem domain
     
     // Core Skolem state and data structures
     unsigned decision_lvl;
@@ -90,12 +110,15 @@ struct Skolem {
     int_vector* universals_assumptions;
     
     /* Propagation worklists:
-     * Constants are propagated through the clauses_to_check worklist.
+     * Constants are propagated through the clauses_to_check worklist. Each clause watches two literals,
+     * and only clauses for which no replacement for a false watched literal exists are added to the worklist.
      * For determinicity propagation, variables are first added to determinicity_queue,
      * if they are not deterministic, they are added to pure_var_queue to later check 
      * if they are pure.
      */
     vector* clauses_to_check; // stores clauses to check for constant propagation
+    vector* watches; // indexed by 2 * var_id, +1 for negative literals; contains vector* of the Clause*s watching the literal
+    int_vector* watched_lits; // two entries per clause_idx: the watched literals of the clause; 0 if it is not watched
     pqueue* determinicity_queue; // contains unsigned var_id
     pqueue* pure_var_queue; // contains unsigned var_id
     
@@ -113,6 +136,16 @@ struct Skolem {
     
     // Backtracking
     Stack* stack;
+    /* Typed trail for the most frequent updates: skolem_var records and unique consequences.
+     * Instead of one undo operation per field update, each skolem_var is saved once per push and
+     * restored as a whole. The first update after a push opens a trail level, which adds a single
+     * SKOLEM_OP_TRAIL_LEVEL to the stack; undoing it restores everything saved on that level.
+     */
+    skolem_var_snapshot* var_trail;
+    size_t var_trail_count;
+    size_t var_trail_size;
+    int_vector* unique_consequence_trail; // pairs of clause_idx and previous unique consequence
+    int_vector* trail_levels; // triples of push_count, var_trail_count, and count of unique_consequence_trail when the level was opened
     
     struct Skolem_Statistics statistics;
     
@@ -120,6 +153,7 @@ struct Skolem {
 };
 
 Skolem* skolem_init(QCNF*, Options*);
+Skolem* skolem_init_with_universal_assumptions(QCNF*, Options*, int_vector* universal_assumptions); // assumed before the clauses are added
 void skolem_free(Skolem*);
 
 // INTERACTION WITH CONFLICT ANALYSIS
@@ -133,6 +167,7 @@ void skolem_forget_clause(Skolem*, Clause*);
 void skolem_new_variable(Skolem*, unsigned var_id);
 void skolem_assign_constant_value(Skolem*,Lit,union Dependencies, Clause* reason); // reason may be NULL
 bool skolem_is_universal_assumption_vacuous(Skolem*, Lit);
+bool skolem_can_take_value(Skolem*, Lit);
 bool skolem_check_if_domain_is_empty(Skolem*);
 void skolem_make_universal_assumption(Skolem*,Lit);
 int skolem_get_constant_value(Skolem*, Lit);
@@ -167,15 +202,7 @@ void skolem_print_deterministic_vars(Skolem*);
 // PRIVATE FUNCTIONS
 
 typedef enum {
-    SKOLEM_OP_UPDATE_INFO_POS_LIT, // obj contains the variable and the previous poslit, see union skolem_undo_union
-    SKOLEM_OP_UPDATE_INFO_NEG_LIT, // obj contains the variable and the previous neglit, see union skolem_undo_union
-    SKOLEM_OP_UPDATE_INFO_DETERMINISTIC, // obj contains the variable and a single bit, see union skolem_undo_union
-    SKOLEM_OP_UPDATE_INFO_PURE_POS, // obj contains the variable and a single bit, see union skolem_undo_union
-    SKOLEM_OP_UPDATE_INFO_PURE_NEG, // obj contains the variable and a single bit, see union skolem_undo_union
-    SKOLEM_OP_UPDATE_INFO_DEPENDENCIES, // depending on mode, obj contains the variable and previous dependency level, or a pointer to a Dependency_Update_struct
-    SKOLEM_OP_UPDATE_INFO_DECISION_LVL,
-    SKOLEM_OP_UPDATE_INFO_REASON_FOR_CONSTANT,
-    SKOLEM_OP_UNIQUE_CONSEQUENCE,
+    SKOLEM_OP_TRAIL_LEVEL, // restores the skolem_vars and unique consequences saved since the trail level was opened
     SKOLEM_OP_PROPAGATION_CONFLICT,
     SKOLEM_OP_SKOLEM_CONFLICT,
     SKOLEM_OP_UPDATE_SKOLEM_STATE,
@@ -193,6 +220,10 @@ int skolem_get_constant_value(Skolem* s, Lit lit); // get the value of the varia
 
 void skolem_propagate_partial_over_clause_for_lit(Skolem*, Clause*, Lit, bool define_both_sides);
 
+vector* skolem_get_watches(Skolem*, Lit lit); // the clauses watching lit
+void skolem_watch_clause(Skolem*, Clause*);
+void skolem_update_watches(Skolem*, Lit lit); // lit was assigned a constant; queues the clauses that became unit or conflicted
+
 void skolem_check_occs_for_unique_consequences(Skolem*, Lit lit);
 void skolem_check_for_unique_consequence(Skolem*, Clause*);
 void skolem_set_unique_consequence(Skolem*, Clause*, Lit);
@@ -200,6 +231,11 @@ Lit skolem_get_unique_consequence(Skolem*, Clause*);
 bool skolem_has_unique_consequence(Skolem*, Clause*);
 bool skolem_is_locally_conflicted(Skolem*, unsigned var_id);
 
+SATSolver* skolem_local_check_begin(Skolem*);
+int skolem_local_check_lit(Skolem*, int lit);
+void skolem_local_check_end(Skolem*);
+bool skolem_check_for_local_determinicity_syntactically(Skolem*);
+
 // used by debug.c
 int skolem_get_satsolver_lit(Skolem* s, Lit lit);
 int skolem_get_depends_on_decision_satlit(Skolem* s, unsigned var_id);
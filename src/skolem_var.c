@@ -11,13 +11,7 @@
 #include "log.h"
 #include "c2_traces.h"
 #include "c2_rl.h"
-
-struct DEPENDENCECY_UPDATE;
-typedef struct DEPENDENCECY_UPDATE DEPENDENCECY_UPDATE;
-struct DEPENDENCECY_UPDATE {
-    unsigned var_id;
-    int_vector* dependencies;
-};
+#include "var_heap.h"
 
 skolem_var skolem_get_info(Skolem* s, unsigned var_id) {
     assert(var_id != 0);
@@ -125,6 +119,7 @@ void skolem_enlarge_skolem_var_vector(Skolem* s, unsigned var_id) {
     sv.conflict_potential = s->magic.initial_conflict_potential;
     sv.reason_for_constant = INT_MAX;
     sv.dlvl_for_constant = 0;
+    sv.trail_position = UINT_MAX;
     
     // add this sv to the var_vector
     while (skolem_var_vector_count(s->infos) <= var_id) {
@@ -132,9 +127,109 @@ void skolem_enlarge_skolem_var_vector(Skolem* s, unsigned var_id) {
     }
 }
 
-void skolem_update_reason_for_constant(Skolem* s, unsigned var_id, unsigned clause_id, unsigned dlvl) {
+// TRAIL
+
+// Opens a trail level for the current push, unless it is already open
+static void skolem_open_trail_level(Skolem* s) {
+    unsigned levels = int_vector_count(s->trail_levels);
+    if (levels > 0 && (unsigned) int_vector_get(s->trail_levels, levels - 3) == s->stack->push_count) {
+        return;
+    }
+    int_vector_add(s->trail_levels, (int) s->stack->push_count);
+    int_vector_add(s->trail_levels, (int) s->var_trail_count);
+    int_vector_add(s->trail_levels, (int) int_vector_count(s->unique_consequence_trail));
+    stack_push_op(s->stack, SKOLEM_OP_TRAIL_LEVEL, NULL);
+}
+
+// Must be called before each update of the undoable portion of a skolem_var
+static skolem_var* skolem_save_var(Skolem* s, unsigned var_id) {
     skolem_enlarge_skolem_var_vector(s, var_id);
     skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
+    if (s->stack->push_count == 0) { // like the undo stack, we don't store undo's before the first push
+        return sv;
+    }
+    skolem_open_trail_level(s);
+    size_t level_start = (size_t) int_vector_get(s->trail_levels, int_vector_count(s->trail_levels) - 2);
+    if (sv->trail_position >= level_start
+        && sv->trail_position < s->var_trail_count
+        && s->var_trail[sv->trail_position].var_id == var_id) {
+        return sv; // already saved on this trail level
+    }
+    if (s->var_trail_count == s->var_trail_size) {
+        s->var_trail_size *= 2;
+        s->var_trail = realloc(s->var_trail, sizeof(skolem_var_snapshot) * s->var_trail_size);
+        abortif(!s->var_trail, "Could not grow the trail of the Skolem domain.");
+    }
+    sv->trail_position = (unsigned) s->var_trail_count;
+    s->var_trail[s->var_trail_count].var_id = var_id;
+    s->var_trail[s->var_trail_count].sv = *sv;
+    s->var_trail_count += 1;
+    return sv;
+}
+
+void skolem_save_unique_consequence(Skolem* s, unsigned clause_idx, Lit previous) {
+    if (s->stack->push_count == 0) {
+        return;
+    }
+    skolem_open_trail_level(s);
+    int_vector_add(s->unique_consequence_trail, (int) clause_idx);
+    int_vector_add(s->unique_consequence_trail, previous);
+}
+
+void skolem_undo_trail_level(Skolem* s) {
+    size_t unique_consequence_start = (size_t) int_vector_pop(s->trail_levels);
+    size_t var_start = (size_t) int_vector_pop(s->trail_levels);
+    int_vector_pop(s->trail_levels); // push_count
+    
+    unsigned determinizations = 0;
+    while (s->var_trail_count > var_start) {
+        s->var_trail_count -= 1;
+        skolem_var_snapshot* snapshot = &s->var_trail[s->var_trail_count];
+        skolem_var* sv = skolem_var_vector_get(s->infos, snapshot->var_id);
+        if ((sv->pos_lit == s->satlit_true && snapshot->sv.pos_lit != s->satlit_true)
+            || (sv->neg_lit == s->satlit_true && snapshot->sv.neg_lit != s->satlit_true)) {
+            c2_rl_update_constant_value(snapshot->var_id, 0);
+        }
+        if (sv->deterministic && ! snapshot->sv.deterministic) {
+            determinizations += 1;
+        }
+        float conflict_potential = sv->conflict_potential;
+        unsigned trail_position = sv->trail_position;
+        *sv = snapshot->sv;
+        sv->conflict_potential = conflict_potential;
+        sv->trail_position = trail_position;
+    }
+    
+    // Determinizations are undone in reverse order, like they would by individual undo operations
+    for (unsigned i = 0; i < determinizations; i++) {
+        unsigned var_id = (unsigned) int_vector_pop(s->determinization_order);
+        assert(! skolem_is_deterministic(s, var_id));
+        c2_rl_update_D(var_id, false);
+        if (s->decision_heap && qcnf_is_existential(s->qcnf, var_id)) {
+            var_heap_insert(s->decision_heap, var_id);
+        }
+    }
+    
+    while (int_vector_count(s->unique_consequence_trail) > unique_consequence_start) {
+        Lit previous = int_vector_pop(s->unique_consequence_trail);
+        unsigned clause_idx = (unsigned) int_vector_pop(s->unique_consequence_trail);
+        assert(int_vector_count(s->unique_consequence) > clause_idx);
+        Clause* c = vector_get(s->qcnf->all_clauses, clause_idx);
+        if (c != NULL && c->active) {
+            assert(int_vector_get(s->unique_consequence, clause_idx) != 0);
+            int_vector_set(s->unique_consequence, clause_idx, previous);
+            c2_rl_update_unique_consequence(clause_idx, previous);
+        } else {
+            // Clause was deleted
+            assert(int_vector_get(s->unique_consequence, clause_idx) == 0);
+        }
+    }
+}
+
+// UPDATES
+
+void skolem_update_reason_for_constant(Skolem* s, unsigned var_id, unsigned clause_id, unsigned dlvl) {
+    skolem_var* sv = skolem_save_var(s, var_id);
     
     // we currently want to set it at most once, the next three checks ensure that
     assert(sv->reason_for_constant == INT_MAX);
@@ -142,23 +237,10 @@ void skolem_update_reason_for_constant(Skolem* s, unsigned var_id, unsigned clau
     assert(clause_id != UINT_MAX || dlvl != 0);
     
     V4("Setting reason %d for constant for var %u\n", clause_id, var_id);
-    union skolem_undo_union suu;
-    suu.sus.var_id = var_id;
-    suu.sus.val = (int) sv->reason_for_constant;
-    stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_REASON_FOR_CONSTANT, suu.ptr);
     sv->reason_for_constant = clause_id;
     sv->dlvl_for_constant = dlvl;
 }
 
-void skolem_undo_reason_for_constant(Skolem* s, void* data) {
-    union skolem_undo_union suu;
-    suu.ptr = data;
-    skolem_var* sv = skolem_var_vector_get(s->infos, suu.sus.var_id);
-    assert(suu.sus.val == INT_MAX); // currently reasons for constant are just set once.
-    sv->reason_for_constant = (unsigned) suu.sus.val;
-    sv->dlvl_for_constant = 0;
-}
-
 void skolem_update_decision_lvl(Skolem* s, unsigned var_id, unsigned dlvl) {
     skolem_enlarge_skolem_var_vector(s, var_id);
     skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
@@ -166,34 +248,21 @@ void skolem_update_decision_lvl(Skolem* s, unsigned var_id, unsigned dlvl) {
     
     if (dlvl != sv->decision_lvl) {
         V4("Setting decision lvl %d for var %u\n", dlvl, var_id);
-        union skolem_undo_union suu;
-        suu.sus.var_id = var_id;
-        suu.sus.val = (int) sv->decision_lvl;
-        stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_DECISION_LVL, suu.ptr);
+        sv = skolem_save_var(s, var_id);
         sv->decision_lvl = dlvl;
     }
 }
 
-void skolem_undo_decision_lvl(Skolem* s, void* data) {
-    union skolem_undo_union suu;
-    suu.ptr = data;
-    skolem_var* sv = skolem_var_vector_get(s->infos, suu.sus.var_id);
-    sv->decision_lvl = (unsigned) suu.sus.val;
-}
-
 void skolem_update_pos_lit(Skolem* s, unsigned var_id, int pos_lit) {
     skolem_enlarge_skolem_var_vector(s, var_id);
     skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
     if (pos_lit != sv->pos_lit) {
         V4("Setting pos_lit %d for var %u\n", pos_lit, var_id);
-        union skolem_undo_union suu;
-        suu.sus.var_id = var_id;
-        suu.sus.val = sv->pos_lit;
-        stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_POS_LIT, suu.ptr);
+        sv = skolem_save_var(s, var_id);
         sv->pos_lit = pos_lit;
         
         if (sv->neg_lit == s->satlit_true) {
-            c2_rl_update_constant_value(suu.sus.var_id, 1);
+            c2_rl_update_constant_value(var_id, 1);
         }
     }
 }
@@ -203,14 +272,11 @@ void skolem_update_neg_lit(Skolem* s, unsigned var_id, int neg_lit) {
     skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
     if (neg_lit != sv->neg_lit) {
         V4("Setting neg_lit %d for var %u\n", neg_lit, var_id);
-        union skolem_undo_union suu;
-        suu.sus.var_id = var_id;
-        suu.sus.val = sv->neg_lit;
-        stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_NEG_LIT, suu.ptr);
+        sv = skolem_save_var(s, var_id);
         sv->neg_lit = neg_lit;
         
         if (sv->neg_lit == s->satlit_true) {
-            c2_rl_update_constant_value(suu.sus.var_id, -1);
+            c2_rl_update_constant_value(var_id, -1);
         }
     }
 }
@@ -228,10 +294,7 @@ void skolem_update_pure_pos(Skolem* s, unsigned var_id, unsigned pure_pos) {
     skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
     if (sv->pure_pos != pure_pos) {
         V4("Setting pure_pos %d for var %u\n", pure_pos, var_id);
-        union skolem_undo_union suu;
-        suu.sus.var_id = var_id;
-        suu.sus.val = sv->pure_pos;
-        stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_PURE_POS, suu.ptr);
+        sv = skolem_save_var(s, var_id);
         sv->pure_pos = pure_pos;
     }
 }
@@ -241,10 +304,7 @@ void skolem_update_pure_neg(Skolem* s, unsigned var_id, unsigned pure_neg) {
     skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
     if (sv->pure_neg != pure_neg) {
         V4("Setting pure_neg %d for var %u\n", pure_neg, var_id);
-        union skolem_undo_union suu;
-        suu.sus.var_id = var_id;
-        suu.sus.val = sv->pure_neg;
-        stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_PURE_NEG, suu.ptr);
+        sv = skolem_save_var(s, var_id);
         sv->pure_neg = pure_neg;
     }
 }
@@ -255,14 +315,12 @@ void skolem_update_deterministic(Skolem* s, unsigned var_id) {
     
     int_vector_add(s->determinization_order, (int) var_id);
     c2_rl_update_D(var_id, true);
+    if (s->decision_heap && var_heap_contains(s->decision_heap, var_id)) {
+        var_heap_remove(s->decision_heap, var_id);
+    }
     
     V4("Setting var %u deterministic\n", var_id);
-    union skolem_undo_union suu;
-    suu.sus.var_id = var_id;
-    suu.sus.val = skolem_is_deterministic(s, var_id);
-    stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_DETERMINISTIC, suu.ptr);
-    
-    skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
+    skolem_var* sv = skolem_save_var(s, var_id);
     sv->deterministic = 1;
 }
 void skolem_update_decision(Skolem* s, Lit lit) {
@@ -270,8 +328,7 @@ void skolem_update_decision(Skolem* s, Lit lit) {
     
     unsigned var_id = lit_to_var(lit);
     int val = lit>0 ? 1 : -1;
-    skolem_enlarge_skolem_var_vector(s, var_id);
-    skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
+    skolem_var* sv = skolem_save_var(s, var_id);
     assert(sv->decision_pos == 0 && sv->decision_neg == 0);
     V4("Setting decision %d for var %u\n", val, var_id);
     stack_push_op(s->stack, SKOLEM_OP_DECISION, (void*) (long) var_id);
@@ -288,44 +345,23 @@ void skolem_update_dependencies(Skolem* s, unsigned var_id, union Dependencies d
     Scope* scope = vector_get(s->qcnf->scopes, v->scope_id);
     assert(! qcnf_is_DQBF(s->qcnf) || int_vector_includes_sorted(scope->vars, deps.dependencies));
 #endif
-    skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
     skolem_enlarge_skolem_var_vector(s, var_id);
+    skolem_var* sv = skolem_var_vector_get(s->infos, var_id);
     if (qcnf_is_DQBF(s->qcnf)) {
         V4("Setting dependencies ");
         assert(int_vector_is_strictly_sorted(deps.dependencies));
         int_vector_print(deps.dependencies);
         V4(" for var %u\n", var_id);
-        DEPENDENCECY_UPDATE* du = malloc(sizeof(DEPENDENCECY_UPDATE));
-        du->var_id = var_id;
-        du->dependencies = sv->dep.dependencies;
-        stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_DEPENDENCIES, (void*) du);
+        sv = skolem_save_var(s, var_id);
     } else {
         if (deps.dependence_lvl != sv->dep.dependence_lvl) {
             V4("Setting dependency level %d for var %u\n", deps.dependence_lvl, var_id);
-            union skolem_undo_union suu;
-            suu.sus.var_id = var_id;
-            suu.sus.val = (int) sv->dep.dependence_lvl;
-            stack_push_op(s->stack, SKOLEM_OP_UPDATE_INFO_DEPENDENCIES, suu.ptr);
+            sv = skolem_save_var(s, var_id);
         }
     }
     sv->dep = deps;
 }
 
-void skolem_undo_dependencies(Skolem* s, void* data) {
-    union skolem_undo_union suu;
-    suu.ptr = data;
-    union Dependencies deps;
-    if (qcnf_is_DQBF(s->qcnf)) {
-        struct DEPENDENCECY_UPDATE* du = (struct DEPENDENCECY_UPDATE*) data;
-        deps.dependencies = du->dependencies;
-        free(du);
-    } else {
-        deps.dependence_lvl = (unsigned) suu.sus.val;
-    }
-    skolem_var* si = skolem_var_vector_get(s->infos, suu.sus.var_id);
-    si->dep = deps;
-}
-
 bool skolem_is_deterministic(Skolem* s, unsigned var_id) {
     assert(var_id != 0);
     assert(var_id < 100000000); // just a safety measure, if you actually see variables with IDs > 10000000 you are probably screwed.
@@ -19,15 +19,6 @@ typedef struct skolem_var skolem_var;
 
 union Dependencies;
 
-struct skolem_undo_struct {
-    unsigned var_id;
-    int val;
-};
-union skolem_undo_union {
-    struct skolem_undo_struct sus;
-    void* ptr;
-};
-
 struct skolem_var {
     // undoable portion of skolem_vars
     int pos_lit; // refers to lit in skolem satsolver; 0 value denotes that the lit is constant FALSE; s->satlit_true denotes that the lit is constant TRUE
@@ -47,8 +38,15 @@ struct skolem_var {
     unsigned decision_lvl;
     unsigned reason_for_constant;
     unsigned dlvl_for_constant;
+    unsigned trail_position; // position of the latest snapshot of this var in s->var_trail; see skolem_save_var
 };
 
+// Snapshot of a skolem_var, taken before its first update after a push
+typedef struct {
+    unsigned var_id;
+    skolem_var sv;
+} skolem_var_snapshot;
+
 bool skolem_is_deterministic(Skolem*, unsigned var_id);
 void skolem_enlarge_skolem_var_vector(Skolem*, unsigned var_id);
 skolem_var skolem_get_info(Skolem*, unsigned var_id);
@@ -60,7 +58,6 @@ void skolem_update_pure_neg(Skolem*, unsigned var_id, unsigned pos_lit);
 void skolem_update_deterministic(Skolem*, unsigned var_id);
 void skolem_update_decision(Skolem*, Lit lit);
 void skolem_update_dependencies(Skolem*, unsigned var_id, union Dependencies deps);
-void skolem_undo_dependencies(Skolem*, void* data);
 
 unsigned skolem_get_decision_lvl_for_conflict_analysis(void*, unsigned var_id);
 unsigned skolem_get_decision_lvl(Skolem*, unsigned var_id);
@@ -68,12 +65,14 @@ unsigned skolem_is_decision_var(Skolem*, unsigned var_id);
 int skolem_get_decision_val(Skolem*, unsigned var_id);
 int skolem_get_pure_val(Skolem*, unsigned var_id);
 void skolem_update_decision_lvl(Skolem*, unsigned var_id, unsigned dlvl);
-void skolem_undo_decision_lvl(Skolem*, void* data);
 
 unsigned skolem_get_reason_for_constant(Skolem*, unsigned var_id);
 unsigned skolem_get_dlvl_for_constant(Skolem*, unsigned var_id);
 void skolem_update_reason_for_constant(Skolem*, unsigned var_id, unsigned clause_id, unsigned dlvl);
-void skolem_undo_reason_for_constant(Skolem*, void* data);
+
+// Trail
+void skolem_save_unique_consequence(Skolem*, unsigned clause_idx, Lit previous);
+void skolem_undo_trail_level(Skolem*);
 
 
 union Dependencies skolem_get_dependencies(Skolem*, unsigned);
@@ -30,9 +30,9 @@ void test_read_and_solve(char* file_name) {
 
 void test_repeated_solving() {
     for (unsigned i = 0; i < 100; i++) {
-        test_read_and_solve("/Users/markus/work/cadet/dev/integration-tests/888_SAT.qdimacs");
-        test_read_and_solve("/Users/markus/work/cadet/dev/integration-tests/1_SAT.dimacs.gz");
-        test_read_and_solve("/Users/markus/work/cadet/dev/integration-tests/2_UNSAT.dimacs.gz");
+        test_read_and_solve("integration-tests/888_SAT.qdimacs");
+        test_read_and_solve("integration-tests/1_SAT.dimacs");
+        test_read_and_solve("integration-tests/2_UNSAT.dimacs");
     }
 }
 
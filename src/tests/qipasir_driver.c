@@ -0,0 +1,106 @@
+//
+//  qipasir_driver.c
+//  cadet
+//
+//  Solves a 2QBF in QDIMACS format through the qipasir API, for the QIPASIR configurations of
+//  scripts/tester.py. Reads commands from stdin, one per line:
+//      l1 l2 ... 0      solves under the assumptions l1 l2 ...
+//      + l1 l2 ... 0    adds the clause (l1 l2 ...) before the next solve call
+//  For each solve call it prints a line "result 10", "result 0" (unknown), or "result 20 failed l1 ...",
+//  listing the assumptions for which qipasir_failed holds. Build with 'make qipasir_driver'.
+//
+
+#include "qipasir.h"
+#include "qipasir_parser.h"
+#include "cadet_internal.h"
+#include "int_vector.h"
+#include "log.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void print_usage(const char* name) {
+    fprintf(stderr, "Usage: %s [--case_splits] [--cegar] file.qdimacs < commands\n", name);
+}
+
+// Reads literals up to the terminating 0; false if the input ends before
+static bool read_lits(int_vector* lits) {
+    int lit;
+    int_vector_reset(lits);
+    while (scanf("%d", &lit) == 1) {
+        if (lit == 0) {
+            return true;
+        }
+        int_vector_add(lits, lit);
+    }
+    return false;
+}
+
+int main(int argc, const char* argv[]) {
+    log_silent = true;
+    const char* file_name = NULL;
+    bool case_splits = false;
+    bool cegar = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--case_splits") == 0) {
+            case_splits = true;
+        } else if (strcmp(argv[i], "--cegar") == 0) {
+            cegar = true;
+        } else if (argv[i][0] != '-' && file_name == NULL) {
+            file_name = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (file_name == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    FILE* file = fopen(file_name, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open file %s\n", file_name);
+        return 1;
+    }
+    void* solver = create_solver_from_qdimacs(file);
+    fclose(file);
+    C2* c2 = (C2*) solver;
+    c2->options->casesplits = case_splits;
+    c2->options->cegar = cegar;
+
+    int_vector* lits = int_vector_init();
+    char plus[2];
+    while (true) {
+        if (scanf(" %1[+]", plus) == 1) {
+            abortif(! read_lits(lits), "Incomplete clause at the end of the input.");
+            for (unsigned i = 0; i < int_vector_count(lits); i++) {
+                qipasir_add(solver, int_vector_get(lits, i));
+            }
+            qipasir_add(solver, 0);
+            continue;
+        }
+        if (! read_lits(lits)) {
+            abortif(int_vector_count(lits) != 0, "Incomplete assumptions at the end of the input.");
+            break;
+        }
+        for (unsigned i = 0; i < int_vector_count(lits); i++) {
+            qipasir_assume(solver, int_vector_get(lits, i));
+        }
+        int result = qipasir_solve(solver);
+        printf("result %d", result);
+        if (result == 20) {
+            printf(" failed");
+            for (unsigned i = 0; i < int_vector_count(lits); i++) {
+                if (qipasir_failed(solver, int_vector_get(lits, i))) {
+                    printf(" %d", int_vector_get(lits, i));
+                }
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    int_vector_free(lits);
+    qipasir_release(solver);
+    return 0;
+}
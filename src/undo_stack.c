@@ -42,16 +42,9 @@ void stack_push_op(Stack* s, char type, void* obj) {
     }
     if (s->op_count == s->op_size) {
         s->op_size *= 2;
-        void** new_obj_vector = malloc(sizeof(void*) * s->op_size);
-        char* new_type_vector = malloc(sizeof(char) * s->op_size);
-        for (size_t i = 0; i < s->op_count; i++) {
-            new_obj_vector[i] = s->obj_vector[i];
-            new_type_vector[i] = s->type_vector[i];
-        }
-        free(s->obj_vector);
-        free(s->type_vector);
-        s->obj_vector = new_obj_vector;
-        s->type_vector = new_type_vector;
+        s->obj_vector = realloc(s->obj_vector, sizeof(void*) * s->op_size);
+        s->type_vector = realloc(s->type_vector, sizeof(char) * s->op_size);
+        abortif(!s->obj_vector || !s->type_vector, "Could not grow the undo stack.");
     }
     s->obj_vector[s->op_count] = obj;
     s->type_vector[s->op_count] = type;
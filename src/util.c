@@ -4,17 +4,31 @@
 #else
 #define _XOPEN_SOURCE 500
 #endif
+#define _GNU_SOURCE // fopencookie
+#define _DARWIN_C_SOURCE // funopen
 
 #include "util.h"
 #include "log.h"
 
 #include <stdlib.h>
 #include <sys/time.h>
+#include <sys/resource.h>
 #include <string.h>
 #include <assert.h>
 #include <stdint.h>
 #include <errno.h>
 #include <time.h>
+#include <sys/types.h>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_LZMA
+#include <lzma.h>
+#endif
+#ifdef USE_BZIP2
+#include <bzlib.h>
+#endif
 
 int compare_integers_abs(const void * a, const void * b) {
     int x = abs(* ((int*) a));
@@ -39,6 +53,16 @@ double get_seconds() {
     return (double) (tv.tv_usec) / 1000000 + (double) (tv.tv_sec);
 }
 
+double get_peak_memory_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return (double) usage.ru_maxrss / (1024 * 1024); // bytes
+#else
+    return (double) usage.ru_maxrss / 1024; // kilobytes
+#endif
+}
+
 int hash6432shift(void* k) {
     assert(sizeof(unsigned long long) == 8);
     assert(sizeof(void*) == 8);
@@ -69,40 +93,261 @@ const char* get_filename_ext(const char* filename) {
     return dot + 1;
 }
 
-FILE* open_possibly_zipped_file(const char* file_name) {
-    FILE* file = NULL;
+typedef enum {
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,
+    COMPRESSION_XZ,
+    COMPRESSION_BZIP2
+} COMPRESSION_FORMAT;
+
+static COMPRESSION_FORMAT get_compression_format(const char* file_name) {
     const char* ext = get_filename_ext(file_name);
-    size_t extlen = strlen(ext);
     V4("Detected file name extension %s\n", ext);
-    if ( (extlen == 2 && strcmp("gz", ext) == 0) || (extlen == 4 && strcmp("gzip", ext) == 0) ) {
+    if (strcmp("gz", ext) == 0 || strcmp("gzip", ext) == 0) {
+        return COMPRESSION_GZIP;
+    } else if (strcmp("xz", ext) == 0 || strcmp("lzma", ext) == 0) {
+        return COMPRESSION_XZ;
+    } else if (strcmp("bz2", ext) == 0 || strcmp("bzip2", ext) == 0) {
+        return COMPRESSION_BZIP2;
+    }
+    return COMPRESSION_NONE;
+}
+
+// Is the format decompressed by a library linked into CADET, or by an external tool via popen?
+static bool is_decompressed_in_process(COMPRESSION_FORMAT format) {
+    switch (format) {
+#ifdef USE_ZLIB
+        case COMPRESSION_GZIP:
+            return true;
+#endif
+#ifdef USE_LZMA
+        case COMPRESSION_XZ:
+            return true;
+#endif
+#ifdef USE_BZIP2
+        case COMPRESSION_BZIP2:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+#if defined(USE_ZLIB) || defined(USE_LZMA) || defined(USE_BZIP2)
+#define DECOMPRESSION_BUFFER_SIZE (1 << 20)
+
+typedef ssize_t (*decompression_read_function)(void* cookie, char* buf, size_t size);
+typedef int (*decompression_close_function)(void* cookie);
+
+// Wraps a decompressor in a FILE*, so the parsers can read from it like from any other file.
+static FILE* open_decompressing_stream(void* cookie, decompression_read_function read, decompression_close_function close) {
 #ifdef __APPLE__
-        char* unzip_tool_name = "gzcat ";
+    FILE* file = funopen(cookie, (int (*)(void*, char*, int)) read, NULL, NULL, close);
+#else
+    cookie_io_functions_t functions = {read, NULL, NULL, close};
+    FILE* file = fopencookie(cookie, "r", functions);
+#endif
+    abortif(!file, "Could not create stream for decompression.");
+    setvbuf(file, NULL, _IOFBF, DECOMPRESSION_BUFFER_SIZE);
+    return file;
+}
+#endif
+
+#ifdef USE_ZLIB
+static ssize_t gzip_read(void* cookie, char* buf, size_t size) {
+    if (size > INT32_MAX) {
+        size = INT32_MAX;
+    }
+    return gzread((gzFile) cookie, buf, (unsigned) size);
+}
+static int gzip_close(void* cookie) {
+    return gzclose((gzFile) cookie) == Z_OK ? 0 : EOF;
+}
+#endif
+
+#ifdef USE_LZMA
+typedef struct {
+    FILE* compressed;
+    lzma_stream stream;
+    bool finished;
+    uint8_t in[DECOMPRESSION_BUFFER_SIZE];
+} xz_reader;
+
+static ssize_t xz_read(void* cookie, char* buf, size_t size) {
+    xz_reader* r = (xz_reader*) cookie;
+    r->stream.next_out = (uint8_t*) buf;
+    r->stream.avail_out = size;
+    while (! r->finished && r->stream.avail_out > 0) {
+        if (r->stream.avail_in == 0 && ! feof(r->compressed)) {
+            r->stream.next_in = r->in;
+            r->stream.avail_in = fread(r->in, 1, sizeof(r->in), r->compressed);
+            if (ferror(r->compressed)) {
+                return -1;
+            }
+        }
+        lzma_action action = r->stream.avail_in == 0 && feof(r->compressed) ? LZMA_FINISH : LZMA_RUN;
+        lzma_ret ret = lzma_code(&r->stream, action);
+        if (ret == LZMA_STREAM_END) {
+            r->finished = true;
+        } else if (ret != LZMA_OK) {
+            LOG_ERROR("xz decompression failed with error code %d.", ret);
+            return -1;
+        }
+    }
+    return (ssize_t) (size - r->stream.avail_out);
+}
+static int xz_close(void* cookie) {
+    xz_reader* r = (xz_reader*) cookie;
+    lzma_end(&r->stream);
+    int res = fclose(r->compressed);
+    free(r);
+    return res;
+}
+#endif
+
+#ifdef USE_BZIP2
+typedef struct {
+    FILE* compressed;
+    BZFILE* bz;
+    bool finished;
+    char unused[BZ_MAX_UNUSED]; // bytes read beyond the end of the last stream
+} bzip2_reader;
+
+/* Files may consist of several streams, e.g. when compressed with pbzip2. At the end of a stream, the
+ * decoder is restarted on the bytes it read beyond the stream, unless the file ends there.
+ */
+static bool bzip2_next_stream(bzip2_reader* r) {
+    int bzerror = BZ_OK;
+    void* unused = NULL;
+    int num_unused = 0;
+    BZ2_bzReadGetUnused(&bzerror, r->bz, &unused, &num_unused);
+    if (bzerror != BZ_OK) {
+        return false;
+    }
+    memcpy(r->unused, unused, (size_t) num_unused);
+    BZ2_bzReadClose(&bzerror, r->bz);
+    r->bz = NULL;
+    if (num_unused == 0) {
+        int c = fgetc(r->compressed);
+        if (c == EOF) {
+            r->finished = true;
+            return ! ferror(r->compressed);
+        }
+        ungetc(c, r->compressed);
+    }
+    r->bz = BZ2_bzReadOpen(&bzerror, r->compressed, 0, 0, r->unused, num_unused);
+    return bzerror == BZ_OK;
+}
+
+static ssize_t bzip2_read(void* cookie, char* buf, size_t size) {
+    bzip2_reader* r = (bzip2_reader*) cookie;
+    if (size > INT32_MAX) {
+        size = INT32_MAX;
+    }
+    int n = 0;
+    while (n == 0 && ! r->finished) { // returning 0 would signal the end of the file
+        int bzerror = BZ_OK;
+        n = BZ2_bzRead(&bzerror, r->bz, buf, (int) size);
+        if (bzerror == BZ_STREAM_END) {
+            bzerror = bzip2_next_stream(r) ? BZ_OK : BZ_DATA_ERROR;
+        }
+        if (bzerror != BZ_OK) {
+            LOG_ERROR("bzip2 decompression failed with error code %d.", bzerror);
+            return -1;
+        }
+    }
+    return n;
+}
+static int bzip2_close(void* cookie) {
+    bzip2_reader* r = (bzip2_reader*) cookie;
+    int bzerror = BZ_OK;
+    if (r->bz) {
+        BZ2_bzReadClose(&bzerror, r->bz);
+    }
+    int res = fclose(r->compressed);
+    free(r);
+    return res;
+}
 #endif
-#ifdef __linux__
-        char* unzip_tool_name = "zcat ";
+
+static FILE* open_zipped_file_in_process(const char* file_name, COMPRESSION_FORMAT format) {
+    switch (format) {
+#ifdef USE_ZLIB
+        case COMPRESSION_GZIP: {
+            gzFile gz = gzopen(file_name, "rb");
+            abortif(!gz, "Cannot open file \"%s\", does not exist?", file_name);
+            gzbuffer(gz, DECOMPRESSION_BUFFER_SIZE);
+            return open_decompressing_stream(gz, gzip_read, gzip_close);
+        }
+#endif
+#ifdef USE_LZMA
+        case COMPRESSION_XZ: {
+            xz_reader* r = malloc(sizeof(xz_reader));
+            r->compressed = fopen(file_name, "rb");
+            abortif(!r->compressed, "Cannot open file \"%s\", does not exist?", file_name);
+            lzma_stream init = LZMA_STREAM_INIT;
+            r->stream = init;
+            r->finished = false;
+            lzma_ret ret = lzma_auto_decoder(&r->stream, UINT64_MAX, LZMA_CONCATENATED); // .xz and legacy .lzma
+            abortif(ret != LZMA_OK, "Could not initialize xz decoder.");
+            return open_decompressing_stream(r, xz_read, xz_close);
+        }
 #endif
+#ifdef USE_BZIP2
+        case COMPRESSION_BZIP2: {
+            bzip2_reader* r = malloc(sizeof(bzip2_reader));
+            r->compressed = fopen(file_name, "rb");
+            abortif(!r->compressed, "Cannot open file \"%s\", does not exist?", file_name);
+            int bzerror = BZ_OK;
+            r->bz = BZ2_bzReadOpen(&bzerror, r->compressed, 0, 0, NULL, 0);
+            abortif(bzerror != BZ_OK, "Could not initialize bzip2 decoder.");
+            r->finished = false;
+            return open_decompressing_stream(r, bzip2_read, bzip2_close);
+        }
+#endif
+        default:
+            abortif(true, "Decompression of file \"%s\" is not compiled in.", file_name);
+            return NULL;
+    }
+}
+
+FILE* open_possibly_zipped_file(const char* file_name) {
+    FILE* file = NULL;
+    COMPRESSION_FORMAT format = get_compression_format(file_name);
+    if (format == COMPRESSION_NONE) {
+        file = fopen(file_name, "r");
+        abortif(!file, "Cannot open file \"%s\", does not exist?", file_name);
+    } else if (is_decompressed_in_process(format)) {
+        file = open_zipped_file_in_process(file_name, format);
+    } else {
+        // CADET was configured without the library for this format; fall back to the command line tool
 #ifdef _WIN32
         abortif(true, "Opening zipped files in Windows is not supported.");
 #endif
+        char* unzip_tool_name = "xzcat ";
+        if (format == COMPRESSION_GZIP) {
+#ifdef __APPLE__
+            unzip_tool_name = "gzcat ";
+#else
+            unzip_tool_name = "zcat ";
+#endif
+        } else if (format == COMPRESSION_BZIP2) {
+            unzip_tool_name = "bzcat ";
+        }
         
         char* cmd = malloc(strlen(unzip_tool_name) + strlen(file_name) + 5);
         sprintf(cmd, "%s '%s'", unzip_tool_name, file_name);
         file = popen(cmd, "r");
         free(cmd);
-        abortif(!file, "Cannot open gzipped file with zcat via popen. File may not exist.");
-    } else {
-        file = fopen(file_name, "r");
-        abortif(!file, "Cannot open file \"%s\", does not exist?", file_name);
+        abortif(!file, "Cannot open zipped file with %svia popen. File may not exist.", unzip_tool_name);
     }
     return file;
 }
 
 void close_possibly_zipped_file(const char* file_name, FILE* file) {
     if (file_name) {
-        const char* ext = get_filename_ext(file_name);
-        size_t extlen = strlen(ext);
-        V4("Detected file name extension %s\n", ext);
-        if ( (extlen == 2 && strcmp("gz", ext) == 0) || (extlen == 4 && strcmp("gzip", ext) == 0) ) {
+        COMPRESSION_FORMAT format = get_compression_format(file_name);
+        if (format != COMPRESSION_NONE && ! is_decompressed_in_process(format)) {
             pclose(file);
         } else {
             fclose(file);
@@ -110,7 +355,6 @@ void close_possibly_zipped_file(const char* file_name, FILE* file) {
     } // file_name == NULL idicates stdin
 }
 
-
 int ms_sleep(unsigned int ms) {
     int result = 0;
     struct timespec ts_remaining;
@@ -132,7 +376,6 @@ int ms_sleep(unsigned int ms) {
     return result;
 }
 
-
 char* cautious_readline(char * target, int n, FILE* file) {
     char* result = 0;
     unsigned i = 0;
@@ -17,6 +17,7 @@ int compare_integers_natural_order(const void * a, const void * b);
 int compare_integers_abs(const void * a, const void * b);
 
 double get_seconds();
+double get_peak_memory_mb(); // peak resident set size of the process
 
 const char* get_filename_ext(const char* filename);
 FILE* open_possibly_zipped_file(const char* file_name);
@@ -0,0 +1,122 @@
+//
+//  var_heap.c
+//  cadet
+//
+
+#include "var_heap.h"
+#include "log.h"
+
+#include <assert.h>
+
+var_heap* var_heap_init(float_vector* keys) {
+    var_heap* h = malloc(sizeof(var_heap));
+    h->keys = keys;
+    h->heap = int_vector_init();
+    h->positions = int_vector_init();
+    return h;
+}
+
+void var_heap_free(var_heap* h) {
+    int_vector_free(h->heap);
+    int_vector_free(h->positions);
+    free(h);
+}
+
+unsigned var_heap_count(var_heap* h) {
+    return int_vector_count(h->heap);
+}
+
+bool var_heap_contains(var_heap* h, unsigned var_id) {
+    return var_id < int_vector_count(h->positions) && int_vector_get(h->positions, var_id) >= 0;
+}
+
+// Returns true if var a belongs above var b
+static inline bool var_heap_before(var_heap* h, int a, int b) {
+    float key_a = float_vector_get(h->keys, (unsigned) a);
+    float key_b = float_vector_get(h->keys, (unsigned) b);
+    return key_a > key_b || (key_a == key_b && a < b);
+}
+
+static inline void var_heap_place(var_heap* h, unsigned pos, int var_id) {
+    int_vector_set(h->heap, pos, var_id);
+    int_vector_set(h->positions, (unsigned) var_id, (int) pos);
+}
+
+static void var_heap_sift_up(var_heap* h, unsigned pos) {
+    int var_id = int_vector_get(h->heap, pos);
+    while (pos > 0) {
+        unsigned parent_pos = (pos - 1) >> 1;
+        int parent = int_vector_get(h->heap, parent_pos);
+        if (! var_heap_before(h, var_id, parent)) {
+            break;
+        }
+        var_heap_place(h, pos, parent);
+        pos = parent_pos;
+    }
+    var_heap_place(h, pos, var_id);
+}
+
+static void var_heap_sift_down(var_heap* h, unsigned pos) {
+    int var_id = int_vector_get(h->heap, pos);
+    unsigned count = int_vector_count(h->heap);
+    unsigned child_pos = 2 * pos + 1;
+    while (child_pos < count) {
+        if (child_pos + 1 < count
+            && var_heap_before(h, int_vector_get(h->heap, child_pos + 1), int_vector_get(h->heap, child_pos))) {
+            child_pos += 1;
+        }
+        int child = int_vector_get(h->heap, child_pos);
+        if (! var_heap_before(h, child, var_id)) {
+            break;
+        }
+        var_heap_place(h, pos, child);
+        pos = child_pos;
+        child_pos = 2 * pos + 1;
+    }
+    var_heap_place(h, pos, var_id);
+}
+
+void var_heap_insert(var_heap* h, unsigned var_id) {
+    assert(var_id != 0);
+    assert(var_id < float_vector_count(h->keys));
+    assert(! var_heap_contains(h, var_id));
+    while (int_vector_count(h->positions) <= var_id) {
+        int_vector_add(h->positions, -1);
+    }
+    int_vector_add(h->heap, (int) var_id);
+    var_heap_sift_up(h, int_vector_count(h->heap) - 1);
+}
+
+void var_heap_remove(var_heap* h, unsigned var_id) {
+    assert(var_heap_contains(h, var_id));
+    unsigned pos = (unsigned) int_vector_get(h->positions, var_id);
+    int_vector_set(h->positions, var_id, -1);
+    int last = int_vector_pop(h->heap);
+    if (pos < int_vector_count(h->heap)) {
+        var_heap_place(h, pos, last);
+        var_heap_update(h, (unsigned) last);
+    }
+}
+
+unsigned var_heap_peek(var_heap* h) {
+    if (int_vector_count(h->heap) == 0) {
+        return 0;
+    }
+    return (unsigned) int_vector_get(h->heap, 0);
+}
+
+void var_heap_update(var_heap* h, unsigned var_id) {
+    if (! var_heap_contains(h, var_id)) {
+        return;
+    }
+    unsigned pos = (unsigned) int_vector_get(h->positions, var_id);
+    var_heap_sift_up(h, pos);
+    var_heap_sift_down(h, (unsigned) int_vector_get(h->positions, var_id));
+}
+
+void var_heap_reset(var_heap* h) {
+    for (unsigned i = 0; i < int_vector_count(h->heap); i++) {
+        int_vector_set(h->positions, (unsigned) int_vector_get(h->heap, i), -1);
+    }
+    int_vector_reset(h->heap);
+}
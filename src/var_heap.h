@@ -0,0 +1,33 @@
+//
+//  var_heap.h
+//  cadet
+//
+//  Indexed max-heap of variables, ordered by a float key per variable (e.g. the activity).
+//  Ties are broken towards smaller var_ids.
+//
+
+#ifndef var_heap_h
+#define var_heap_h
+
+#include "int_vector.h"
+#include "float_vector.h"
+
+#include <stdbool.h>
+
+typedef struct {
+    float_vector* keys; // indexed by var_id; not owned by the heap
+    int_vector* heap; // contains var_ids
+    int_vector* positions; // indexed by var_id; position in the heap or -1
+} var_heap;
+
+var_heap* var_heap_init(float_vector* keys);
+void var_heap_free(var_heap*);
+unsigned var_heap_count(var_heap*);
+bool var_heap_contains(var_heap*, unsigned var_id);
+void var_heap_insert(var_heap*, unsigned var_id);
+void var_heap_remove(var_heap*, unsigned var_id);
+unsigned var_heap_peek(var_heap*); // returns 0 if the heap is empty
+void var_heap_update(var_heap*, unsigned var_id); // restores the heap property after the key of var_id changed; no effect if var_id is not contained
+void var_heap_reset(var_heap*);
+
+#endif /* var_heap_h */